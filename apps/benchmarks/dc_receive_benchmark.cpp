@@ -0,0 +1,250 @@
+/*
+ *  distributed_control receive path benchmark.
+ *  dc_receive_benchmark.cpp
+ *
+ *  A writer thread streams length prefixed packets of a fixed size
+ *  over a TCP connection to 127.0.0.1.  The packets are received,
+ *  queued and checksummed by a dispatch thread in two ways: the
+ *  copying path distributed_control used before, where packets are
+ *  received into a per socket buffer and each packet is copied into
+ *  its own buffer, and the dc_slab_receiver path, where the dispatch
+ *  thread reads the packets where they were received.  The throughput
+ *  of both is reported for packets of 16 bytes to 1 MB.
+ */
+
+#include <string>
+#include <iostream>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <graphlab.hpp>
+#include <graphlab/util/blocking_queue.hpp>
+#include <graphlab/distributed/dc_recv_slab.hpp>
+#include <graphlab/macros_def.hpp>
+
+
+/** Returns a connected pair of loopback TCP sockets */
+void loopback_pair(int& writefd, int& readfd) {
+  int listenfd = socket(AF_INET, SOCK_STREAM, 0);
+  ASSERT_TRUE(listenfd >= 0);
+  sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  addr.sin_port = 0;
+  socklen_t addrlen = sizeof(addr);
+  int ret = bind(listenfd, (sockaddr*)&addr, sizeof(addr));
+  ASSERT_TRUE(ret == 0);
+  ret = getsockname(listenfd, (sockaddr*)&addr, &addrlen);
+  ASSERT_TRUE(ret == 0);
+  ret = listen(listenfd, 1);
+  ASSERT_TRUE(ret == 0);
+  writefd = socket(AF_INET, SOCK_STREAM, 0);
+  ret = connect(writefd, (sockaddr*)&addr, sizeof(addr));
+  ASSERT_TRUE(ret == 0);
+  readfd = accept(listenfd, NULL, NULL);
+  ASSERT_TRUE(readfd >= 0);
+  close(listenfd);
+  int flag = 1;
+  setsockopt(writefd, IPPROTO_TCP, TCP_NODELAY, (char*)&flag, sizeof(flag));
+}
+
+
+/** The checksum of a packet, which the dispatch thread computes */
+size_t checksum(const char* buf, size_t len) {
+  size_t sum = 0;
+  for(size_t i = 0; i < len; ++i) sum += (unsigned char)buf[i];
+  return sum;
+}
+
+
+/** Writes npackets packets of packetlen bytes */
+class packet_writer : public graphlab::runnable {
+public:
+  int fd;
+  size_t packetlen;
+  size_t npackets;
+  size_t sum;
+
+  void run() {
+    // a batch of about 1MB of packets, written repeatedly
+    const size_t framed = packetlen + sizeof(uint32_t);
+    const size_t perbatch = std::max(size_t(1), (1 << 20) / framed);
+    std::vector<char> batch(framed * perbatch);
+    sum = 0;
+    size_t batchsum = 0;
+    for(size_t i = 0; i < perbatch; ++i) {
+      char* pos = &batch[i * framed];
+      const uint32_t len = uint32_t(packetlen);
+      memcpy(pos, &len, sizeof(uint32_t));
+      for(size_t j = 0; j < packetlen; ++j) pos[sizeof(uint32_t) + j] = char(i + j);
+      batchsum += checksum(pos + sizeof(uint32_t), packetlen);
+    }
+    for(size_t sent = 0; sent < npackets; sent += perbatch) {
+      const size_t n = std::min(perbatch, npackets - sent);
+      if(n == perbatch) sum += batchsum;
+      else for(size_t i = 0; i < n; ++i)
+             sum += checksum(&batch[i * framed] + sizeof(uint32_t), packetlen);
+      size_t written = 0;
+      while(written < n * framed) {
+        ssize_t ret = send(fd, &batch[written], n * framed - written, 0);
+        ASSERT_TRUE(ret > 0);
+        written += ret;
+      }
+    }
+  }
+}; // end of packet_writer
+
+
+/** A queued packet. slab is NULL for packets of the copying path */
+struct queued_packet {
+  char* buf;
+  size_t len;
+  graphlab::dc_recv_slab* slab;
+};
+
+/** Checksums and releases npackets queued packets */
+class packet_dispatcher : public graphlab::runnable {
+public:
+  graphlab::blocking_queue<queued_packet>* queue;
+  size_t npackets;
+  size_t sum;
+
+  void run() {
+    sum = 0;
+    for(size_t i = 0; i < npackets; ++i) {
+      std::pair<queued_packet, bool> ret = queue->dequeue();
+      ASSERT_TRUE(ret.second);
+      sum += checksum(ret.first.buf, ret.first.len);
+      if(ret.first.slab == NULL) free(ret.first.buf);
+      else graphlab::release_recv_slab(ret.first.slab);
+    }
+  }
+}; // end of packet_dispatcher
+
+
+/**
+ * Receives as distributed_control did before dc_slab_receiver: into
+ * a buffer which grows to fit the largest packet, copying every
+ * complete packet out and moving the remainder to the front.
+ */
+void receive_by_copy(int fd, size_t npackets,
+                     graphlab::blocking_queue<queued_packet>& queue) {
+  size_t buflen = 131072;
+  char* buffer = (char*)malloc(buflen);
+  size_t buftail = 0;
+  size_t received = 0;
+  while(received < npackets) {
+    ssize_t msglen = recv(fd, buffer + buftail, buflen - buftail, 0);
+    ASSERT_TRUE(msglen > 0);
+    buftail += msglen;
+    if(buftail < sizeof(uint32_t)) continue;
+    const size_t eff_packetsize =
+      *reinterpret_cast<uint32_t*>(buffer) + sizeof(uint32_t);
+    if(buflen < eff_packetsize) {
+      buffer = (char*)realloc(buffer, 2 * eff_packetsize);
+      buflen = 2 * eff_packetsize;
+    }
+    size_t bufhead = 0;
+    while(bufhead + sizeof(uint32_t) <= buftail) {
+      const uint32_t packetlen =
+        *reinterpret_cast<uint32_t*>(buffer + bufhead);
+      if(buftail - bufhead < packetlen + sizeof(uint32_t)) break;
+      bufhead += sizeof(uint32_t);
+      queued_packet packet = {(char*)malloc(packetlen), packetlen, NULL};
+      memcpy(packet.buf, buffer + bufhead, packetlen);
+      queue.enqueue(packet);
+      ++received;
+      bufhead += packetlen;
+    }
+    memmove(buffer, buffer + bufhead, buftail - bufhead);
+    buftail -= bufhead;
+  }
+  free(buffer);
+}
+
+struct slab_enqueuer {
+  graphlab::blocking_queue<queued_packet>* queue;
+  size_t received;
+  void operator()(graphlab::dc_recv_slab* slab, char* buf, size_t len) {
+    queued_packet packet = {buf, len, slab};
+    queue->enqueue(packet);
+    ++received;
+  }
+};
+
+void receive_by_slab(int fd, size_t npackets,
+                     graphlab::blocking_queue<queued_packet>& queue,
+                     graphlab::dc_buffer_pool& pool) {
+  graphlab::dc_slab_receiver receiver(pool);
+  slab_enqueuer enqueuer = {&queue, 0};
+  while(enqueuer.received < npackets) {
+    ssize_t msglen = receiver.receive(fd, enqueuer);
+    ASSERT_TRUE(msglen > 0);
+  }
+}
+
+
+/** Streams npackets packets and returns the seconds taken */
+double run(bool use_slabs, size_t packetlen, size_t npackets,
+           graphlab::dc_buffer_pool& pool) {
+  int writefd, readfd;
+  loopback_pair(writefd, readfd);
+  graphlab::blocking_queue<queued_packet> queue;
+  packet_writer writer;
+  writer.fd = writefd;
+  writer.packetlen = packetlen;
+  writer.npackets = npackets;
+  packet_dispatcher dispatcher;
+  dispatcher.queue = &queue;
+  dispatcher.npackets = npackets;
+
+  graphlab::timer ti;
+  ti.start();
+  graphlab::thread_group threads;
+  threads.launch(&writer);
+  threads.launch(&dispatcher);
+  if(use_slabs) receive_by_slab(readfd, npackets, queue, pool);
+  else receive_by_copy(readfd, npackets, queue);
+  threads.join();
+  const double elapsed = ti.current_time();
+  ASSERT_TRUE(writer.sum == dispatcher.sum);
+  close(writefd);
+  close(readfd);
+  return elapsed;
+}
+
+
+int main(int argc, char** argv) {
+  global_logger().set_log_level(LOG_WARNING);
+  global_logger().set_log_to_console(true);
+
+  graphlab::command_line_options
+    clopts("Compare the copying and slab receive paths over loopback.");
+  size_t mbytes = 256;
+  clopts.attach_option("mbytes", &mbytes, mbytes,
+                       "megabytes streamed per configuration");
+  if(!clopts.parse(argc, argv)) {
+    std::cout << "Error in parsing input." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  graphlab::dc_buffer_pool pool(131072, 64);
+  std::cout << "packet bytes\tpackets\tcopy MB/s\tslab MB/s\t"
+            << "copy packets/s\tslab packets/s" << std::endl;
+  for(size_t packetlen = 16; packetlen <= (1 << 20); packetlen *= 4) {
+    const size_t npackets =
+      std::max(size_t(1), (mbytes << 20) / (packetlen + sizeof(uint32_t)));
+    const double copy_time = run(false, packetlen, npackets, pool);
+    const double slab_time = run(true, packetlen, npackets, pool);
+    const double mb = double(npackets) * packetlen / (1 << 20);
+    std::cout << packetlen << "\t" << npackets << "\t"
+              << mb / copy_time << "\t" << mb / slab_time << "\t"
+              << npackets / copy_time << "\t" << npackets / slab_time
+              << std::endl;
+  }
+  return EXIT_SUCCESS;
+} // End of main
@@ -0,0 +1,149 @@
+/*
+ *  Graph load benchmark.
+ *  graph_load_benchmark.cpp
+ *
+ *  Saves a random graph both as a serialized archive and in the
+ *  binary graph format, and compares the time to load it back with
+ *  graph::load(), with graph::load_binary() and by mapping it with
+ *  mapped_graph.  The mapped graph is then traversed once, which is
+ *  when its pages are actually read.
+ */
+
+#include <string>
+#include <cstdio>
+#include <stdlib.h>
+#include <graphlab.hpp>
+#include <graphlab/macros_def.hpp>
+
+
+struct vertex_data {
+  float value;
+  vertex_data(float value = 1) : value(value) { }
+}; // End of vertex data
+
+struct edge_data {
+  float weight;
+  edge_data(float weight = 1) : weight(weight) { }
+}; // End of edge data
+
+// written as raw bytes by the archive too, for a like for like comparison
+GRAPHLAB_SERIALIZE_AS_POD(vertex_data)
+GRAPHLAB_SERIALIZE_AS_POD(edge_data)
+
+typedef graphlab::graph<vertex_data, edge_data> graph_type;
+typedef graphlab::mapped_graph<vertex_data, edge_data> mapped_graph_type;
+
+
+/**
+ * Fill the graph with nverts vertices and on average degree random
+ * out edges per vertex.  The same seed produces the same graph.
+ */
+void build_graph(graph_type& graph, size_t nverts, size_t degree,
+                 size_t seed) {
+  graph.clear();
+  graph.resize(nverts);
+  srand(seed);
+  std::set<graphlab::vertex_id_t> targets;
+  for(graphlab::vertex_id_t v = 0; v < nverts; ++v) {
+    targets.clear();
+    while(targets.size() < degree) {
+      graphlab::vertex_id_t u = rand() % nverts;
+      if(u != v) targets.insert(u);
+    }
+    foreach(graphlab::vertex_id_t u, targets) {
+      graph.add_edge(v, u, edge_data(1.0 / degree));
+    }
+  }
+  graph.finalize();
+} // end of build graph
+
+
+/**
+ * Sum the weighted values of the in neighbors of every vertex, which
+ * reads all of the adjacency and data of the graph.
+ */
+template<typename Graph>
+double traverse(const Graph& graph) {
+  double total = 0;
+  for(graphlab::vertex_id_t v = 0; v < graph.num_vertices(); ++v) {
+    const graphlab::edge_list eids = graph.in_edge_ids(v);
+    const graphlab::vertex_list nbrs = graph.in_neighbor_ids(v);
+    for(size_t i = 0; i < eids.size(); ++i) {
+      total += graph.edge_data(eids[i]).weight *
+        graph.vertex_data(nbrs[i]).value;
+    }
+  }
+  return total;
+} // end of traverse
+
+
+void report(const std::string& name, double seconds, double checksum) {
+  std::cout << name << "\tseconds: " << seconds
+            << "\tchecksum: " << checksum << std::endl;
+}
+
+
+int main(int argc, char** argv) {
+  global_logger().set_log_level(LOG_WARNING);
+  global_logger().set_log_to_console(true);
+
+  graphlab::command_line_options
+    clopts("Compare loading a graph from an archive and from the "
+           "binary graph format.");
+  size_t nverts = 1000000;
+  size_t degree = 8;
+  size_t seed = 1;
+  std::string prefix = "graph_load_benchmark";
+  clopts.attach_option("nverts", &nverts, nverts, "number of vertices");
+  clopts.attach_option("degree", &degree, degree, "out edges per vertex");
+  clopts.attach_option("seed", &seed, seed, "random graph seed");
+  clopts.attach_option("prefix", &prefix, prefix,
+                       "prefix of the files written");
+  if(!clopts.parse(argc, argv)) {
+    std::cout << "Error in parsing input." << std::endl;
+    return EXIT_FAILURE;
+  }
+  if(degree >= nverts) {
+    std::cout << "degree must be smaller than nverts" << std::endl;
+    return EXIT_FAILURE;
+  }
+  const std::string archive_file = prefix + ".archive";
+  const std::string binary_file = prefix + ".bin";
+
+  graphlab::timer ti;
+  {
+    graph_type graph;
+    build_graph(graph, nverts, degree, seed);
+    ti.start();
+    graph.save(archive_file);
+    report("save archive", ti.current_time(), 0);
+    ti.start();
+    if(!graph.save_binary(binary_file)) return EXIT_FAILURE;
+    report("save binary", ti.current_time(), 0);
+  }
+  {
+    graph_type graph;
+    ti.start();
+    graph.load(archive_file);
+    graph.finalize();
+    report("load archive", ti.current_time(), traverse(graph));
+  }
+  {
+    graph_type graph;
+    ti.start();
+    if(!graph.load_binary(binary_file)) return EXIT_FAILURE;
+    report("load binary", ti.current_time(), traverse(graph));
+  }
+  {
+    mapped_graph_type graph;
+    ti.start();
+    if(!graph.open(binary_file)) return EXIT_FAILURE;
+    report("map binary", ti.current_time(), 0);
+    ti.start();
+    const double checksum = traverse(graph);
+    report("map + traverse", ti.current_time(), checksum);
+  }
+  remove(archive_file.c_str());
+  remove(binary_file.c_str());
+  return EXIT_SUCCESS;
+} // End of main
@@ -0,0 +1,131 @@
+/*
+ *  Graph storage benchmark.
+ *  graph_storage_benchmark.cpp
+ *
+ *  Builds the same random graph twice, once with the per-vertex edge
+ *  vectors and once with the compressed sparse row layout produced by
+ *  graph::finalize(), and compares the memory footprint of the
+ *  adjacency structure and the update throughput of a PageRank style
+ *  update function.
+ */
+
+#include <string>
+#include <stdlib.h>
+#include <graphlab.hpp>
+#include <graphlab/macros_def.hpp>
+
+
+struct vertex_data {
+  float value;
+  vertex_data(float value = 1) : value(value) { }
+}; // End of vertex data
+
+struct edge_data {
+  float weight;
+  edge_data(float weight = 1) : weight(weight) { }
+}; // End of edge data
+
+typedef graphlab::graph<vertex_data, edge_data> graph_type;
+typedef graphlab::types<graph_type> gl_types;
+
+
+/**
+ * Sum the weighted values of the in neighbors.  The update touches
+ * the adjacency of every vertex once which makes the edge list
+ * layout visible in the throughput.
+ */
+void sum_update(gl_types::iscope &scope,
+                gl_types::icallback &scheduler,
+                gl_types::ishared_data* shared_data) {
+  float sum = 0;
+  foreach(graphlab::edge_id_t eid, scope.in_edge_ids()) {
+    const vertex_data& nbr =
+      scope.const_neighbor_vertex_data(scope.source(eid));
+    sum += scope.const_edge_data(eid).weight * nbr.value;
+  }
+  scope.vertex_data().value = 0.15 + 0.85 * sum;
+} // end of sum update
+
+
+/**
+ * Fill the graph with nverts vertices and on average degree random
+ * out edges per vertex.  The same seed produces the same graph.
+ */
+void build_graph(graph_type& graph, size_t nverts, size_t degree,
+                 size_t seed) {
+  graph.clear();
+  graph.resize(nverts);
+  srand(seed);
+  std::set<graphlab::vertex_id_t> targets;
+  for(graphlab::vertex_id_t v = 0; v < nverts; ++v) {
+    targets.clear();
+    while(targets.size() < degree) {
+      graphlab::vertex_id_t u = rand() % nverts;
+      if(u != v) targets.insert(u);
+    }
+    foreach(graphlab::vertex_id_t u, targets) {
+      graph.add_edge(v, u, edge_data(1.0 / degree));
+    }
+  }
+} // end of build graph
+
+
+/**
+ * Run nsweeps rounds of the update over every vertex and report the
+ * adjacency footprint and the update rate.
+ */
+void run_layout(const std::string& name, bool use_csr,
+                const graphlab::command_line_options& clopts,
+                size_t nverts, size_t degree, size_t nsweeps,
+                size_t seed) {
+  gl_types::core core;
+  build_graph(core.graph(), nverts, degree, seed);
+  core.graph().set_csr_storage(use_csr);
+  core.graph().finalize();
+  core.set_engine_options(clopts);
+
+  double runtime = 0;
+  size_t updates = 0;
+  for(size_t i = 0; i < nsweeps; ++i) {
+    core.add_task_to_all(sum_update, 1.0);
+    runtime += core.start();
+    updates += core.last_update_count();
+  }
+  std::cout << name
+            << "\tadjacency bytes: " << core.graph().adjacency_memory_usage()
+            << "\tupdates: " << updates
+            << "\truntime: " << runtime
+            << "\tupdates/sec: " << (runtime > 0 ? updates / runtime : 0)
+            << std::endl;
+} // end of run layout
+
+
+int main(int argc, char** argv) {
+  global_logger().set_log_level(LOG_WARNING);
+  global_logger().set_log_to_console(true);
+
+  graphlab::command_line_options
+    clopts("Compare the vector and CSR graph storage layouts.");
+  size_t nverts = 1000000;
+  size_t degree = 8;
+  size_t nsweeps = 5;
+  size_t seed = 1;
+  clopts.attach_option("nverts", &nverts, nverts, "number of vertices");
+  clopts.attach_option("degree", &degree, degree, "out edges per vertex");
+  clopts.attach_option("nsweeps", &nsweeps, nsweeps,
+                       "number of sweeps over all vertices");
+  clopts.attach_option("seed", &seed, seed, "random graph seed");
+  if(!clopts.parse(argc, argv)) {
+    std::cout << "Error in parsing input." << std::endl;
+    return EXIT_FAILURE;
+  }
+  if(degree >= nverts) {
+    std::cout << "degree must be smaller than nverts" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  run_layout("vector", false, clopts, nverts, degree, nsweeps, seed);
+  run_layout("csr", true, clopts, nverts, degree, nsweeps, seed);
+  return EXIT_SUCCESS;
+} // End of main
+
@@ -0,0 +1,99 @@
+/*
+ *  Priority queue benchmark.
+ *  priority_queue_benchmark.cpp
+ *
+ *  Replays the access pattern of the priority schedulers on the
+ *  vertex queues: insert_max of random vertices with random
+ *  priorities, interleaved with pops.  The throughput of the map
+ *  indexed mutable_queue, the vector indexed mutable_queue<size_t>
+ *  and the 4-ary and 8-ary indexed_dary_heap is reported for each
+ *  number of vertices.  Every queue sees the same operations and
+ *  must pop the same sequence of priorities.
+ */
+
+#include <string>
+#include <iostream>
+#include <stdlib.h>
+#include <graphlab.hpp>
+#include <graphlab/util/mutable_queue.hpp>
+#include <graphlab/util/indexed_dary_heap.hpp>
+#include <graphlab/macros_def.hpp>
+
+
+/**
+ * Runs nops operations on an empty queue, one pop after every
+ * pop_interval insert_max calls, then pops the rest. Returns the
+ * number of operations per second. The sum of the popped priorities,
+ * weighted by their order, is added to checksum.
+ */
+template<typename Queue>
+double run_queue(size_t nvertices, size_t nops, size_t pop_interval,
+                 double& checksum) {
+  Queue queue;
+  // the same pseudo random sequence for every queue
+  uint64_t state = 12345;
+  size_t npops = 0;
+  graphlab::timer ti;
+  ti.start();
+  for(size_t i = 0; i < nops; ++i) {
+    state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+    const size_t vertex = (state >> 33) % nvertices;
+    // no two vertices share a priority, so every queue pops the same
+    // vertices and sees the same operations
+    const double priority =
+      double((state >> 8) & 0xffffff) + double(vertex) / double(nvertices);
+    queue.insert_max(vertex, priority);
+    if(i % pop_interval == 0) checksum += queue.pop().second * (++npops);
+  }
+  while(!queue.empty()) checksum += queue.pop().second * (++npops);
+  double runtime = ti.current_time();
+  return runtime > 0 ? (nops + npops) / runtime : 0;
+} // end of run queue
+
+
+int main(int argc, char** argv) {
+  global_logger().set_log_level(LOG_WARNING);
+  global_logger().set_log_to_console(true);
+
+  graphlab::command_line_options
+    clopts("Compare the vertex priority queues of the schedulers.");
+  size_t maxvertices = 1 << 22;
+  size_t nops = 4000000;
+  size_t pop_interval = 4;
+  clopts.attach_option("maxvertices", &maxvertices, maxvertices,
+                       "largest number of vertices");
+  clopts.attach_option("nops", &nops, nops, "insert_max calls per run");
+  clopts.attach_option("pop_interval", &pop_interval, pop_interval,
+                       "insert_max calls between pops");
+  if(!clopts.parse(argc, argv)) {
+    std::cout << "Error in parsing input." << std::endl;
+    return EXIT_FAILURE;
+  }
+  if(pop_interval == 0) pop_interval = 1;
+
+  std::cout << "vertices\tmap ops/sec\tvector ops/sec"
+            << "\t4-ary ops/sec\t8-ary ops/sec" << std::endl;
+  for(size_t nvertices = 1024; nvertices <= maxvertices; nvertices *= 4) {
+    double checksum[4] = {0, 0, 0, 0};
+    double map_rate =
+      run_queue<graphlab::mutable_queue<graphlab::vertex_id_t, double> >
+      (nvertices, nops, pop_interval, checksum[0]);
+    double vector_rate =
+      run_queue<graphlab::mutable_queue<size_t, double> >
+      (nvertices, nops, pop_interval, checksum[1]);
+    double dary4_rate =
+      run_queue<graphlab::indexed_dary_heap<double, 4> >
+      (nvertices, nops, pop_interval, checksum[2]);
+    double dary8_rate =
+      run_queue<graphlab::indexed_dary_heap<double, 8> >
+      (nvertices, nops, pop_interval, checksum[3]);
+    for(size_t i = 1; i < 4; ++i) {
+      ASSERT_MSG(checksum[i] == checksum[0],
+                 "Queue %lu popped a different sequence", (unsigned long)i);
+    }
+    std::cout << nvertices << "\t" << map_rate << "\t" << vector_rate
+              << "\t" << dary4_rate << "\t" << dary8_rate << std::endl;
+  }
+  return EXIT_SUCCESS;
+} // End of main
+
@@ -0,0 +1,243 @@
+/*
+ *  Serialization benchmark.
+ *  serialization_benchmark.cpp
+ *
+ *  Writes and reads back vectors of doubles, of small integers, of
+ *  structs with save() and load() methods and of structs marked
+ *  GRAPHLAB_SERIALIZE_AS_POD, and a stream of small messages shaped
+ *  like remote_callxs arguments.  Each workload is run through an
+ *  archive on a std::stringstream, on a growable buffer and on a
+ *  growable buffer with varint integers. The time per direction and
+ *  the number of bytes written are reported, and every read is checked
+ *  against the data that was written.
+ */
+
+#include <string>
+#include <sstream>
+#include <iostream>
+#include <stdlib.h>
+#include <graphlab.hpp>
+#include <graphlab/macros_def.hpp>
+
+
+/** An edge which is serialized field by field */
+struct edge_record {
+  uint32_t source;
+  uint32_t target;
+  double weight;
+  void save(graphlab::oarchive& arc) const {
+    arc << source << target << weight;
+  }
+  void load(graphlab::iarchive& arc) {
+    arc >> source >> target >> weight;
+  }
+  bool operator==(const edge_record& other) const {
+    return source == other.source && target == other.target &&
+      weight == other.weight;
+  }
+};
+
+/** The same edge written as raw bytes */
+struct pod_edge_record {
+  uint32_t source;
+  uint32_t target;
+  double weight;
+  bool operator==(const pod_edge_record& other) const {
+    return source == other.source && target == other.target &&
+      weight == other.weight;
+  }
+};
+GRAPHLAB_SERIALIZE_AS_POD(pod_edge_record)
+
+
+/** The data of every workload */
+struct workload {
+  std::vector<double> doubles;
+  std::vector<size_t> integers;
+  std::vector<edge_record> edges;
+  std::vector<pod_edge_record> pod_edges;
+  size_t nmessages;
+
+  workload(size_t n) : doubles(n), integers(n), edges(n), pod_edges(n),
+                       nmessages(n / 10) {
+    for(size_t i = 0; i < n; ++i) {
+      doubles[i] = graphlab::random::rand01();
+      integers[i] = graphlab::random::rand_int(1000);
+      edges[i].source = pod_edges[i].source = graphlab::random::rand_int(n);
+      edges[i].target = pod_edges[i].target = graphlab::random::rand_int(n);
+      edges[i].weight = pod_edges[i].weight = doubles[i];
+    }
+  }
+}; // end of workload
+
+
+/** Where a workload is written and read */
+struct stream_target {
+  std::stringstream strm;
+  template<typename F> void write(F f) {
+    strm.str("");
+    graphlab::oarchive arc(strm);
+    f(arc);
+  }
+  template<typename F> void read(F f) {
+    strm.seekg(0);
+    graphlab::iarchive arc(strm);
+    f(arc);
+  }
+  size_t size() { return strm.str().size(); }
+};
+
+struct buffer_target {
+  graphlab::oarchive out;
+  buffer_target(graphlab::integer_encoding::integer_encoding_enum encoding) :
+    out(encoding) { }
+  template<typename F> void write(F f) {
+    out.clear();
+    f(out);
+  }
+  template<typename F> void read(F f) {
+    graphlab::iarchive arc(out.data(), out.size(), out.int_encoding());
+    f(arc);
+  }
+  size_t size() { return out.size(); }
+};
+
+
+/** Serialize one vector of the workload */
+template<typename T>
+struct vector_writer {
+  const std::vector<T>* vec;
+  void operator()(graphlab::oarchive& arc) const { arc << *vec; }
+};
+
+template<typename T>
+struct vector_reader {
+  std::vector<T>* vec;
+  void operator()(graphlab::iarchive& arc) const { arc >> *vec; }
+};
+
+/** Small messages shaped like remote_callxs arguments */
+struct message_writer {
+  size_t nmessages;
+  void operator()(graphlab::oarchive& arc) const {
+    for(size_t i = 0; i < nmessages; ++i) {
+      arc << i << size_t(i % 7) << std::string("vertex_data");
+    }
+  }
+};
+
+struct message_reader {
+  size_t nmessages;
+  void operator()(graphlab::iarchive& arc) const {
+    for(size_t i = 0; i < nmessages; ++i) {
+      size_t a, b;
+      std::string s;
+      arc >> a >> b >> s;
+      ASSERT_EQ(a, i);
+      ASSERT_EQ(b, i % 7);
+      ASSERT_EQ(s, std::string("vertex_data"));
+    }
+  }
+};
+
+
+/** Write and read the vector and print the times */
+template<typename Target, typename T>
+void run_vector(Target& target, const std::string& name,
+                const std::vector<T>& vec) {
+  vector_writer<T> writer = {&vec};
+  std::vector<T> result;
+  vector_reader<T> reader = {&result};
+  graphlab::timer ti;
+  ti.start();
+  target.write(writer);
+  const double write_time = ti.current_time();
+  ti.start();
+  target.read(reader);
+  const double read_time = ti.current_time();
+  ASSERT_TRUE(result == vec);
+  std::cout << name << "\t" << target.size() << "\t"
+            << write_time * 1000 << "\t" << read_time * 1000 << std::endl;
+}
+
+template<typename Target>
+void run_messages(Target& target, const std::string& name, size_t nmessages) {
+  message_writer writer = {nmessages};
+  message_reader reader = {nmessages};
+  graphlab::timer ti;
+  ti.start();
+  target.write(writer);
+  const double write_time = ti.current_time();
+  ti.start();
+  target.read(reader);
+  const double read_time = ti.current_time();
+  std::cout << name << "\t" << target.size() << "\t"
+            << write_time * 1000 << "\t" << read_time * 1000 << std::endl;
+}
+
+template<typename Target>
+void run_all(Target& target, const std::string& mode, const workload& w) {
+  run_vector(target, mode + "\tdoubles", w.doubles);
+  run_vector(target, mode + "\tintegers", w.integers);
+  run_vector(target, mode + "\tedges", w.edges);
+  run_vector(target, mode + "\tpod_edges", w.pod_edges);
+  run_messages(target, mode + "\tmessages", w.nmessages);
+}
+
+
+/**
+ * One archive per message, as remote_callxs does: on a stringstream
+ * which is copied out with str(), and on a growable buffer.
+ */
+void run_small_messages(size_t nmessages) {
+  graphlab::timer ti;
+  ti.start();
+  size_t bytes = 0;
+  for(size_t i = 0; i < nmessages; ++i) {
+    std::stringstream strm;
+    graphlab::oarchive arc(strm);
+    arc << i << size_t(i % 7) << std::string("vertex_data");
+    bytes += strm.str().length();
+  }
+  const double stream_time = ti.current_time();
+  ti.start();
+  size_t buffer_bytes = 0;
+  for(size_t i = 0; i < nmessages; ++i) {
+    graphlab::oarchive arc;
+    arc << i << size_t(i % 7) << std::string("vertex_data");
+    buffer_bytes += arc.size();
+  }
+  const double buffer_time = ti.current_time();
+  ASSERT_EQ(bytes, buffer_bytes);
+  std::cout << "stream\tper_message\t" << bytes << "\t"
+            << stream_time * 1000 << "\t-" << std::endl;
+  std::cout << "buffer\tper_message\t" << buffer_bytes << "\t"
+            << buffer_time * 1000 << "\t-" << std::endl;
+}
+
+
+int main(int argc, char** argv) {
+  global_logger().set_log_level(LOG_WARNING);
+  global_logger().set_log_to_console(true);
+
+  graphlab::command_line_options
+    clopts("Compare stream and buffer archives.");
+  size_t nelements = 1000000;
+  clopts.attach_option("nelements", &nelements, nelements,
+                       "elements per vector");
+  if(!clopts.parse(argc, argv)) {
+    std::cout << "Error in parsing input." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  workload w(nelements);
+  std::cout << "archive\tworkload\tbytes\twrite ms\tread ms" << std::endl;
+  stream_target stream;
+  run_all(stream, "stream", w);
+  buffer_target buffer(graphlab::integer_encoding::FIXED_WIDTH);
+  run_all(buffer, "buffer", w);
+  buffer_target varint(graphlab::integer_encoding::VARINT);
+  run_all(varint, "varint", w);
+  run_small_messages(w.nmessages);
+  return EXIT_SUCCESS;
+} // End of main
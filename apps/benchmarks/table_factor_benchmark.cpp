@@ -0,0 +1,200 @@
+/*
+ *  Table factor kernel benchmark.
+ *  table_factor_benchmark.cpp
+ *
+ *  Times the operations of a belief propagation message update
+ *  (product with a message, division by a message, normalization,
+ *  marginalization, damping and the residual) on table factors over
+ *  1, 2 and 3 variables of arity 2, 3, 5, 10 and 32.  Every operation
+ *  is run with the table_factor kernels and with a reference version
+ *  which walks the table one assignment at a time, as table_factor
+ *  did before it used the log_space kernels.  The largest difference
+ *  between the two results is reported along with the timings.
+ */
+
+#include <string>
+#include <iostream>
+#include <cmath>
+#include <stdlib.h>
+#include <graphlab.hpp>
+#include <graphlab/factors/table_factor.hpp>
+#include <graphlab/macros_def.hpp>
+
+typedef graphlab::table_factor<4> factor_type;
+typedef factor_type::domain_type domain_type;
+typedef factor_type::assignment_type assignment_type;
+
+
+/** The reference versions of the kernels */
+namespace reference {
+
+  void multiply(factor_type& f, const factor_type& other) {
+    for(assignment_type asg = f.args().begin(); asg < f.args().end(); ++asg)
+      f.logP(asg.linear_index()) += other.logP(asg);
+  }
+
+  void divide(factor_type& f, const factor_type& other) {
+    for(assignment_type asg = f.args().begin(); asg < f.args().end(); ++asg)
+      f.logP(asg.linear_index()) -= other.logP(asg);
+  }
+
+  void normalize(factor_type& f) {
+    double max_value = f.logP(0);
+    for(size_t i = 0; i < f.size(); ++i)
+      max_value = std::max(max_value, f.logP(i));
+    double Z = 0.0;
+    for(size_t i = 0; i < f.size(); ++i) {
+      f.logP(i) -= max_value;
+      Z += std::exp(f.logP(i));
+    }
+    const double logZ = std::log(Z);
+    for(size_t i = 0; i < f.size(); ++i) {
+      f.logP(i) -= logZ;
+      if(f.logP(i) < graphlab::LOG_EPSILON)
+        f.logP(i) = -graphlab::MAX_DOUBLE;
+    }
+  }
+
+  void marginalize(factor_type& f, const factor_type& joint) {
+    domain_type ydom = joint.args() - f.args();
+    for(assignment_type xasg = f.args().begin();
+        xasg < f.args().end(); ++xasg) {
+      double sum = 0;
+      for(assignment_type yasg = ydom.begin(); yasg < ydom.end(); ++yasg) {
+        assignment_type joint_asg = xasg & yasg;
+        sum += std::exp(joint.logP(joint_asg.linear_index()));
+      }
+      if(sum == 0) f.logP(xasg.linear_index()) = -graphlab::MAX_DOUBLE;
+      else f.logP(xasg.linear_index()) = std::log(sum);
+    }
+  }
+
+  void damp(factor_type& f, const factor_type& other, double damping) {
+    for(size_t i = 0; i < f.size(); ++i) {
+      double val = damping * std::exp(other.logP(i)) +
+        (1 - damping) * std::exp(f.logP(i));
+      if(val == 0) f.logP(i) = -graphlab::MAX_DOUBLE;
+      else f.logP(i) = std::log(val);
+    }
+  }
+
+  double residual(const factor_type& f, const factor_type& other) {
+    double sum = 0;
+    for(size_t i = 0; i < f.size(); ++i)
+      sum += std::abs(std::exp(other.logP(i)) - std::exp(f.logP(i)));
+    return sum / f.size();
+  }
+
+} // end of namespace reference
+
+
+/** The factors of one message update */
+struct message_update {
+  factor_type joint;
+  factor_type message;
+  factor_type old_message;
+  factor_type belief;
+  factor_type new_message;
+
+  message_update(size_t nvars, size_t arity) {
+    std::vector<graphlab::variable> vars;
+    for(size_t i = 0; i < nvars; ++i)
+      vars.push_back(graphlab::variable(i, arity));
+    joint.set_args(domain_type(vars));
+    message.set_args(domain_type(vars[0]));
+    for(size_t i = 0; i < joint.size(); ++i)
+      joint.logP(i) = graphlab::random::rand01() * 4 - 2;
+    for(size_t i = 0; i < message.size(); ++i)
+      message.logP(i) = graphlab::random::rand01() * 4 - 2;
+    message.normalize();
+    old_message = message;
+    old_message.logP(0) -= 1;
+    old_message.normalize();
+    new_message = message;
+  }
+
+  /** One update with the table_factor kernels */
+  double run() {
+    belief = joint;
+    belief *= message;
+    belief /= old_message;
+    belief.normalize();
+    new_message.marginalize(belief);
+    new_message.normalize();
+    new_message.damp(old_message, 0.1);
+    return new_message.residual(old_message);
+  }
+
+  /** One update with the reference kernels */
+  double run_reference() {
+    belief = joint;
+    reference::multiply(belief, message);
+    reference::divide(belief, old_message);
+    reference::normalize(belief);
+    if(belief.args() == new_message.args()) new_message = belief;
+    else reference::marginalize(new_message, belief);
+    reference::normalize(new_message);
+    reference::damp(new_message, old_message, 0.1);
+    return reference::residual(new_message, old_message);
+  }
+}; // end of message_update
+
+
+/** The largest difference between the probabilities of two factors */
+double max_difference(const factor_type& a, const factor_type& b) {
+  ASSERT_EQ(a.size(), b.size());
+  double diff = 0;
+  for(size_t i = 0; i < a.size(); ++i)
+    diff = std::max(diff, std::abs(std::exp(a.logP(i)) - std::exp(b.logP(i))));
+  return diff;
+}
+
+
+int main(int argc, char** argv) {
+  global_logger().set_log_level(LOG_WARNING);
+  global_logger().set_log_to_console(true);
+
+  graphlab::command_line_options
+    clopts("Compare the table factor kernels with per assignment loops.");
+  size_t cells = 10000000;
+  clopts.attach_option("cells", &cells, cells,
+                       "factor cells processed per configuration");
+  if(!clopts.parse(argc, argv)) {
+    std::cout << "Error in parsing input." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  const size_t arities[] = {2, 3, 5, 10, 32};
+  std::cout << "vars\tarity\tcells\treference ns/update\t"
+            << "kernel ns/update\tspeedup\tmax difference" << std::endl;
+  for(size_t nvars = 1; nvars <= 3; ++nvars) {
+    for(size_t a = 0; a < sizeof(arities) / sizeof(arities[0]); ++a) {
+      message_update update(nvars, arities[a]);
+      const size_t nupdates =
+        std::max(cells / update.joint.size(), size_t(1));
+
+      double check = 0;
+      graphlab::timer ti;
+      ti.start();
+      for(size_t i = 0; i < nupdates; ++i) check += update.run_reference();
+      const double reference_time = ti.current_time();
+      const factor_type reference_message = update.new_message;
+
+      ti.start();
+      for(size_t i = 0; i < nupdates; ++i) check -= update.run();
+      const double kernel_time = ti.current_time();
+
+      ASSERT_LT(std::abs(check), 1e-6 * nupdates);
+      const double diff =
+        max_difference(reference_message, update.new_message);
+      ASSERT_LT(diff, 1e-9);
+      std::cout << nvars << "\t" << arities[a] << "\t"
+                << update.joint.size() << "\t"
+                << 1e9 * reference_time / nupdates << "\t"
+                << 1e9 * kernel_time / nupdates << "\t"
+                << (kernel_time > 0 ? reference_time / kernel_time : 0) << "\t"
+                << diff << std::endl;
+    }
+  }
+  return EXIT_SUCCESS;
+} // End of main
@@ -0,0 +1,115 @@
+/*
+ *  Termination detection benchmark.
+ *  termination_benchmark.cpp
+ *
+ *  Every thread repeatedly creates and completes a job, which is what
+ *  a scheduler does for every task, and every check_interval jobs
+ *  asks the termination checker whether the computation is finished,
+ *  as an idle cpu does.  The throughput of task_count_termination and
+ *  sharded_termination is reported for 1, 2, 4, ... up to maxthreads
+ *  threads.
+ */
+
+#include <string>
+#include <iostream>
+#include <stdlib.h>
+#include <graphlab.hpp>
+#include <graphlab/util/task_count_termination.hpp>
+#include <graphlab/util/sharded_termination.hpp>
+#include <graphlab/macros_def.hpp>
+
+
+/**
+ * Runs njobs new_job(), completed_job() rounds against a shared
+ * termination checker calling finish() every check_interval rounds.
+ */
+template<typename Terminator>
+class termination_worker : public graphlab::runnable {
+public:
+  termination_worker(Terminator* terminator = NULL, size_t njobs = 0,
+                     size_t check_interval = 1) :
+    terminator(terminator), njobs(njobs), check_interval(check_interval),
+    finished(0) { }
+
+  void run() {
+    for(size_t i = 0; i < njobs; ++i) {
+      terminator->new_job();
+      // The job is still outstanding so this is never true
+      if(i % check_interval == 0) finished += terminator->finish();
+      terminator->completed_job();
+    }
+  }
+
+  Terminator* terminator;
+  size_t njobs;
+  size_t check_interval;
+  size_t finished;
+}; // end of termination worker
+
+
+/**
+ * Run the jobs on nthreads threads and return the number of jobs per
+ * second.
+ */
+template<typename Terminator>
+double run_terminator(size_t nthreads, size_t njobs, size_t check_interval) {
+  Terminator terminator(nthreads);
+  std::vector< termination_worker<Terminator> >
+    workers(nthreads, termination_worker<Terminator>(&terminator, njobs,
+                                                     check_interval));
+  graphlab::timer ti;
+  ti.start();
+  graphlab::thread_group threads;
+  for(size_t i = 0; i < nthreads; ++i) threads.launch(&workers[i]);
+  threads.join();
+  double runtime = ti.current_time();
+  size_t finished = 0;
+  for(size_t i = 0; i < nthreads; ++i) finished += workers[i].finished;
+  ASSERT_EQ(finished, size_t(0));
+  ASSERT_TRUE(terminator.finish());
+  return runtime > 0 ? (nthreads * njobs) / runtime : 0;
+} // end of run terminator
+
+
+/**
+ * task_count_termination has no cpu count constructor.  Wrap it so
+ * both checkers can be driven by the same template.
+ */
+struct task_count_terminator : public graphlab::task_count_termination {
+  task_count_terminator(size_t ncpus) { }
+};
+
+
+int main(int argc, char** argv) {
+  global_logger().set_log_level(LOG_WARNING);
+  global_logger().set_log_to_console(true);
+
+  graphlab::command_line_options
+    clopts("Compare the task count and sharded termination checkers.");
+  size_t maxthreads = 64;
+  size_t njobs = 1000000;
+  clopts.attach_option("maxthreads", &maxthreads, maxthreads,
+                       "largest number of threads");
+  size_t check_interval = 16;
+  clopts.attach_option("njobs", &njobs, njobs, "jobs per thread");
+  clopts.attach_option("check_interval", &check_interval, check_interval,
+                       "jobs between calls to finish()");
+  if(!clopts.parse(argc, argv)) {
+    std::cout << "Error in parsing input." << std::endl;
+    return EXIT_FAILURE;
+  }
+  if(check_interval == 0) check_interval = 1;
+
+  std::cout << "threads\ttask_count jobs/sec\tsharded jobs/sec" << std::endl;
+  for(size_t nthreads = 1; nthreads <= maxthreads; nthreads *= 2) {
+    double task_count_rate =
+      run_terminator<task_count_terminator>(nthreads, njobs, check_interval);
+    double sharded_rate =
+      run_terminator<graphlab::sharded_termination>(nthreads, njobs,
+                                                    check_interval);
+    std::cout << nthreads << "\t" << task_count_rate
+              << "\t" << sharded_rate << std::endl;
+  }
+  return EXIT_SUCCESS;
+} // End of main
+
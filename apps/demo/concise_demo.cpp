@@ -24,7 +24,7 @@ void update_function(gl::iscope& scope,
                      gl::icallback& scheduler,
                      gl::ishared_data* shared_data) {
   vertex_data& curvdata = scope.vertex_data();
-  const std::vector<gl::edge_id_t>& in_edges = scope.in_edge_ids();
+  gl::edge_list in_edges = scope.in_edge_ids();
   size_t num_red_neighbors = 0;  
   for (size_t i = 0; i < in_edges.size(); ++i) {
     size_t eid = in_edges[i];    
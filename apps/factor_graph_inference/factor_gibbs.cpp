@@ -105,6 +105,9 @@ int main(int argc, char** argv) {
   total_colors = parallel_graph_color(mrf_graph, opts.ncpus);
   std::cout << "Finished with " << total_colors << " colors." << std::endl;
   assert(total_colors > 0);
+  // Give the coloring to the graph for the chromatic engine
+  for(graphlab::vertex_id_t v = 0; v < mrf_graph.num_vertices(); ++v)
+    mrf_graph.color(v) = mrf_graph.vertex_data(v).color;
     
   // Setup extra parameters in shared data ------------------------------------>
   std::cout << "Setting up shared data." << std::endl;
@@ -309,7 +312,7 @@ bool parse_command_line(int argc, char** argv, options& opts) {
      "Options are {unsync, locked}")
     ("engine",
      boost_po::value<std::string>(&(opts.engine))->default_value("threaded"),
-     "Options are {threaded, sequential}")
+     "Options are {async, synchronous, chromatic}")
     ("scope",
      boost_po::value<std::string>(&(opts.scope))->default_value("locked"),
      "Options are {unsync, locked}")
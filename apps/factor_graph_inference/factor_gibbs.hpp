@@ -98,7 +98,7 @@ void gibbs_update(gl_types::iscope& scope,
   
   
   // Get the out edges
-  const std::vector<graphlab::edge_id_t>& out_edges = 
+  graphlab::edge_list out_edges = 
     scope.out_edge_ids();
 
   // Get all the neighbor vertices assignments
@@ -188,7 +188,7 @@ void color_update(gl_types::iscope& scope,
   vertex_data& vdata = scope.vertex_data();
   
   // Get the out edges
-  const std::vector<graphlab::edge_id_t>& out_edges = 
+  graphlab::edge_list out_edges = 
     scope.out_edge_ids();
   
   std::set<uint16_t> neighbor_colors;
@@ -308,8 +308,8 @@ void gabp_update_function(gl_types::iscope &scope,
    
   /* GET current vertex data */
   vertex_data& vdata = scope.vertex_data();
-  const std::vector<gl_types::edge_id_t>& inedgeid = scope.in_edge_ids();
-  const std::vector<gl_types::edge_id_t>& outedgeid = scope.out_edge_ids();
+  gl_types::edge_list inedgeid = scope.in_edge_ids();
+  gl_types::edge_list outedgeid = scope.out_edge_ids();
 
   // Get entries from shared data
   assert(shared_data != NULL);
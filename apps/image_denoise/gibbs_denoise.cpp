@@ -388,7 +388,7 @@ bool parse_command_line(int argc, char** argv, options& opts) {
      "Options are {square, laplace}")
     ("engine",
      boost_po::value<std::string>(&(opts.engine))->default_value("threaded"),
-     "Options are {threaded, sequential}")
+     "Options are {async, synchronous, chromatic}")
     ("scope",
      boost_po::value<std::string>(&(opts.scope))->default_value("edge"),
      "Options are {vertex, edge, full}")
@@ -487,6 +487,8 @@ void construct_graph(image& img,
       size_t vert_id = graph.add_vertex(vdata);
       // Ensure that we are using a consistent numbering
       assert(vert_id == pixel_id);
+      // The checkerboard is also the coloring of the chromatic engine
+      graph.color(vert_id) = vdata.color;
     } // end of for j in cols
   } // end of for i in rows
   // Construct an edge blob
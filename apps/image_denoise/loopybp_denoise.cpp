@@ -318,9 +318,9 @@ void bp_update(gl_types::iscope& scope,
   vertex_data& v_data = scope.vertex_data();
   
   // Get the in and out edges by reference
-  const std::vector<graphlab::edge_id_t>& in_edges = 
+  graphlab::edge_list in_edges = 
     scope.in_edge_ids();
-  const std::vector<graphlab::edge_id_t>& out_edges = 
+  graphlab::edge_list out_edges = 
     scope.out_edge_ids();
   assert(in_edges.size() == out_edges.size()); // Sanity check
 
@@ -72,7 +72,7 @@ void pagerank_init(gl_types::iscope &scope,
 	// Get the data associated with the vertex
 	vertex_data& vdata = scope.vertex_data();
 	vdata = init_value;
-	const std::vector<graphlab::edge_id_t>& outedges = scope.out_edge_ids();
+	graphlab::edge_list outedges = scope.out_edge_ids();
  	if(outedges.size() !=0){
 		foreach(graphlab::edge_id_t eid, outedges){
 			edge_data& edata = scope.edge_data(eid);
@@ -202,7 +202,8 @@ int main(int argc, char** argv) {
 	// Create a graphlab core
 	gl_types::core core;
 	clopts.attach_option("infile", &filename,
-			"PageRank input file. In src, dest format.");
+			"PageRank input file. In src, dest format, or a .bin file "
+			"written by tsv_to_graphlab_bin.");
 
 	clopts.attach_option("outfile", &savefile,
 			"PageRank output filename");
@@ -319,6 +320,10 @@ bool load_graph(const std::string filename,
 		pagerank_graph& graph) {
 	//assert(filename.substr(filename.length-3,3) != "txt");
 	std::cout<<"input file :"<<filename<<std::endl;
+	// Graphs converted with tsv_to_graphlab_bin are loaded directly
+	if(filename.size() > 4 &&
+	   filename.substr(filename.size() - 4) == ".bin")
+		return graph.load_binary(filename);
 	FILE* inf = fopen(filename.c_str(),"r");
 	assert(inf != NULL);
 
@@ -73,7 +73,7 @@ void pagerank_init(gl_types::iscope &scope,
 	// Get the data associated with the vertex
 	vertex_data& vdata = scope.vertex_data();
 	vdata = init_value;
-	const std::vector<graphlab::edge_id_t>& outedges = scope.out_edge_ids();
+	graphlab::edge_list outedges = scope.out_edge_ids();
  	if(outedges.size() !=0){
 		foreach(graphlab::edge_id_t eid, outedges){
 			edge_data& edata = scope.edge_data(eid);
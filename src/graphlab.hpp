@@ -114,6 +114,7 @@ namespace graphlab {
     template<typename Scheduler, typename ScopeFactory>
     struct engines {
       typedef graphlab::synchronous_engine<graph> synchronous;
+      typedef graphlab::chromatic_engine<graph> chromatic;
       typedef graphlab::
       asynchronous_engine<graph, Scheduler, ScopeFactory> asynchronous;
       #ifdef GLDISTRIBUTED
@@ -142,6 +143,8 @@ namespace graphlab {
     
     typedef graphlab::vertex_id_t vertex_id_t;
     typedef graphlab::edge_id_t edge_id_t;
+    typedef graphlab::edge_list edge_list;
+    typedef graphlab::vertex_list vertex_list;
     
     typedef graphlab::scheduler_options          scheduler_options;
     typedef graphlab::sched_status               sched_status;
@@ -0,0 +1,94 @@
+#ifndef DC_BUFFER_POOL_HPP
+#define DC_BUFFER_POOL_HPP
+
+#include <cstdlib>
+#include <vector>
+#include <graphlab/parallel/pthread_tools.hpp>
+#include <graphlab/logger/logger.hpp>
+
+namespace graphlab {
+
+/**
+ * A thread safe pool of message buffers.  Buffers of up to
+ * block_size bytes are all block_size bytes long and are kept on a
+ * free list when released, so that steady message traffic does not
+ * go through malloc and free.  Larger buffers are allocated and freed
+ * normally.  At most max_free buffers are kept.
+ */
+class dc_buffer_pool {
+ public:
+  dc_buffer_pool(size_t block_size = 65536, size_t max_free = 256) :
+      block_size(block_size), max_free(max_free), num_reused(0),
+      num_allocated(0) { }
+
+  ~dc_buffer_pool() {
+    for (size_t i = 0; i < free_blocks.size(); ++i) free(free_blocks[i]);
+  }
+
+  /** The size of the pooled buffers */
+  size_t get_block_size() const { return block_size; }
+
+  /**
+   * Returns a buffer of at least max(len, block_size) bytes. It must
+   * be released with the same len.
+   */
+  char* allocate(size_t len) {
+    if (len <= block_size) {
+      lock.lock();
+      if (!free_blocks.empty()) {
+        char* buf = free_blocks.back();
+        free_blocks.pop_back();
+        ++num_reused;
+        lock.unlock();
+        return buf;
+      }
+      ++num_allocated;
+      lock.unlock();
+      len = block_size;
+    } else {
+      lock.lock();
+      ++num_allocated;
+      lock.unlock();
+    }
+    char* buf = (char*)malloc(len);
+    ASSERT_MSG(buf != NULL, "Could not allocate a message buffer of %lu bytes",
+               (unsigned long)len);
+    return buf;
+  }
+
+  /** Returns a buffer obtained from allocate(len) to the pool */
+  void release(char* buf, size_t len) {
+    if (len <= block_size) {
+      lock.lock();
+      if (free_blocks.size() < max_free) {
+        free_blocks.push_back(buf);
+        lock.unlock();
+        return;
+      }
+      lock.unlock();
+    }
+    free(buf);
+  }
+
+  /** The number of allocations served from the free list */
+  size_t reused() const { return num_reused; }
+
+  /** The number of allocations which had to call malloc */
+  size_t allocated() const { return num_allocated; }
+
+ private:
+  size_t block_size;
+  size_t max_free;
+  spinlock lock;
+  std::vector<char*> free_blocks;
+  size_t num_reused;
+  size_t num_allocated;
+
+  // Not copyable
+  dc_buffer_pool(const dc_buffer_pool&);
+  dc_buffer_pool& operator=(const dc_buffer_pool&);
+};
+
+}
+
+#endif
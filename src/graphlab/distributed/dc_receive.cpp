@@ -4,16 +4,13 @@
 
 
 #include <poll.h>
+#include <sys/epoll.h>
 
 
 
 #include <iostream>
 #include <string>
 
-#include <boost/iostreams/device/array.hpp>
-#include <boost/iostreams/stream.hpp>
-
-
 #include <graphlab/distributed/distributed_control.hpp>
 #include <graphlab/distributed/dc_internal.hpp>
 
@@ -43,7 +40,15 @@ void distributed_control::message_dispatch_thread::run() {
       default:
         ASSERT_MSG(false, "Invalid Packet Type %d", packtype);
     }
-    free(ret.first.buf);
+    release_recv_slab(ret.first.slab);
+    // wake the receive threads if this brought the queue under the limit
+    const size_t pending = dc.dispatch_pending_bytes.dec(ret.first.len);
+    if (pending <= dc.max_dispatch_bytes &&
+        pending + ret.first.len > dc.max_dispatch_bytes) {
+      dc.dispatch_space_lock.lock();
+      dc.dispatch_space_cond.broadcast();
+      dc.dispatch_space_lock.unlock();
+    }
     if (packtype != REMOTECALL_CONTROL_ID) dc.msgprocessed.inc();
   }
 }
@@ -61,115 +66,104 @@ distributed_control::messageproc_thread::~messageproc_thread() {
 }
 
 void distributed_control::messageproc_thread::run() {
-  // build the selects
-
   logger(LOG_INFO, "Message Processing Thread %d/%d started",
                     thread::thread_id() + 1, dc->procs.size());
-  size_t j = 0;
-  size_t sockid = 0;
-  for (size_t i = 0;i < dc->socks.size(); ++i) {
-    // if it is not to my self
-    if (i != dc->procid()) {
-      if (j == thread::thread_id()) {
-        sockid = i;
-        break;
-      }
-      ++j;
-    }
-  }
+  dc->receive_loop();
+  logger(LOG_INFO, "Message Processing Thread stopped");
+}
+
 
-  while(!(*done)) {
-    dc->receive_handler(dc->socks[sockid], dc->buffer[sockid]);
+/**
+ * Queues the packets parsed by a dc_slab_receiver for the dispatch
+ * threads, which release them after calling their handlers
+ */
+struct distributed_control::dispatch_enqueuer {
+  distributed_control& dc;
+  dispatch_enqueuer(distributed_control& dc) : dc(dc) { }
+  void operator()(dc_recv_slab* slab, char* buf, size_t len) {
+    dispatch_req_data dispatchreq;
+    dispatchreq.buf = buf;
+    dispatchreq.len = len;
+    dispatchreq.slab = slab;
+    dc.dispatch_pending_bytes.inc(len);
+    dc.dispatch_requests.enqueue(dispatchreq);
+    dc.messages_received.inc();
   }
+};
 
-  logger(LOG_INFO, "Message Processing Thread stopped");
+
+/// recv() calls made on one socket before moving on to other sockets
+static const size_t RECV_CALLS_PER_EVENT = 16;
+
+void distributed_control::receive_loop() {
+  dispatch_enqueuer dispatch(*this);
+  const int maxevents = 16;
+  epoll_event events[maxevents];
+  while(!done) {
+    int nevents = epoll_wait(epollfd, events, maxevents, -1);
+    if (nevents < 0) {
+      if (errno == EINTR) continue;
+      logstream(LOG_FATAL) << "epoll_wait error: " << strerror(errno) << std::endl;
+      ASSERT_TRUE(false);
+    }
+    for (int i = 0; i < nevents; ++i) {
+      // wakefd is never read, so every thread sees it
+      if (events[i].data.u32 == numprocs()) return;
+      const procid_t source = events[i].data.u32;
+      if (!receive_from(source, dispatch)) return;
+      // the socket was registered EPOLLONESHOT so no other thread
+      // reads from it until it is rearmed. Rearming reports it again
+      // if there is still data waiting
+      epoll_event ev;
+      ev.events = EPOLLIN | EPOLLET | EPOLLONESHOT;
+      ev.data.u32 = source;
+      epoll_ctl(epollfd, EPOLL_CTL_MOD, socks[source], &ev);
+    }
+  }
 }
 
 
-void distributed_control::receive_handler(sockfd_t sock,recv_buffer &buffer) {
-  while(1) {
-    if (done) return;
-    // receive the message
-    ASSERT_GT((int)(buffer.buflen) - (int)(buffer.buftail), 0);
-    int msglen = recv(sock, buffer.buffer + buffer.buftail, buffer.buflen - buffer.buftail, 0);
+bool distributed_control::receive_from(procid_t source,
+                                       dispatch_enqueuer& dispatch) {
+  for (size_t i = 0; i < RECV_CALLS_PER_EVENT; ++i) {
+    wait_for_dispatch_space();
+    if (done) return false;
+    // receive and queue every complete packet
+    ssize_t msglen = receivers[source]->receive(socks[source], dispatch,
+                                                MSG_DONTWAIT);
     // check for various failure conditions
     if (msglen < 0) {
       if (errno == EINTR) {
         continue;
       }
-      else if (errno == EAGAIN) {
-        continue;
+      else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        // drained. The next edge will report new data
+        return true;
       }
       else {
         logstream(LOG_FATAL) << "Receive Error: " << strerror(errno) << std::endl;
         ASSERT_TRUE(false);
       }
     }
-    if (done) return;
     else if (msglen == 0) {
-      // nothing left to do
+      if (done) return false;
       // in fact this means connection closed
       ASSERT_MSG(false, "Unexpected connection close");
-      
-      return;
-    }
-    //logger(LOG_INFO, "Receiving %d on sock %d", msglen, sock);
-    // push the new location of buftail
-    buffer.buftail += msglen;
-    ASSERT_LE(buffer.buftail, buffer.buflen);
-    // this the desired packet length
-    if (buffer.buftail < 4) continue;
-    // Update the buffer counters
-    pheaderlen_t packetlen = *reinterpret_cast<pheaderlen_t*>(buffer.buffer);
-
-    buffer.num_recvcalls++;
-    
-    
-    // if my buffer will not fit. resize the buffer
-    // remember to factor in the header size
-    size_t eff_packetsize = packetlen + sizeof(pheaderlen_t);
-    if (buffer.buflen < eff_packetsize) {
-      buffer.buffer = (char*)realloc(buffer.buffer, 2 * eff_packetsize);
-      buffer.buflen = 2 * eff_packetsize;
+      return false;
     }
+  }
+  return true;
+}
 
-    ASSERT_GE(buffer.buflen, buffer.minimum_buflen);
-    // while I have complete packets in my buffer
-    size_t bufhead = 0;
-    while(1) {
-      // if there is not even room to read the header, break
-      if (bufhead + sizeof(pheaderlen_t) > buffer.buftail) break;
-      
-      pheaderlen_t packetlen = *reinterpret_cast<pheaderlen_t*>(buffer.buffer + bufhead);
-      size_t eff_packetsize = packetlen + sizeof(pheaderlen_t);
-      //logger(LOG_INFO, "Receiving packet of size %d on sock %d", packetlen, sock);
-      // do we have the entire packet?
-      if (buffer.buftail - bufhead >= eff_packetsize) {
-        //logger(LOG_INFO, "Dispatch");
-        // yep we have room
-        // shift the head
-        bufhead += sizeof(pheaderlen_t);
-        
-        dispatch_req_data dispatchreq;
-        dispatchreq.buf = (char*)malloc(packetlen);
-        dispatchreq.len = packetlen;
-        
-        ASSERT_MSG(dispatchreq.buf != NULL, "Could not allocate memory in dc_receive! Errno=%d", errno);
-        
-        memcpy(dispatchreq.buf, buffer.buffer + bufhead, packetlen);
-        dispatch_requests.enqueue(dispatchreq);
 
-        // shift the bufhead
-        bufhead += packetlen;
-      }
-      else {
-        break;
-      }
-    }
-    // roll up the buffer
-    memmove(buffer.buffer, buffer.buffer + bufhead, buffer.buftail - bufhead);
-    buffer.buftail = buffer.buftail - bufhead;
+void distributed_control::wait_for_dispatch_space() {
+  if (dispatch_pending_bytes.value <= max_dispatch_bytes) return;
+  dispatch_space_lock.lock();
+  // the timeout lets the wait notice done
+  while (dispatch_pending_bytes.value > max_dispatch_bytes && !done) {
+    dispatch_space_cond.timedwait_ms(dispatch_space_lock, 10);
   }
+  dispatch_space_lock.unlock();
 }
 
                              
@@ -261,8 +255,7 @@ void distributed_control::receive_callxs_message(char* msg, size_t len) {
   void* stackptr = NULL;
   if (packd->len > 0) blobptr = msg + sizeof(remotecallxs_packdata);
   stackptr = msg + sizeof(remotecallxs_packdata) + packd->len;
-  boost::iostreams::stream<boost::iostreams::array_source>  streamin((char*)stackptr, packd->stacklen);
-  iarchive arc(streamin);
+  iarchive arc((const char*)stackptr, packd->stacklen);
   xsdispatcher xsdispatchptr = (xsdispatcher)(packd->fnptr);
   (xsdispatchptr)(*this, packd->srcnodeid, blobptr, packd->len, arc); 
 }
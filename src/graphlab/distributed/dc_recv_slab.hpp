@@ -0,0 +1,132 @@
+#ifndef DC_RECV_SLAB_HPP
+#define DC_RECV_SLAB_HPP
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <stdint.h>
+#include <cstring>
+#include <algorithm>
+#include <graphlab/parallel/atomic.hpp>
+#include <graphlab/distributed/dc_buffer_pool.hpp>
+
+namespace graphlab {
+
+/**
+ * A receive buffer holding a run of packets read from a socket.
+ * Packets are handed out as pointers into the slab, each holding a
+ * reference to it. The slab returns to its pool when the last
+ * reference is released.
+ */
+struct dc_recv_slab {
+  char* data;
+  size_t capacity;
+  atomic<size_t> refs;
+  dc_buffer_pool* pool;
+};
+
+/** Drops one reference to the slab, recycling it if it was the last */
+inline void release_recv_slab(dc_recv_slab* slab) {
+  if (slab->refs.dec() == 0) {
+    slab->pool->release(slab->data, slab->capacity);
+    delete slab;
+  }
+}
+
+
+/**
+ * Reads packets, each preceded by its uint32_t length (pheaderlen_t),
+ * from a socket into slabs from a dc_buffer_pool, and parses them
+ * where they were received. A packet is never split across slabs: a
+ * partial packet at the end of a slab is moved to the start of the
+ * next one, which is made large enough to hold it. Only one thread
+ * may call receive() at a time.
+ */
+class dc_slab_receiver {
+ public:
+  dc_slab_receiver(dc_buffer_pool& pool) : pool(pool), slab(NULL),
+                                           head(0), tail(0), recvcalls(0) {
+    next_slab(0);
+  }
+
+  ~dc_slab_receiver() {
+    release_recv_slab(slab);
+  }
+
+  /**
+   * Makes one recv() call with the given flags and passes every
+   * complete packet to dispatch(slab, packet, len). Each call holds a
+   * new reference to the slab which the receiver of the packet must
+   * release with release_recv_slab() once it is done with it. Returns
+   * the result of recv().
+   */
+  template <typename Dispatch>
+  ssize_t receive(int sock, Dispatch& dispatch, int flags = 0) {
+    ssize_t msglen = recv(sock, slab->data + tail, slab->capacity - tail,
+                          flags);
+    if (msglen <= 0) return msglen;
+    ++recvcalls;
+    tail += msglen;
+    size_t needed = sizeof(uint32_t);
+    while (tail - head >= sizeof(uint32_t)) {
+      uint32_t packetlen;
+      memcpy(&packetlen, slab->data + head, sizeof(uint32_t));
+      needed = packetlen + sizeof(uint32_t);
+      if (tail - head < needed) break;
+      slab->refs.inc();
+      dispatch(slab, slab->data + head + sizeof(uint32_t), size_t(packetlen));
+      head += needed;
+      needed = sizeof(uint32_t);
+    }
+    if (head == tail && slab->refs.value == 1) {
+      // every packet has been released. Only this thread can take new
+      // references so the slab can be refilled from the start
+      head = tail = 0;
+    }
+    else if (head + needed > slab->capacity ||
+             (head == tail && slab->capacity - tail < slab->capacity / 8)) {
+      // the next packet does not fit or there is little room left
+      next_slab(needed);
+    }
+    return msglen;
+  }
+
+  /** The number of recv() calls which returned data */
+  size_t num_recvcalls() const { return recvcalls; }
+
+ private:
+  dc_buffer_pool& pool;
+  /// the slab being filled, to which the receiver holds a reference
+  dc_recv_slab* slab;
+  /// the first unparsed byte and the end of the received data
+  size_t head;
+  size_t tail;
+  size_t recvcalls;
+
+  /**
+   * Starts a new slab of at least needed bytes holding the unparsed
+   * bytes of the current one
+   */
+  void next_slab(size_t needed) {
+    dc_recv_slab* newslab = new dc_recv_slab;
+    newslab->capacity = std::max(needed, pool.get_block_size());
+    newslab->data = pool.allocate(newslab->capacity);
+    newslab->refs.value = 1;
+    newslab->pool = &pool;
+    const size_t pending = tail - head;
+    if (slab != NULL) {
+      memcpy(newslab->data, slab->data + head, pending);
+      release_recv_slab(slab);
+    }
+    slab = newslab;
+    head = 0;
+    tail = pending;
+  }
+
+  // Not copyable
+  dc_slab_receiver(const dc_slab_receiver&);
+  dc_slab_receiver& operator=(const dc_slab_receiver&);
+};
+
+}
+
+#endif
@@ -1,7 +1,11 @@
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
+#include <limits.h>
 //#include <aio.h>
 
+#include <algorithm>
+
 
 #include <graphlab/distributed/distributed_control.hpp>
 #include <graphlab/distributed/dc_internal.hpp>
@@ -9,23 +13,137 @@
 namespace graphlab {
   
 
-void distributed_control::send_to_sock(procid_t target, char* buf, size_t len) {
-  pheaderlen_t *p = (pheaderlen_t*)buf;
-  (*p) = len;
-  //sendlocks[target].lock();
-  // logger(LOG_INFO, "Sending %d", len);
-  int numsent = 0;
-  int totallen = len + sizeof(pheaderlen_t);
-  while (numsent < totallen) {
-    int ret = send(socks[target], buf + numsent, totallen - numsent, 0);
+char* distributed_control::begin_send(procid_t target, size_t packlength) {
+  DCHECK_LT(target, send_buffers.size());
+  DCHECK_LE(packlength, std::numeric_limits<pheaderlen_t>::max());
+  send_buffer& sb = send_buffers[target];
+  const size_t total = packlength + sizeof(pheaderlen_t);
+  sb.lock.lock();
+  if (sb.blocks.empty() || 
+      sb.blocks.back().len + total > sb.blocks.back().capacity) {
+    // start a new block. Packets larger than a block get their own
+    const size_t capacity = std::max(total, send_pool.get_block_size());
+    sb.blocks.push_back(send_block(send_pool.allocate(capacity), 0, capacity));
+  }
+  send_block& block = sb.blocks.back();
+  char* pos = block.buf + block.len;
+  *reinterpret_cast<pheaderlen_t*>(pos) = pheaderlen_t(packlength);
+  block.len += total;
+  sb.nmessages++;
+  sb.nbytes += total;
+  return pos + sizeof(pheaderlen_t);
+}
+
+void distributed_control::end_send(procid_t target) {
+  // counted before the send thread can take the message. inc() is a
+  // full barrier, so either the send thread sees the message before
+  // going to sleep or we see it sleeping
+  send_pending.inc();
+  send_buffers[target].lock.unlock();
+  if (send_sleeping) {
+    send_wake_lock.lock();
+    send_wake_cond.signal();
+    send_wake_lock.unlock();
+  }
+}
+
+void distributed_control::set_send_coalescing(size_t flush_bytes,
+                                              size_t latency_us) {
+  send_flush_bytes = flush_bytes;
+  send_latency_us = latency_us;
+}
+
+void distributed_control::send_loop() {
+  while(1) {
+    send_wake_lock.lock();
+    send_sleeping = true;
+    __sync_synchronize();
+    while (send_pending.value == 0 && !send_stopping) {
+      send_wake_cond.wait(send_wake_lock);
+    }
+    send_sleeping = false;
+    if (send_stopping && send_pending.value == 0) {
+      send_wake_lock.unlock();
+      break;
+    }
+    send_wake_lock.unlock();
+    // give the writers a moment to add to the buffers
+    if (send_latency_us > 0 && !send_stopping) {
+      size_t buffered = 0;
+      for (size_t i = 0; i < send_buffers.size(); ++i) {
+        buffered += send_buffers[i].nbytes;
+      }
+      if (buffered < send_flush_bytes) {
+        send_wake_lock.lock();
+        send_wake_cond.timedwait_us(send_wake_lock, send_latency_us);
+        send_wake_lock.unlock();
+      }
+    }
+    for (procid_t i = 0; i < send_buffers.size(); ++i) {
+      if (i != id) flush_send_buffer(i);
+    }
+  }
+}
+
+void distributed_control::flush_send_buffer(procid_t target) {
+  send_buffer& sb = send_buffers[target];
+  // only this thread touches sb.sending
+  std::vector<send_block>& blocks = sb.sending;
+  sb.lock.lock();
+  if (sb.nmessages == 0) {
+    sb.lock.unlock();
+    return;
+  }
+  blocks.swap(sb.blocks);
+  const size_t nmessages = sb.nmessages;
+  sb.nmessages = 0;
+  sb.nbytes = 0;
+  sb.lock.unlock();
+  send_pending.dec(nmessages);
+
+  // send all the blocks with as few writev calls as possible
+  std::vector<struct iovec> iov(blocks.size());
+  size_t totallen = 0;
+  for (size_t i = 0; i < blocks.size(); ++i) {
+    iov[i].iov_base = blocks[i].buf;
+    iov[i].iov_len = blocks[i].len;
+    totallen += blocks[i].len;
+  }
+  size_t first = 0;
+  while (first < iov.size()) {
+    const int count = (int)std::min(iov.size() - first, size_t(IOV_MAX));
+    ssize_t ret = writev(socks[target], &iov[first], count);
     if (ret < 0) {
+      if (errno == EINTR) continue;
       logstream(LOG_FATAL) << "send error: " << strerror(errno) << std::endl;
       ASSERT_TRUE(false);
     }
-    numsent += ret;
+    ++send_calls;
+    // skip what was sent
+    size_t sent = size_t(ret);
+    while (first < iov.size() && sent >= iov[first].iov_len) {
+      sent -= iov[first].iov_len;
+      ++first;
+    }
+    if (sent > 0) {
+      iov[first].iov_base = (char*)iov[first].iov_base + sent;
+      iov[first].iov_len -= sent;
+    }
   }
-  //sendlocks[target].unlock();
-  free(buf);
+  messages_sent += nmessages;
+  send_thread->bytes_sent += totallen;
+  for (size_t i = 0; i < blocks.size(); ++i) {
+    send_pool.release(blocks[i].buf, blocks[i].capacity);
+  }
+  blocks.clear();
+}
+
+void distributed_control::stop_sending() {
+  send_wake_lock.lock();
+  send_stopping = true;
+  send_wake_cond.signal();
+  send_wake_lock.unlock();
+  send_thread->join();
 }
 
 void distributed_control::send_call_message(procid_t target, 
@@ -40,9 +158,7 @@ void distributed_control::send_call_message(procid_t target,
   size_t packlength = sizeof(remotecall_packdata) + 
                       sizeof(handlerarg_t) * numargs + len;
 
-  char * sendbuffer = (char*)malloc(packlength + sizeof(pheaderlen_t));
-  char * realbufpos = sendbuffer + sizeof(pheaderlen_t);
-  ASSERT_NE(sendbuffer, NULL);
+  char * realbufpos = begin_send(target, packlength);
 
   // pack the data
   remotecall_packdata* p = (remotecall_packdata*)(realbufpos);
@@ -58,10 +174,7 @@ void distributed_control::send_call_message(procid_t target,
   size_t blobbegin = packlength - len;
   memcpy(realbufpos + blobbegin, ptr, len);
   
-  // send! print output on failure and quit
-  //logger(LOG_INFO, "Total Sent %d", ctr);
-  //send_to_sock(target, sendbuffer, packlength);
-  send_requests.enqueue(send_req_data(target, sendbuffer, packlength));
+  end_send(target);
 }
 
 
@@ -74,10 +187,7 @@ void distributed_control::send_callx_message(procid_t target, void* remote_funct
 
   // compute the message size 
   size_t packlength = sizeof(remotecallx_packdata) +len +stacklen;
-  // allocate    
-  char* sendbuffer = (char*)malloc(packlength + sizeof(pheaderlen_t));
-  char* realbufpos = sendbuffer + sizeof(pheaderlen_t);
-  ASSERT_NE(sendbuffer, NULL);
+  char* realbufpos = begin_send(target, packlength);
 
   // pack the data 
   remotecallx_packdata* p =  (remotecallx_packdata*)(realbufpos);
@@ -92,22 +202,20 @@ void distributed_control::send_callx_message(procid_t target, void* remote_funct
          stackbegin, stacklen);
          
 
-  send_requests.enqueue(send_req_data(target, sendbuffer, packlength));
+  end_send(target);
   
 }
 
 void distributed_control::send_callxs_message(procid_t target, void* remote_function, 
-                        void* ptr, size_t len,const std::string &stack) {
+                        void* ptr, size_t len,const char* stack,
+                        size_t stacklen) {
   msgsent.inc();
   DCHECK_NE(target, id);
   DCHECK_LE(len, std::numeric_limits<uint32_t>::max());
 
   // compute the message size 
-  size_t packlength = sizeof(remotecallxs_packdata) + len + stack.length();
-  // allocate    
-  char* sendbuffer = (char*)malloc(packlength + sizeof(pheaderlen_t));
-  char* realbufpos = sendbuffer + sizeof(pheaderlen_t);
-  ASSERT_NE(sendbuffer, NULL);
+  size_t packlength = sizeof(remotecallxs_packdata) + len + stacklen;
+  char* realbufpos = begin_send(target, packlength);
 
   // pack the data 
   remotecallxs_packdata* p =  (remotecallxs_packdata*)(realbufpos);
@@ -116,12 +224,14 @@ void distributed_control::send_callxs_message(procid_t target, void* remote_func
   p->srcnodeid = id;
   p->fnptr = remote_function;
   p->len = uint32_t(len);
-  p->stacklen = uint32_t(stack.length());
+  p->stacklen = uint32_t(stacklen);
   memcpy(realbufpos + sizeof(remotecallx_packdata), ptr, len);
-  memcpy(realbufpos + sizeof(remotecallx_packdata) +len ,
-         stack.c_str(), stack.length());
+  if (stacklen > 0) {
+    memcpy(realbufpos + sizeof(remotecallx_packdata) +len ,
+           stack, stacklen);
+  }
 
-  send_requests.enqueue(send_req_data(target, sendbuffer, packlength));
+  end_send(target);
   
 }
 
@@ -136,10 +246,7 @@ void distributed_control::send_call_control_message(procid_t target, void* remot
 
   // compute the message size
   size_t packlength = sizeof(remotecallx_packdata) +len +stacklen;
-  // allocate
-  char* sendbuffer = (char*)malloc(packlength + sizeof(pheaderlen_t));
-  char* realbufpos = sendbuffer + sizeof(pheaderlen_t);
-  ASSERT_NE(sendbuffer, NULL);
+  char* realbufpos = begin_send(target, packlength);
 
   // pack the data
   remotecallx_packdata* p =  (remotecallx_packdata*)(realbufpos);
@@ -154,7 +261,7 @@ void distributed_control::send_call_control_message(procid_t target, void* remot
          stackbegin, stacklen);
 
 
-  send_requests.enqueue(send_req_data(target, sendbuffer, packlength));
+  end_send(target);
 
 }
 
@@ -10,16 +10,32 @@
 #include <netinet/tcp.h>
 
 #include <ifaddrs.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
 #include <limits>
+#include <algorithm>
 namespace graphlab {
 
 distributed_control *dc_singleton_ptr = NULL;
 
-distributed_control::distributed_control(int *pargc, char*** pargv) {
+distributed_control::distributed_control(int *pargc, char*** pargv) :
+    send_pool(65536, 64), recv_pool(131072, 64) {
   assert(dc_singleton_ptr == NULL);
   msgsent.value = 0;
   msgprocessed.value = 0;
   done = 0;
+  send_pending.value = 0;
+  send_sleeping = false;
+  send_stopping = false;
+  send_flush_bytes = 65536;
+  send_latency_us = 0;
+  messages_sent = 0;
+  send_calls = 0;
+  messages_received.value = 0;
+  epollfd = -1;
+  wakefd = -1;
+  dispatch_pending_bytes.value = 0;
+  max_dispatch_bytes = 256 * 1024 * 1024;
   int provided;
   MPI_Init_thread(pargc, pargv, MPI_THREAD_MULTIPLE, &provided);
   if (provided >= MPI_THREAD_MULTIPLE) {
@@ -35,7 +51,7 @@ distributed_control::distributed_control(int *pargc, char*** pargv) {
 
 
 
-  MPI_Errhandler_set(MPI_COMM_WORLD, MPI_ERRORS_RETURN);
+  MPI_Comm_set_errhandler(MPI_COMM_WORLD, MPI_ERRORS_RETURN);
   // get the number of processes
   int i_nprocs;
   MPI_Comm_size(MPI_COMM_WORLD, &i_nprocs);
@@ -51,6 +67,7 @@ distributed_control::distributed_control(int *pargc, char*** pargv) {
   sync_ip_list();
 
   connect_udt();
+  send_buffers.resize(socks.size());
   send_thread = new background_send_thread(*this);
   send_thread->start();
   dc_singleton_ptr = this;
@@ -72,9 +89,13 @@ distributed_control::~distributed_control() {
 
   mpi_barrier();
   // kill the send thread
-  send_requests.stop_blocking();
-  send_thread->join();
+  stop_sending();
   logstream(LOG_INFO) << "Total Bytes Transmitted: " << send_thread->bytes_sent << std::endl;
+  comm_stats stats = get_comm_stats();
+  logger(LOG_INFO, "%lu messages sent in %lu calls, %lu received in %lu calls",
+         (unsigned long)stats.messages_sent, (unsigned long)stats.send_calls,
+         (unsigned long)stats.messages_received,
+         (unsigned long)stats.receive_calls);
   delete send_thread;
 
   
@@ -86,36 +107,64 @@ distributed_control::~distributed_control() {
   }
   
   delete [] all_addrs;
-  // delete buffers
-  for (size_t i = 0; i <buffer.size(); ++i) {
-    if (buffer[i].buffer != NULL) free(buffer[i].buffer);
-  }
+  // delete the receivers. The dispatch threads have released every
+  // packet so this returns all the slabs to the pool
+  for (size_t i = 0; i < receivers.size(); ++i) delete receivers[i];
   logger(LOG_INFO, "MPI_Finalize");
   MPI_Finalize();
 }
 
 
-void distributed_control::init_message_processing(size_t nummsgthreads) {
+void distributed_control::init_message_processing(size_t nummsgthreads,
+                                                  size_t numiothreads) {
   ASSERT_GT(nummsgthreads, 0);
-  create_receive_buffers(131072);
+  ASSERT_GT(numiothreads, 0);
+  create_receive_buffers();
   // begin message processing threads
   dispatch_thread.resize(nummsgthreads);
   for (size_t i = 0; i < nummsgthreads; ++i) {
     dispatch_thread[i] = new message_dispatch_thread(*this);
     dispatch_thread[i]->start();
   }
-  
-  // begin socket receive threads 
-  size_t numrecvthreads = socks.size() - 1;
+
+  // register the sockets. Each is reported to one receive thread at
+  // a time, which rearms it after reading
+  epollfd = epoll_create(numprocs() + 1);
+  ASSERT_TRUE(epollfd >= 0);
+  for (procid_t i = 0; i < numprocs(); ++i) {
+    if (i == procid()) continue;
+    epoll_event ev;
+    ev.events = EPOLLIN | EPOLLET | EPOLLONESHOT;
+    ev.data.u32 = i;
+    int ret = epoll_ctl(epollfd, EPOLL_CTL_ADD, socks[i], &ev);
+    ASSERT_TRUE(ret == 0);
+  }
+  // wakefd is level triggered so that it stops every receive thread
+  wakefd = eventfd(0, 0);
+  ASSERT_TRUE(wakefd >= 0);
+  epoll_event ev;
+  ev.events = EPOLLIN;
+  ev.data.u32 = numprocs();
+  int ret = epoll_ctl(epollfd, EPOLL_CTL_ADD, wakefd, &ev);
+  ASSERT_TRUE(ret == 0);
+
+  // begin socket receive threads. More threads than sockets would idle
+  size_t numrecvthreads = std::min(numiothreads, 
+                                   std::max(socks.size() - 1, size_t(1)));
+  logger(LOG_INFO, "%lu receive threads for %lu sockets",
+         (unsigned long)numrecvthreads, (unsigned long)(socks.size() - 1));
   procs.resize(numrecvthreads );
   for (size_t i = 0;i < numrecvthreads ; ++i) {
-    procs[i].done = &done;
     procs[i].dc = this;
     procthreads.launch(&(procs[i]));
   }
   mpi_barrier();
 }
 
+void distributed_control::set_dispatch_limit(size_t max_bytes) {
+  max_dispatch_bytes = max_bytes;
+}
+
 void distributed_control::set_socket_options(int fd) {
   int flag = 1;
   int result = setsockopt(fd,            /* socket affected */
@@ -128,8 +177,29 @@ void distributed_control::set_socket_options(int fd) {
   }
 }
 
+distributed_control::comm_stats distributed_control::get_comm_stats() const {
+  comm_stats stats;
+  stats.messages_sent = messages_sent;
+  stats.send_calls = send_calls;
+  stats.bytes_sent = send_thread->bytes_sent;
+  stats.messages_received = messages_received.value;
+  stats.receive_calls = 0;
+  for (size_t i = 0; i < receivers.size(); ++i) {
+    stats.receive_calls += receivers[i]->num_recvcalls();
+  }
+  stats.buffers_reused = send_pool.reused() + recv_pool.reused();
+  stats.buffers_allocated = send_pool.allocated() + recv_pool.allocated();
+  return stats;
+}
+
 void distributed_control::report_stats() {
      distributed_metrics::instance(this)->set_value("total_bytes", (double) send_thread->bytes_sent);
+     comm_stats stats = get_comm_stats();
+     distributed_metrics::instance(this)->set_value("messages_per_send_call",
+        stats.send_calls > 0 ? double(stats.messages_sent) / stats.send_calls : 0.0);
+     distributed_metrics::instance(this)->set_value("messages_per_receive_call",
+        stats.receive_calls > 0 ? 
+          double(stats.messages_received) / stats.receive_calls : 0.0);
      barrier();
      
     if (id == 0) distributed_metrics::instance(this)->report();
@@ -150,6 +220,8 @@ size_t distributed_control::read_tcp_buflen(int fd) {
 void distributed_control::get_local_ip(char ip[4]) {
   // code adapted from
   // http://stackoverflow.com/questions/212528/linux-c-get-the-ip-address-of-local-computer
+  // without another interface all the processes are on this machine
+  ip[0] = 127; ip[1] = 0; ip[2] = 0; ip[3] = 1;
   struct ifaddrs * ifAddrStruct = NULL;
   getifaddrs(&ifAddrStruct);
   struct ifaddrs * firstifaddr = ifAddrStruct;
@@ -253,6 +325,10 @@ void distributed_control::connect_udt() {
 void distributed_control::open_listening_udt() {
   // open listening socket
   listensock = socket(AF_INET, SOCK_STREAM, 0);
+  // so that the port can be reused while the connections of the last
+  // run are in TIME_WAIT
+  int reuse = 1;
+  setsockopt(listensock, SOL_SOCKET, SO_REUSEADDR, (char*)&reuse, sizeof(reuse));
   sockaddr_in my_addr;
   my_addr.sin_family = AF_INET;
   my_addr.sin_port = htons(localport);
@@ -266,7 +342,9 @@ void distributed_control::open_listening_udt() {
   }
   logstream(LOG_INFO) << "Proc " << procid() << " listening on " << localport << "\n";
   if (numprocs() > 1) {
-    ASSERT_EQ(0, listen(listensock, numprocs() - 1));
+    // not inside ASSERT_EQ, which does not evaluate its arguments
+    int ret = listen(listensock, numprocs() - 1);
+    ASSERT_TRUE(ret == 0);
   }
 }
 
@@ -275,15 +353,18 @@ void distributed_control::close_all_connections() {
   logger(LOG_INFO, "Closing sockets");
   done = 1;
   mpi_barrier();
-  // wake all receivers up everyone up;
-  for (procid_t j = 0 ;j < numprocs(); ++j) {
-    if (j != procid()) {
-      char *a = (char*)malloc(16);
-      memset(a, 0, 16);
-      send_to_sock(j, a, 1);
-    }
+  // wake all the receive threads up
+  if (wakefd >= 0) {
+    uint64_t one = 1;
+    ssize_t ret = write(wakefd, &one, sizeof(one));
+    ASSERT_TRUE(ret == sizeof(one));
   }
+  dispatch_space_lock.lock();
+  dispatch_space_cond.broadcast();
+  dispatch_space_lock.unlock();
   procthreads.join();
+  if (epollfd >= 0) close(epollfd);
+  if (wakefd >= 0) close(wakefd);
   mpi_barrier();
   // socket closing order.to avoid TIME_WAITs
   // close initiators first
@@ -305,19 +386,13 @@ void distributed_control::print_stats(procid_t target) {
   // TODO:
 }
 
-void distributed_control::create_receive_buffers(size_t rcvbuflen) {
-  // create the receive buffers
-  buffer.resize(socks.size());
-
-  logger(LOG_INFO, "Allocating buffer of size %d", rcvbuflen);
-  for (size_t i = 0;i < buffer.size(); ++i) {
-    buffer[i].buffer = (char*)(malloc(rcvbuflen));
-    ASSERT_NE(buffer[i].buffer, NULL);
-    buffer[i].buflen = rcvbuflen;
-    buffer[i].buftail = 0;
-    buffer[i].minimum_buflen = rcvbuflen;
-    buffer[i].num_recvcalls = 0;
-    buffer[i].weighted_bufferutilization = 0;
+void distributed_control::create_receive_buffers() {
+  // create the receivers
+  logger(LOG_INFO, "Receiving into slabs of size %lu",
+         (unsigned long)recv_pool.get_block_size());
+  receivers.resize(socks.size());
+  for (size_t i = 0;i < receivers.size(); ++i) {
+    receivers[i] = new dc_slab_receiver(recv_pool);
   }
 }
 
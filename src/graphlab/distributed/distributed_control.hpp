@@ -16,6 +16,8 @@
 #include <graphlab/serialization/iarchive.hpp>
 #include <graphlab/parallel/pthread_tools.hpp>
 #include <graphlab/util/blocking_queue.hpp>
+#include <graphlab/distributed/dc_buffer_pool.hpp>
+#include <graphlab/distributed/dc_recv_slab.hpp>
 
 
 namespace graphlab {
@@ -49,8 +51,13 @@ class distributed_control {
   
   ~distributed_control();
 
-  /// Begins background message processing threads
-  void init_message_processing(size_t numthreads = 1);
+  /**
+   * Begins background message processing. numthreads threads run
+   * the message handlers and numiothreads threads receive from all
+   * the other processes through one epoll set.
+   */
+  void init_message_processing(size_t numthreads = 1,
+                               size_t numiothreads = 1);
   
   inline const procid_t procid() const {
     return id;
@@ -66,6 +73,25 @@ class distributed_control {
     MPI_Barrier(MPI_COMM_WORLD);
   }
 
+  /**
+   * Replaces values by their elementwise sum over all processes.
+   * Must be called by every process with vectors of the same length.
+   */
+  inline void mpi_allreduce_sum(std::vector<size_t>& values) {
+    std::vector<size_t> sums(values.size());
+    MPI_Allreduce(&values[0], &sums[0], int(values.size()),
+                  MPI_UNSIGNED_LONG, MPI_SUM, MPI_COMM_WORLD);
+    values.swap(sums);
+  }
+
+  /** Returns the largest value over all processes. Must be called by all */
+  inline size_t mpi_allreduce_max(size_t value) {
+    size_t result = value;
+    MPI_Allreduce(&value, &result, 1, MPI_UNSIGNED_LONG, MPI_MAX,
+                  MPI_COMM_WORLD);
+    return result;
+  }
+
   void comms_barrier();
 
   inline void barrier() {
@@ -73,6 +99,44 @@ class distributed_control {
   }
   
   void report_stats();
+
+  /**
+   * Messages to a process are appended to a buffer which a background
+   * thread sends with one writev per process.  The thread sends as
+   * soon as it is free, so messages are coalesced while it is busy.
+   * If latency_us is positive it also waits up to latency_us for
+   * more messages after the first one, unless flush_bytes bytes are
+   * already buffered.  The default is (65536, 0).
+   */
+  void set_send_coalescing(size_t flush_bytes, size_t latency_us);
+
+  /**
+   * The receive threads stop reading from the sockets while more than
+   * max_bytes of received messages are waiting for a handler thread,
+   * which leaves the senders to block on TCP flow control. Handlers
+   * which block until another message arrives must not let the queue
+   * reach this limit. The default is 256MB.
+   */
+  void set_dispatch_limit(size_t max_bytes);
+
+  /** Counters of the messaging layer */
+  struct comm_stats {
+    /** Messages sent, including control messages */
+    size_t messages_sent;
+    /** writev calls used to send them */
+    size_t send_calls;
+    size_t bytes_sent;
+    /** Messages received */
+    size_t messages_received;
+    /** recv calls used to receive them */
+    size_t receive_calls;
+    /** Message buffers taken from the pools and newly allocated */
+    size_t buffers_reused;
+    size_t buffers_allocated;
+  };
+
+  /** The counters since construction */
+  comm_stats get_comm_stats() const;
   
   // ----------    Standard Remote Call with integer parameters -------------
 
@@ -232,69 +296,68 @@ class distributed_control {
   template<typename F>
   void remote_callxs(procid_t target, F remote_function, void* ptr, size_t len) {
     //BOOST_STATIC_ASSERT((boost::function_types::is_function<F,  stdcall_cc>::value == true));
-    std::stringstream str;
-    oarchive arc(str);
+    oarchive arc;
     if (target == id) { remote_function(*this, id, ptr, len);  return;}
     typedef typename SER_GET_STRUCT_TYPE0<F>::struct_type struct_type;
     SERREPACKSTRUCT(remote_function, arc);
     xsdispatcher dispptr = (SERDISPATCH0<struct_type>);
-    send_callxs_message(target, (void*)(dispptr), ptr, len, str.str());
+    send_callxs_message(target, (void*)(dispptr), ptr, len, arc.data(),
+                        arc.size());
   }
 
   template<typename F, typename T0>
   void remote_callxs(procid_t target, F remote_function, void* ptr, size_t len, 
                       T0 i0) {
-    std::stringstream str;
-    oarchive arc(str);
+    oarchive arc;
     if (target == id) { remote_function(*this, id, ptr, len, i0);  return;}
     typedef typename SER_GET_STRUCT_TYPE1<F>::struct_type struct_type;
     SERREPACKSTRUCT(remote_function, arc, i0);
     xsdispatcher dispptr = (SERDISPATCH1<struct_type>);
-    send_callxs_message(target, (void*)(dispptr), ptr, len, str.str());
+    send_callxs_message(target, (void*)(dispptr), ptr, len, arc.data(),
+                        arc.size());
   }
 
   template<typename F, typename T0, typename  T1>
   void remote_callxs(procid_t target, F remote_function, void* ptr, size_t len, 
                       T0 i0, T1 i1) {
-    std::stringstream str;
-    oarchive arc(str);
+    oarchive arc;
     if (target == id) { remote_function(*this, id, ptr, len, i0, i1);  return;}
     typedef typename SER_GET_STRUCT_TYPE2<F>::struct_type struct_type;
     SERREPACKSTRUCT(remote_function, arc, i0, i1);
     xsdispatcher dispptr = (SERDISPATCH2<struct_type>);
-    send_callxs_message(target, (void*)(dispptr), ptr, len, str.str());
+    send_callxs_message(target, (void*)(dispptr), ptr, len, arc.data(),
+                        arc.size());
   }
 
   template<typename F, typename T0, typename T1, typename T2>
   void remote_callxs(procid_t target, F remote_function, void* ptr, size_t len, 
                       T0 i0, T1 i1, T2 i2) {
-    std::stringstream str;
-    oarchive arc(str);
+    oarchive arc;
     if (target == id) { remote_function(*this, id, ptr, len, i0, i1, i2);  return;}
     typedef typename SER_GET_STRUCT_TYPE3<F>::struct_type struct_type;
     SERREPACKSTRUCT(remote_function, arc, i0, i1, i2);
     xsdispatcher dispptr = (SERDISPATCH3<struct_type>);
-    send_callxs_message(target, (void*)(dispptr), ptr, len, str.str());
+    send_callxs_message(target, (void*)(dispptr), ptr, len, arc.data(),
+                        arc.size());
   }
 
   template<typename F, typename T0, typename T1, typename T2, typename T3>
   void remote_callxs(procid_t target, F remote_function, void* ptr, size_t len, 
                       T0 i0, T1 i1, T2 i2, T3 i3) {
-    std::stringstream str;
-    oarchive arc(str);
+    oarchive arc;
     if (target == id) { remote_function(*this, id, ptr, len, i0, i1, i2, i3);  return;}
     typedef typename SER_GET_STRUCT_TYPE4<F>::struct_type struct_type;
     SERREPACKSTRUCT(remote_function, arc, i0, i1, i2, i3);
     xsdispatcher dispptr = (SERDISPATCH4<struct_type>);
-    send_callxs_message(target, (void*)(dispptr), ptr, len, str.str());
+    send_callxs_message(target, (void*)(dispptr), ptr, len, arc.data(),
+                        arc.size());
   }
 
   template<typename F, typename T0, typename T1, typename T2, typename T3, 
                       typename T4>
   void remote_callxs(procid_t target, F remote_function, void* ptr, size_t len, 
                       T0 i0, T1 i1, T2 i2, T3 i3, T4 i4) {
-    std::stringstream str;
-    oarchive arc(str);
+    oarchive arc;
     if (target == id) {
       remote_function(*this, id, ptr, len, i0, i1, i2, i3, i4);
       return;
@@ -302,15 +365,15 @@ class distributed_control {
     typedef typename SER_GET_STRUCT_TYPE5<F>::struct_type struct_type;
     SERREPACKSTRUCT(remote_function, arc, i0, i1, i2, i3, i4);
     xsdispatcher dispptr = (SERDISPATCH5<struct_type>);
-    send_callxs_message(target, (void*)(dispptr), ptr, len, str.str());
+    send_callxs_message(target, (void*)(dispptr), ptr, len, arc.data(),
+                        arc.size());
   }
 
   template<typename F, typename T0, typename T1, typename T2, typename T3, 
                       typename T4, typename T5>
   void remote_callxs(procid_t target, F remote_function, void* ptr, size_t len, 
                       T0 i0, T1 i1, T2 i2, T3 i3, T4 i4, T5 i5) {
-    std::stringstream str;
-    oarchive arc(str);
+    oarchive arc;
     if (target == id) {
       remote_function(*this, id, ptr, len, i0, i1, i2, i3, i4, i5);
       return;
@@ -318,7 +381,8 @@ class distributed_control {
     typedef typename SER_GET_STRUCT_TYPE6<F>::struct_type struct_type;
     SERREPACKSTRUCT(remote_function, arc, i0, i1, i2, i3, i4, i5);
     xsdispatcher dispptr = (SERDISPATCH6<struct_type>);
-    send_callxs_message(target, (void*)(dispptr), ptr, len, str.str());
+    send_callxs_message(target, (void*)(dispptr), ptr, len, arc.data(),
+                        arc.size());
   }
 
 
@@ -398,20 +462,12 @@ class distributed_control {
     send_call_control_message(target, (void*)(dispptr), ptr, len, &ps, sizeof(ps));
   }
 
-  struct recv_buffer{
-    char* buffer;
-    size_t buflen;
-    size_t buftail;
-    size_t minimum_buflen;
-    
-    size_t num_recvcalls;
-    size_t weighted_bufferutilization;
-  };
-  std::vector<recv_buffer> buffer;
+  /// receivers[i] parses the packets from machine i
+  std::vector<dc_slab_receiver*> receivers;
 
+  /** Serves the sockets which are ready in the epoll set */
   class messageproc_thread :public runnable {
   public:
-    size_t* done;
     distributed_control *dc;
     
     // constructor /destructors
@@ -423,17 +479,28 @@ class distributed_control {
 
   void print_stats(procid_t target);
 
-  
-  struct send_req_data{
-    send_req_data() {}
-    send_req_data(procid_t target, char* buf, size_t len):
-                            target(target), buf(buf), len(len) { }
-    procid_t target;
+  /** A block of packets (each preceded by its length) to one process */
+  struct send_block {
+    send_block() { }
+    send_block(char* buf, size_t len, size_t capacity):
+                            buf(buf), len(len), capacity(capacity) { }
     char* buf;
     size_t len;
+    size_t capacity;
+  };
+
+  /** The packets waiting to be sent to one process */
+  struct send_buffer {
+    send_buffer() : nmessages(0), nbytes(0) { }
+    spinlock lock;
+    /** Full blocks followed by the block being filled */
+    std::vector<send_block> blocks;
+    /** The blocks being sent by the send thread */
+    std::vector<send_block> sending;
+    size_t nmessages;
+    size_t nbytes;
   };
 
-  
   class background_send_thread:public thread {
     distributed_control &dc;
    public: 
@@ -441,18 +508,15 @@ class distributed_control {
     background_send_thread(distributed_control &dc):dc(dc),bytes_sent(0) { }
     void run() {
       logger(LOG_INFO, "send thread started");
-      while(1) {
-        std::pair<send_req_data, bool> ret = dc.send_requests.dequeue();
-        if (ret.second == false) break;
-        bytes_sent+=ret.first.len;
-        dc.send_to_sock(ret.first.target, ret.first.buf, ret.first.len);
-      }
+      dc.send_loop();
     }
   };
   
+  /** A packet inside a receive slab, to which it holds a reference */
   struct dispatch_req_data{
     char* buf;
     size_t len;
+    dc_recv_slab* slab;
   };
 
   class message_dispatch_thread:public thread {
@@ -490,11 +554,34 @@ class distributed_control {
    
   // background sending
   background_send_thread *send_thread;
-  blocking_queue<send_req_data> send_requests;
+  std::vector<send_buffer> send_buffers;
+  dc_buffer_pool send_pool;
+  /// messages buffered and not yet taken by the send thread
+  atomic<size_t> send_pending;
+  /// wakes the send thread
+  mutex send_wake_lock;
+  conditional send_wake_cond;
+  volatile bool send_sleeping;
+  bool send_stopping;
+  size_t send_flush_bytes;
+  size_t send_latency_us;
+  size_t messages_sent;
+  size_t send_calls;
   
   // background receiving
   std::vector<message_dispatch_thread*> dispatch_thread;
   blocking_queue<dispatch_req_data> dispatch_requests;
+  /// the slabs packets are received into
+  dc_buffer_pool recv_pool;
+  atomic<size_t> messages_received;
+  /// the peer sockets and wakefd, which is readable once done is set
+  int epollfd;
+  int wakefd;
+  /// bytes queued in dispatch_requests and the limit on them
+  atomic<size_t> dispatch_pending_bytes;
+  size_t max_dispatch_bytes;
+  mutex dispatch_space_lock;
+  conditional dispatch_space_cond;
 
   atomic<size_t> msgsent;
   atomic<size_t> msgprocessed;
@@ -512,11 +599,26 @@ class distributed_control {
   void open_listening_udt();
   /// Closes all UDT connections
   void close_all_connections();
-  void create_receive_buffers(size_t rcvbuflen);
+  void create_receive_buffers();
   
-  void send_to_sock(procid_t sock, char* buf, size_t len);
+  /** Returns where to write a packet of packlength bytes to target */
+  char* begin_send(procid_t target, size_t packlength);
+  /** Completes the packet started by begin_send */
+  void end_send(procid_t target);
+  /** The loop of the send thread */
+  void send_loop();
+  /** Sends everything buffered for target. Called by the send thread */
+  void flush_send_buffer(procid_t target);
+  /** Stops the send thread after sending everything buffered */
+  void stop_sending();
   // receive functions
-  void receive_handler(sockfd_t sock, recv_buffer &buffer);
+  struct dispatch_enqueuer;
+  /** Run by the receive threads until done is set */
+  void receive_loop();
+  /** Reads what has arrived from a process. Returns false once done */
+  bool receive_from(procid_t source, dispatch_enqueuer& dispatch);
+  /** Waits while dispatch_requests holds more than max_dispatch_bytes */
+  void wait_for_dispatch_space();
   void receive_call_message(char* msg, size_t len);
   void receive_callx_message(char* msg, size_t len);
   void receive_callxs_message(char* msg, size_t len);
@@ -526,7 +628,7 @@ class distributed_control {
   void send_callx_message(procid_t target, void* remote_function, void* ptr, 
                       size_t len,void* stackbegin, size_t stacklen);
   void send_callxs_message(procid_t target, void* remote_function, void* ptr, 
-                      size_t len,const std::string &s);
+                      size_t len,const char* stack, size_t stacklen);
   // control messages are the same as callx messages but they do not count
   // towards the message counter
   void send_call_control_message(procid_t target, void* remote_function, void* ptr,
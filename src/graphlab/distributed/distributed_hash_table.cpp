@@ -171,8 +171,111 @@ void int_any_map_get_handler(distributed_control& dc,
   }
 }
 
+/// The values a process returns for its part of a multi_get
+template <typename ValueType>
+struct dht_multi_get_reply {
+  /// where the keys sent to the process are in the request
+  std::vector<size_t> positions;
+  /// whether each key was found
+  std::vector<unsigned char> found;
+  /// the values of the keys which were found, in order
+  std::vector<ValueType> values;
+  size_t done;
+};
+
+/// The any values are cached on the process setting or reading them
+static inline bool dht_values_cached(const std::vector<any>&) { return true; }
+static inline bool dht_values_cached(const std::vector<uint64_t>&) { return false; }
+
+
+/// Batched cache update. Sent by the process storing a batch of keys
+void dht_multi_cache_write_handler(distributed_control& dc,
+                                   procid_t source,
+                                   void* ptr,    //serialized keys, values
+                                   size_t len,
+                                   handlerarg_t mapid) {
+  iarchive iarc((const char*)ptr, len);
+  std::vector<size_t> keys;
+  std::vector<any> values;
+  iarc >> keys >> values;
+  for (size_t i = 0; i < keys.size(); ++i) {
+    allmaps[mapid]->update_cache(keys[i], values[i]);
+  }
+}
+
+
+/// Batched set handler. Stores each key/value pair of the batch
+template <typename ValueType>
+void dht_multi_set_handler(distributed_control& dc,
+                           procid_t source,
+                           void* ptr,    //serialized keys, values
+                           size_t len,
+                           handlerarg_t mapid,
+                           handlerarg_t setreplyreqid) {
+  distributed_hash_table* dht = allmaps[mapid];
+  iarchive iarc((const char*)ptr, len);
+  std::vector<size_t> keys;
+  std::vector<ValueType> values;
+  iarc >> keys >> values;
+  for (size_t i = 0; i < keys.size(); ++i) dht->store(keys[i], values[i]);
+  // the batch goes on to the other caches as is
+  if (dht_values_cached(values) && dht->pushed_updates) {
+    for (procid_t i = 0;i < dc.numprocs(); ++i) {
+      if (i != source && i != dc.procid()) {
+        dc.remote_call(i, dht_multi_cache_write_handler, ptr, len, mapid);
+      }
+    }
+  }
+  dc.remote_call(source, set_ptr_to_value_1_handler, NULL, 0, setreplyreqid);
+}
+
+
+/// Response to a batched get request
+template <typename ValueType>
+void dht_multi_get_reply_handler(distributed_control& dc,
+                                 procid_t source,
+                                 void* ptr,    //serialized found, values
+                                 size_t len,
+                                 handlerarg_t reqid) {
+  dht_multi_get_reply<ValueType>* reply =
+    reinterpret_cast<dht_multi_get_reply<ValueType>*>(reqid);
+  iarchive iarc((const char*)ptr, len);
+  iarc >> reply->found >> reply->values;
+  __sync_synchronize();
+  *reinterpret_cast<volatile size_t*>(&reply->done) = 1;
+}
+
+
+/// Batched get handler. Replies with the values of the keys found
+template <typename ValueType>
+void dht_multi_get_handler(distributed_control& dc,
+                           procid_t source,
+                           void* ptr,    //serialized keys
+                           size_t len,
+                           handlerarg_t mapid,
+                           handlerarg_t reqid) {
+  distributed_hash_table* dht = allmaps[mapid];
+  iarchive iarc((const char*)ptr, len);
+  std::vector<size_t> keys;
+  iarc >> keys;
+  std::vector<unsigned char> found(keys.size(), 0);
+  std::vector<ValueType> values;
+  ValueType value;
+  for (size_t i = 0; i < keys.size(); ++i) {
+    if (dht->lookup(keys[i], value)) {
+      found[i] = 1;
+      values.push_back(value);
+    }
+  }
+  oarchive oarc;
+  oarc << found << values;
+  dc.remote_call(source, dht_multi_get_reply_handler<ValueType>,
+                 (void*)oarc.data(), oarc.size(), reqid);
+}
+
+
 distributed_hash_table::distributed_hash_table(distributed_control &dc,
-                                   size_t max_cache_size):dc(dc),data(11) {
+                                   size_t max_cache_size):dc(dc),data(11),words(11) {
   numprocs = dc.numprocs();
   pushed_updates = true;
   allmaps.push_back(this);
@@ -180,13 +283,13 @@ distributed_hash_table::distributed_hash_table(distributed_control &dc,
   mapid = allmaps.size() - 1;
   // create the cache. Make sure it has room so we don't need to resize
   // too much
-  cache.rehash(max_cache_size);
-  maxcache = max_cache_size;
+  maxcache = std::max(max_cache_size / CACHE_SHARDS, size_t(1));
+  for (size_t i = 0; i < CACHE_SHARDS; ++i) {
+    cacheshards[i].cache.rehash(maxcache);
+  }
   //if (dc.procid() == 0) {
-    logger(LOG_INFO, "%d Creating distributed_hash_table %d. Cache Limit = %d", dc.procid(), mapid, maxcache);
+    logger(LOG_INFO, "%d Creating distributed_hash_table %d. Cache Limit = %d", dc.procid(), mapid, maxcache * CACHE_SHARDS);
   //}
-  reqs = 0;
-  misses = 0;
 }
 
 
@@ -199,12 +302,15 @@ void distributed_hash_table::set(size_t key, const any &value) {
   procid_t nodeid = key_node_hash(key);
   // Run the request
   volatile size_t trigger = 0;
+  timer ti;
+  ti.start();
   dc.remote_call(nodeid, int_any_map_set_handler, 
                  (void*)(str.str().c_str()), str.str().length(), mapid, key, 0,
                  reinterpret_cast<handlerarg_t>(&trigger));
   while(trigger == 0) {
     sched_yield();
   }
+  record_round_trip(ti);
   // update the cache entry locally
   update_cache(key,value);
 }
@@ -224,6 +330,8 @@ void distributed_hash_table::exchange(size_t key,
   // figure out which node to store it
   procid_t nodeid = key_node_hash(key);
   // Run the request
+  timer ti;
+  ti.start();
   dc.remote_call(nodeid, int_any_map_set_handler, 
                  (void*)(str.str().c_str()), str.str().length(), mapid, key, (size_t)(&mapreply), 0);
   // update the cache entry locally
@@ -233,6 +341,7 @@ void distributed_hash_table::exchange(size_t key,
   while(!(*b)) {
     sched_yield();
   }
+  record_round_trip(ti);
   oldvalue.swap(mapreply.reply_value);  
 }
 
@@ -242,11 +351,14 @@ bool distributed_hash_table::get(size_t key, any &value) {
   // figure out which node is supposed to own it
   procid_t nodeid = key_node_hash(key);
   // send the request
+  timer ti;
+  ti.start();
   dc.remote_call(nodeid, int_any_map_get_handler, NULL, 0, mapid, key, (size_t)(&mapreply));
   volatile bool* b = &(mapreply.reply_set);
   while(!(*b)) {
     sched_yield();
   }
+  record_round_trip(ti);
 
   if (mapreply.reply_found) {
     // we got a value
@@ -263,88 +375,246 @@ bool distributed_hash_table::get(size_t key, any &value) {
   }
 }
 
+template <typename ValueType>
+void distributed_hash_table::multi_set_impl(const std::vector<size_t> &keys,
+                                            const std::vector<ValueType> &values) {
+  ASSERT_TRUE(keys.size() == values.size());
+  // split the batch by the process storing each key
+  std::vector<std::vector<size_t> > prockeys(numprocs);
+  std::vector<std::vector<ValueType> > procvalues(numprocs);
+  for (size_t i = 0; i < keys.size(); ++i) {
+    procid_t nodeid = key_node_hash(keys[i]);
+    prockeys[nodeid].push_back(keys[i]);
+    procvalues[nodeid].push_back(values[i]);
+  }
+  std::vector<size_t> triggers(numprocs, 0);
+  timer ti;
+  ti.start();
+  for (procid_t i = 0; i < numprocs; ++i) {
+    if (prockeys[i].empty()) continue;
+    oarchive oarc;
+    oarc << prockeys[i] << procvalues[i];
+    dc.remote_call(i, dht_multi_set_handler<ValueType>,
+                   (void*)oarc.data(), oarc.size(), mapid,
+                   reinterpret_cast<handlerarg_t>(&triggers[i]));
+  }
+  for (procid_t i = 0; i < numprocs; ++i) {
+    if (prockeys[i].empty()) continue;
+    while(*reinterpret_cast<volatile size_t*>(&triggers[i]) == 0) {
+      sched_yield();
+    }
+  }
+  record_round_trip(ti);
+}
+
+template <typename ValueType>
+size_t distributed_hash_table::multi_get_impl(const std::vector<size_t> &keys,
+                                              std::vector<ValueType> &values,
+                                              std::vector<bool> &found) {
+  std::vector<std::vector<size_t> > prockeys(numprocs);
+  std::vector<dht_multi_get_reply<ValueType> > replies(numprocs);
+  for (size_t i = 0; i < keys.size(); ++i) {
+    procid_t nodeid = key_node_hash(keys[i]);
+    prockeys[nodeid].push_back(keys[i]);
+    replies[nodeid].positions.push_back(i);
+  }
+  timer ti;
+  ti.start();
+  for (procid_t i = 0; i < numprocs; ++i) {
+    replies[i].done = 0;
+    if (prockeys[i].empty()) continue;
+    oarchive oarc;
+    oarc << prockeys[i];
+    dc.remote_call(i, dht_multi_get_handler<ValueType>,
+                   (void*)oarc.data(), oarc.size(), mapid,
+                   reinterpret_cast<handlerarg_t>(&replies[i]));
+  }
+  for (procid_t i = 0; i < numprocs; ++i) {
+    if (prockeys[i].empty()) continue;
+    while(*reinterpret_cast<volatile size_t*>(&replies[i].done) == 0) {
+      sched_yield();
+    }
+  }
+  record_round_trip(ti);
+  // put the values back in the order of the keys
+  values.resize(keys.size());
+  found.assign(keys.size(), false);
+  size_t numfound = 0;
+  for (procid_t i = 0; i < numprocs; ++i) {
+    const dht_multi_get_reply<ValueType> &reply = replies[i];
+    size_t nextvalue = 0;
+    for (size_t j = 0; j < reply.positions.size(); ++j) {
+      if (reply.found[j]) {
+        values[reply.positions[j]] = reply.values[nextvalue++];
+        found[reply.positions[j]] = true;
+        ++numfound;
+      }
+    }
+  }
+  return numfound;
+}
+
+void distributed_hash_table::multi_set(const std::vector<size_t> &keys,
+                                       const std::vector<any> &values) {
+  multi_set_impl(keys, values);
+  // update the cache entries locally
+  for (size_t i = 0; i < keys.size(); ++i) update_cache(keys[i], values[i]);
+}
+
+size_t distributed_hash_table::multi_get(const std::vector<size_t> &keys,
+                                         std::vector<any> &values,
+                                         std::vector<bool> &found) {
+  size_t numfound = multi_get_impl(keys, values, found);
+  for (size_t i = 0; i < keys.size(); ++i) {
+    if (found[i]) update_cache(keys[i], values[i]);
+    else invalidate(keys[i]);
+  }
+  return numfound;
+}
+
+void distributed_hash_table::multi_set_words(const std::vector<size_t> &keys,
+                                             const std::vector<uint64_t> &values) {
+  multi_set_impl(keys, values);
+}
+
+size_t distributed_hash_table::multi_get_words(const std::vector<size_t> &keys,
+                                               std::vector<uint64_t> &values,
+                                               std::vector<bool> &found) {
+  return multi_get_impl(keys, values, found);
+}
+
+void distributed_hash_table::store(size_t key, const any &value) {
+  std::pair<bool, std::pair<rwlock, any>*> ret =
+    data.insert_with_failure_detect(key, std::make_pair(rwlock(), value));
+  if (ret.first == false) {
+    // we have this key. Switch to the fine grain lock.
+    ret.second->first.writelock();
+    ret.second->second = value;
+    ret.second->first.unlock();
+  }
+}
+
+void distributed_hash_table::store(size_t key, uint64_t value) {
+  std::pair<bool, uint64_t*> ret = words.insert_with_failure_detect(key, value);
+  // aligned words are written and read whole
+  if (ret.first == false) *reinterpret_cast<volatile uint64_t*>(ret.second) = value;
+}
+
+bool distributed_hash_table::lookup(size_t key, any &value) {
+  map_type::datapointer iter = data.find(key);
+  if (iter.first == false) return false;
+  iter.second->first.readlock();
+  value = iter.second->second;
+  iter.second->first.unlock();
+  return true;
+}
+
+bool distributed_hash_table::lookup(size_t key, uint64_t &value) {
+  word_map_type::datapointer iter = words.find(key);
+  if (iter.first == false) return false;
+  value = *reinterpret_cast<volatile uint64_t*>(iter.second);
+  return true;
+}
+
 bool distributed_hash_table::get_cached(size_t key, any &value) {
-  reqs++;
-  cachelock.lock();
+  reqs.inc();
+  cache_shard &shard = shard_of(key);
+  shard.lock.lock();
   // check if it is in the cache
-  cache_type::iterator i = cache.find(key);
-  if (i == cache.end()) {
+  cache_type::iterator i = shard.cache.find(key);
+  if (i == shard.cache.end()) {
     // nope. not in cache. Call the regular get
-    cachelock.unlock();
-    misses++;
+    shard.lock.unlock();
+    misses.inc();
     return get(key, value);
   }
   else {
     // yup. in cache. return the value
     value = i->second->value;
-    cachelock.unlock();
+    shard.lock.unlock();
     return true;
   }
 }
 void distributed_hash_table::invalidate(size_t key) {
-  cachelock.lock();
+  cache_shard &shard = shard_of(key);
+  shard.lock.lock();
   // is the key I am invalidating in the cache?
-  cache_type::iterator i = cache.find(key);
-  if (i != cache.end()) {
+  cache_type::iterator i = shard.cache.find(key);
+  if (i != shard.cache.end()) {
     // drop it from the lru list
     delete i->second;
-    cache.erase(i);
+    shard.cache.erase(i);
   }
-  cachelock.unlock();
+  shard.lock.unlock();
 }
 
 void distributed_hash_table::update_cache(size_t key, const any& val) {
-  cachelock.lock();
-  cache_type::iterator i = cache.find(key);
+  cache_shard &shard = shard_of(key);
+  shard.lock.lock();
+  cache_type::iterator i = shard.cache.find(key);
   // create a new entry
-  if (i == cache.end()) {
-    cachelock.unlock();
+  if (i == shard.cache.end()) {
     // if we are out of room, remove the lru entry
-    if (cache.size() >= maxcache) remove_lru();
-    cachelock.lock();
+    if (shard.cache.size() >= maxcache) remove_lru(shard);
     // insert the element, remember the iterator so we can push it
     // straight to the LRU list
-    std::pair<cache_type::iterator, bool> ret = cache.insert(std::make_pair(key, new any_lru_list(key, val)));
-    if (ret.second)  lruage.push_front(*(ret.first->second));
+    std::pair<cache_type::iterator, bool> ret = shard.cache.insert(std::make_pair(key, new any_lru_list(key, val)));
+    if (ret.second)  shard.lruage.push_front(*(ret.first->second));
   }
   else {
       // modify entry in place
       i->second->value = val;
       // swap to front of list
-      //boost::swap_nodes(lru_list_type::s_iterator_to(i->second), lruage.begin());
-      lruage.erase(lru_list_type::s_iterator_to(*(i->second)));
-      lruage.push_front(*(i->second));
+      shard.lruage.erase(lru_list_type::s_iterator_to(*(i->second)));
+      shard.lruage.push_front(*(i->second));
   }
-  cachelock.unlock();
+  shard.lock.unlock();
 }
 
-void distributed_hash_table::remove_lru() {
-  cachelock.lock();
-  size_t keytoerase = lruage.back().key;
+void distributed_hash_table::remove_lru(cache_shard &shard) {
+  if (shard.lruage.empty()) return;
+  size_t keytoerase = shard.lruage.back().key;
   // is the key I am invalidating in the cache?
-  cache_type::iterator i = cache.find(keytoerase);
-  if (i != cache.end()) {
+  cache_type::iterator i = shard.cache.find(keytoerase);
+  if (i != shard.cache.end()) {
     // drop it from the lru list
     delete i->second;
-    cache.erase(i);
+    shard.cache.erase(i);
   }
-  cachelock.unlock();
 }
 
 double distributed_hash_table::cache_miss_rate() {
-  if (reqs == 0.0) return 0;
-  return double(misses) / double(reqs);
+  if (reqs.value == 0) return 0;
+  return double(misses.value) / double(reqs.value);
+}
+
+size_t distributed_hash_table::cache_size() const {
+  size_t ret = 0;
+  for (size_t i = 0; i < CACHE_SHARDS; ++i) ret += cacheshards[i].cache.size();
+  return ret;
+}
+
+void distributed_hash_table::print_stats() {
+  logger(LOG_INFO, "%d distributed_hash_table %d: %lu cached gets, %lu misses "
+         "(%f miss rate), %lu round trips, %f ms mean latency",
+         dc.procid(), mapid, (unsigned long)num_gets(),
+         (unsigned long)num_misses(), cache_miss_rate(),
+         (unsigned long)num_round_trips(),
+         mean_round_trip_latency() * 1000);
 }
 
 
 
 distributed_hash_table::~distributed_hash_table() {
   data.clear();
-  cache_type::iterator i = cache.begin();
-  while (i != cache.end()) {
-    delete i->second;
-    ++i;
+  words.clear();
+  for (size_t s = 0; s < CACHE_SHARDS; ++s) {
+    cache_type::iterator i = cacheshards[s].cache.begin();
+    while (i != cacheshards[s].cache.end()) {
+      delete i->second;
+      ++i;
+    }
+    cacheshards[s].cache.clear();
   }
-  cache.clear();
 }
 }
@@ -7,15 +7,21 @@
 
 #ifndef DISTRIBUTED_HASH_TABLE_HPP
 #define DISTRIBUTED_HASH_TABLE_HPP
+#include <vector>
+#include <cstring>
 #include <boost/unordered_map.hpp>
 #include <boost/intrusive/list.hpp>
+#include <boost/static_assert.hpp>
+#include <boost/type_traits/is_pod.hpp>
 
 #include <graphlab/distributed/distributed_control.hpp>
 #include <graphlab/distributed/distributed_control.hpp>
 #include <graphlab/util/generics/any.hpp>
 #include <graphlab/parallel/pthread_tools.hpp>
+#include <graphlab/parallel/atomic.hpp>
 #include <graphlab/util/synchronized_unordered_map.hpp>
 #include <graphlab/util/dense_bitset.hpp>
+#include <graphlab/util/timer.hpp>
 
 namespace graphlab {
 
@@ -39,7 +45,22 @@ class any_lru_list{
 };
 
 /**
-This implements a distributed size_t => size_t map with caching capabilities
+This implements a distributed size_t => size_t map with caching capabilities.
+
+Key k is stored on process k % numprocs. get(), set() and exchange()
+are one synchronous round trip each. multi_get() and multi_set() send
+all the keys stored on a process in one message and wait for the
+replies of all the processes together, so a batch of keys costs one
+round trip rather than one per key.
+
+Values are stored as any. POD values of up to 8 bytes can instead be
+stored with set_pod(), get_pod(), multi_set_pod() and multi_get_pod(),
+which keep them as plain words, without the allocation and type
+registry of any. These are a separate set of keys which is not cached.
+
+The cache of the values read and written by this process is split
+into CACHE_SHARDS least recently used caches with a lock each, so
+concurrent readers of different keys rarely contend.
 */
 class distributed_hash_table{
  public:
@@ -57,7 +78,7 @@ class distributed_hash_table{
   typedef boost::intrusive::list<any_lru_list, MemberOption, boost::intrusive::constant_time_size<false> > lru_list_type;
 
   /// Constructor. Creates the integer map.
-  distributed_hash_table(distributed_control &dc, size_t max_cache_size = 1024);
+  distributed_hash_table(distributed_control &dc, size_t max_cache_size = 65536);
 
   void set_pushed_updates(bool _pushed_updates) {
     pushed_updates = _pushed_updates;
@@ -105,54 +126,184 @@ class distributed_hash_table{
     exchange(key, newval, oldval);
   }
 
+  /**
+   * Sets keys[i] to values[i] for every i, in one message to each
+   * process storing some of the keys. Returns once all are set.
+   */
+  void multi_set(const std::vector<size_t> &keys,
+                 const std::vector<any> &values);
+
+  /**
+   * Gets the values of the keys in one message to each process
+   * storing some of them. found[i] is true if keys[i] has a value, in
+   * which case it is in values[i]. Returns the number of keys found.
+   */
+  size_t multi_get(const std::vector<size_t> &keys,
+                   std::vector<any> &values,
+                   std::vector<bool> &found);
+
+  /// Sets the POD value of the key
+  template <typename T>
+  void set_pod(size_t key, const T &value) {
+    multi_set_pod(std::vector<size_t>(1, key), std::vector<T>(1, value));
+  }
+
+  /// Gets the POD value of the key. Returns true on success
+  template <typename T>
+  bool get_pod(size_t key, T &value) {
+    std::vector<T> values;
+    std::vector<bool> found;
+    multi_get_pod(std::vector<size_t>(1, key), values, found);
+    if (found[0]) value = values[0];
+    return found[0];
+  }
+
+  /// multi_set() for POD values
+  template <typename T>
+  void multi_set_pod(const std::vector<size_t> &keys,
+                     const std::vector<T> &values) {
+    BOOST_STATIC_ASSERT(boost::is_pod<T>::value &&
+                        sizeof(T) <= sizeof(uint64_t));
+    std::vector<uint64_t> words(values.size(), 0);
+    for (size_t i = 0; i < values.size(); ++i) {
+      memcpy(&words[i], &values[i], sizeof(T));
+    }
+    multi_set_words(keys, words);
+  }
+
+  /// multi_get() for POD values
+  template <typename T>
+  size_t multi_get_pod(const std::vector<size_t> &keys,
+                       std::vector<T> &values,
+                       std::vector<bool> &found) {
+    BOOST_STATIC_ASSERT(boost::is_pod<T>::value &&
+                        sizeof(T) <= sizeof(uint64_t));
+    std::vector<uint64_t> words;
+    size_t ret = multi_get_words(keys, words, found);
+    values.resize(keys.size());
+    for (size_t i = 0; i < keys.size(); ++i) {
+      memcpy(&values[i], &words[i], sizeof(T));
+    }
+    return ret;
+  }
+
   /// Invalidates the cache entry associated with this key
   void invalidate(size_t key);
 
   double cache_miss_rate();
 
   size_t num_gets() const {
-    return reqs;
+    return reqs.value;
   }
   size_t num_misses() const {
-    return misses;
+    return misses.value;
+  }
+  size_t num_hits() const {
+    return reqs.value - misses.value;
   }
 
-  size_t cache_size() const {
-    return cache.size();
+  size_t cache_size() const;
+
+  /**
+   * The number of synchronous requests made by this process. A
+   * multi_get() or multi_set() counts once.
+   */
+  size_t num_round_trips() const {
+    return roundtrips.value;
+  }
+
+  /// The mean time in seconds this process waited on a request
+  double mean_round_trip_latency() const {
+    if (roundtrips.value == 0) return 0;
+    return double(roundtrip_usecs.value) / 1.0E6 / double(roundtrips.value);
   }
 
+  /// Logs the cache and round trip statistics
+  void print_stats();
+
   struct mapreplydata{
     bool reply_set;
     bool reply_found;
     any reply_value;
   };
 
+  /// Number of independently locked parts of the cache
+  static const size_t CACHE_SHARDS = 16;
+
  private:
 
+  /// One of the independently locked parts of the cache
+  struct cache_shard {
+    spinlock lock;     /// lock for the cache datastructures of the shard
+    cache_type cache;   /// The cache table
+    lru_list_type lruage; /// THe LRU linked list associated with the cache
+    char padding[64];
+  };
+
+  /// datatype of the map of the POD values
+  typedef synchronized_unordered_map<uint64_t> word_map_type;
+
   distributed_control &dc;
   map_type data;  /// The actual table data that is distributed
+  word_map_type words;  /// The POD values stored on this process
 
-  
-  spinlock cachelock; /// lock for the cache datastructures
-  cache_type cache;   /// The cache table
-  lru_list_type lruage; /// THe LRU linked list associated with the cache
-
+  cache_shard cacheshards[CACHE_SHARDS];
 
   procid_t numprocs;   /// NUmber of processors
-  size_t maxcache;     /// Maximum cache size allowed
+  size_t maxcache;     /// Maximum cache size allowed per shard
 
   size_t mapid;
 
   bool pushed_updates;
 
+  /// The shard caching the key
+  cache_shard& shard_of(size_t key) {
+    // the keys cached are mostly those stored elsewhere, which share
+    // residues mod numprocs, so mix the bits before picking the shard
+    return cacheshards[(uint64_t(key) * 0x9E3779B97F4A7C15ULL) >> 60];
+  }
+
   /// Updates the cache with this new value
   void update_cache(size_t key, const any &val);
 
-  /// Removes the least recently used element from the cache
-  void remove_lru();
+  /// Removes the least recently used element from the shard. Called
+  /// with the lock of the shard held.
+  void remove_lru(cache_shard& shard);
 
-  size_t reqs;
-  size_t misses;
+  /// Records a request which was started when ti was started
+  void record_round_trip(const timer& ti) {
+    roundtrips.inc();
+    roundtrip_usecs.inc(size_t(ti.current_time() * 1.0E6));
+  }
+
+  void multi_set_words(const std::vector<size_t> &keys,
+                       const std::vector<uint64_t> &values);
+
+  size_t multi_get_words(const std::vector<size_t> &keys,
+                         std::vector<uint64_t> &values,
+                         std::vector<bool> &found);
+
+  template <typename ValueType>
+  void multi_set_impl(const std::vector<size_t> &keys,
+                      const std::vector<ValueType> &values);
+
+  template <typename ValueType>
+  size_t multi_get_impl(const std::vector<size_t> &keys,
+                        std::vector<ValueType> &values,
+                        std::vector<bool> &found);
+
+  /// Stores a value received in a batch on this process
+  void store(size_t key, const any &value);
+  void store(size_t key, uint64_t value);
+
+  /// Reads a value stored on this process. Returns false if missing
+  bool lookup(size_t key, any &value);
+  bool lookup(size_t key, uint64_t &value);
+
+  atomic<size_t> reqs;
+  atomic<size_t> misses;
+  atomic<size_t> roundtrips;
+  atomic<size_t> roundtrip_usecs;
 
   /// The key to nodeid hash function
   inline procid_t key_node_hash(size_t keyval) {
@@ -191,6 +342,28 @@ class distributed_hash_table{
                                 handlerarg_t mapid,
                                 handlerarg_t key);
 
+  template <typename ValueType>
+  friend void dht_multi_set_handler(distributed_control& dc,
+                                    procid_t source,
+                                    void* ptr,
+                                    size_t len,
+                                    handlerarg_t mapid,
+                                    handlerarg_t setreplyreqid);
+
+  template <typename ValueType>
+  friend void dht_multi_get_handler(distributed_control& dc,
+                                    procid_t source,
+                                    void* ptr,
+                                    size_t len,
+                                    handlerarg_t mapid,
+                                    handlerarg_t reqid);
+
+  friend void dht_multi_cache_write_handler(distributed_control& dc,
+                                            procid_t source,
+                                            void* ptr,
+                                            size_t len,
+                                            handlerarg_t mapid);
+
 
   template <typename Graph>
   friend class distributed_shared_data;
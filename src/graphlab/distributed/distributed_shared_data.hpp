@@ -474,14 +474,13 @@ namespace graphlab {
     void atomic_apply(size_t index,
                       apply_function_type fun,
                       const any& data) {
-      std::stringstream strm;
-      oarchive arc(strm);
+      oarchive arc;
       arc << data;
       volatile size_t trigger = 0;
       dc.remote_call(dht.key_node_hash(index), 
                      distributed_shared_data<Graph>::distributed_shared_data_apply,
-                     (void*)(strm.str().c_str()),
-                     strm.str().length(),
+                     (void*)(arc.data()),
+                     arc.size(),
                      size_t(index),
                      size_t(fun),
                      (handlerarg_t)(&trigger));
@@ -574,8 +573,7 @@ entry of the key
                                               handlerarg_t applyfn,
                                               handlerarg_t applyptr) {
       // ptr/len has the stream for the new data
-      boost::iostreams::stream<boost::iostreams::array_source>  streamin((char*)(ptr), len);
-      iarchive iarc(streamin);
+      iarchive iarc((const char*)(ptr), len);
       
       distributed_shared_data<Graph> &dsdm = *(distributed_shared_data<Graph>::receive_target);
 
@@ -313,12 +313,12 @@ namespace graphlab {
     
         
     /** Get the ids of the in edges */
-    const std::vector<edge_id_t>& in_edge_ids(vertex_id_t v) const {
+    edge_list in_edge_ids(vertex_id_t v) const {
       return mgraph.in_edge_ids(v);
     } 
 
     /** Get the ids of the out edges */
-    const std::vector<edge_id_t>& out_edge_ids(vertex_id_t v) const {
+    edge_list out_edge_ids(vertex_id_t v) const {
       return mgraph.out_edge_ids(v);
     } 
 
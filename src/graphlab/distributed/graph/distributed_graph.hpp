@@ -3,12 +3,20 @@
 #include <cassert>
 #include <cmath>
 #include <vector>
+#include <algorithm>
+#include <string>
+#include <fstream>
+#include <boost/unordered_map.hpp>
 
 #include <graphlab/logger/logger.hpp>
 #include <graphlab/graph/graph.hpp>
 #include <graphlab/util/generics/blob.hpp>
+#include <graphlab/util/dense_bitset.hpp>
+#include <graphlab/parallel/pthread_tools.hpp>
 #include <graphlab/serialization/serialization_includes.hpp>
 #include <graphlab/distributed/distributed_control.hpp>
+#include <graphlab/distributed/graph/streaming_partition.hpp>
+#include <graphlab/distributed/graph/edge_list_reader.hpp>
 
 #include <graphlab/macros_def.hpp>
 
@@ -25,7 +33,9 @@ namespace graphlab {
    * \class distributed_graph
    *   
    * Distributed graph. Each partition is created by each processor
-   * separately.  Vertices are cloned, but edges are NOT.
+   * separately.  Vertices are cloned, but edges are NOT. A graph
+   * built by ingest_edge_list() holds only its own vertices, their
+   * neighbors and their edges.
    */
   template<typename VertexData, typename EdgeData>
   class distributed_graph {
@@ -53,6 +63,12 @@ namespace graphlab {
         only_local_edges = false;
         dcontrol = NULL;
         checksum = size_t(-1);
+        ghost_batch_size = 1024;
+        ghost_delta_encoding = true;
+        streamed = false;
+        global_num_vertices = 0;
+        num_authored_edges = 0;
+        ingest = NULL;
         logger(LOG_INFO, "%d: initialized distributed graph (wout dc)", myprocid);
     }
    
@@ -65,6 +81,12 @@ namespace graphlab {
         constant_edges = false;
         only_local_edges = false;
         checksum = 0;
+        ghost_batch_size = 1024;
+        ghost_delta_encoding = true;
+        streamed = false;
+        global_num_vertices = 0;
+        num_authored_edges = 0;
+        ingest = NULL;
 
        logger(LOG_INFO, "%d: initialized distributed graph", myprocid);
     }
@@ -89,7 +111,6 @@ namespace graphlab {
                       void* ptr, size_t len, 
                       vertex_id_t v, VertexData vdata) {
        receive_target->vertex_data(v) = vdata;
-       if (v == 141400) printf("%d received 141400\n", (int) dc.procid());
      }
 
     static void dist_update_edge_handler(distributed_control& dc, size_t source, 
@@ -98,31 +119,139 @@ namespace graphlab {
       receive_target->edge_data(e) = edata;
     }
 
+    /**
+     * Receives a batch of vertices written by flush_ghosts(): the
+     * number of vertices followed by the id (or the gap from the
+     * previous id) and the data of each.
+     */
+    static void ghost_batch_handler(distributed_control& dc, size_t source,
+                                    void* ptr, size_t len,
+                                    handlerarg_t encoding) {
+      const integer_encoding::integer_encoding_enum enc =
+        integer_encoding::integer_encoding_enum(encoding);
+      iarchive arc((const char*)ptr, len, enc);
+      size_t nvertices;
+      arc >> nvertices;
+      vertex_id_t v = 0;
+      for (size_t i = 0; i < nvertices; ++i) {
+        if (enc == integer_encoding::VARINT) {
+          size_t gap;
+          arc >> gap;
+          v += vertex_id_t(gap);
+        }
+        else {
+          arc >> v;
+        }
+        arc >> receive_target->vertex_data(v);
+      }
+      ASSERT_FALSE(arc.fail());
+    }
+
+    /** Sends the data of the owned vertex v to all its mirrors now */
     void update_vertex(vertex_id_t v) const {
-      DCHECK_LT(v, num_vertices());
-      
-      std::vector<bool> send_to_proc(dcontrol->numprocs(), false);
-      // Always send to 0
-     // send_to_proc[0] = true;
-      
-      // Loop thru out edges to see if need update
-      foreach(edge_id_t e, out_edge_ids(v)) {
-        send_to_proc[vertex2owner[target(e)]] = true;
+      const vertex_id_t l = local_vid(v);
+      for (size_t i = mirror_offsets[l]; i < mirror_offsets[l + 1]; ++i) {
+        dcontrol->remote_callxs(mirror_procs[i],
+                          distributed_graph<VertexData, EdgeData>::dist_update_vertex_handler,
+                          NULL, 0, v, vertex_data(v));
       }
-      foreach(edge_id_t e, in_edge_ids(v)) {
-        send_to_proc[vertex2owner[source(e)]] = true;
+    }
+
+    /**
+     * Records that the data of the owned vertex v has changed. It is
+     * sent to the mirrors of v by the next flush_ghosts(), which
+     * happens on its own once ghost_batch_size vertices are waiting.
+     * The data must be written before the call. Thread safe.
+     */
+    void mark_ghost_dirty(vertex_id_t v) {
+      const vertex_id_t l = local_vid(v);
+      if (mirror_offsets[l] == mirror_offsets[l + 1]) return;
+      // already waiting to be sent
+      if (ghost_dirty.set_bit(l)) return;
+      dirty_lock.lock();
+      dirty_vertices.push_back(l);
+      const bool full = ghost_batch_size > 0 &&
+                        dirty_vertices.size() >= ghost_batch_size;
+      dirty_lock.unlock();
+      if (full) flush_ghosts();
+    }
+
+    /**
+     * Sends the current data of every vertex marked by
+     * mark_ghost_dirty() to its mirrors, with one message per process.
+     * The ids in a message are sorted and, with delta encoding, written
+     * as varint gaps along with varint integers in the vertex data.
+     * Thread safe.
+     */
+    void flush_ghosts() {
+      std::vector<vertex_id_t> vertices;
+      dirty_lock.lock();
+      vertices.swap(dirty_vertices);
+      dirty_lock.unlock();
+      if (vertices.empty()) return;
+      // clear the marks before reading the data, so that a vertex
+      // changed from now on is marked and sent again
+      foreach(vertex_id_t l, vertices) ghost_dirty.clear_bit(l);
+
+      std::vector<std::vector<vertex_id_t> > batches(dcontrol->numprocs());
+      foreach(vertex_id_t l, vertices) {
+        for (size_t i = mirror_offsets[l]; i < mirror_offsets[l + 1]; ++i) {
+          batches[mirror_procs[i]].push_back(global_vid(l));
+        }
       }
-     
-     // Vertex data is broadcasted to everyone. TODO: send only to owner?
-      for (procid_t i = 0;i < dcontrol->numprocs(); ++i) {
-        if (i != myprocid && send_to_proc[i]) {
-          if (v == 141400) printf("%d Sending 141400 to %d\n", (int) myprocid, (int) i);
-          dcontrol->remote_callxs(i, distributed_graph<VertexData, EdgeData>::dist_update_vertex_handler,
-                          NULL, 0, v, vertex_data(v));
+      const integer_encoding::integer_encoding_enum enc =
+        ghost_delta_encoding ? integer_encoding::VARINT
+                             : integer_encoding::FIXED_WIDTH;
+      for (procid_t p = 0; p < batches.size(); ++p) {
+        if (batches[p].empty()) continue;
+        std::sort(batches[p].begin(), batches[p].end());
+        oarchive arc(enc);
+        arc << batches[p].size();
+        vertex_id_t prev = 0;
+        foreach(vertex_id_t v, batches[p]) {
+          if (ghost_delta_encoding) arc << size_t(v - prev);
+          else arc << v;
+          prev = v;
+          arc << vertex_data(v);
         }
+        dcontrol->remote_call(p, distributed_graph<VertexData, EdgeData>::ghost_batch_handler,
+                              (void*)arc.data(), arc.size(), handlerarg_t(enc));
       }
     }
 
+    /**
+     * Flushes the changed vertices of every process and waits until
+     * they have been received, after which every mirror holds the
+     * data of its vertex. Must be called by all processes.
+     */
+    void sync_ghosts() {
+      flush_ghosts();
+      dcontrol->barrier();
+    }
+
+    /**
+     * The number of changed vertices at which mark_ghost_dirty()
+     * flushes. 0 only flushes in flush_ghosts() and sync_ghosts().
+     * The default is 1024.
+     */
+    void set_ghost_batch_size(size_t nvertices) {
+      ghost_batch_size = nvertices;
+    }
+
+    /**
+     * Whether ghost batches are delta and varint encoded. The default
+     * is true.
+     */
+    void set_ghost_delta_encoding(bool delta) {
+      ghost_delta_encoding = delta;
+    }
+
+    /** The number of other processes with an edge to the owned vertex v */
+    size_t num_mirrors(vertex_id_t v) const {
+      const vertex_id_t l = local_vid(v);
+      return mirror_offsets[l + 1] - mirror_offsets[l];
+    }
+
 	void send_vertices_to_proczero() {
 	  if (myprocid != 0) {
 		foreach(vertex_id_t v, myvertices) {
@@ -139,12 +268,12 @@ namespace graphlab {
       
 
       // Send updated edge data only to source and target.
-      if (vertex2owner[_target] != myprocid) {
-         dcontrol->remote_callxs(vertex2owner[_target], distributed_graph<VertexData, EdgeData>::dist_update_edge_handler,
+      if (owner(_target) != myprocid) {
+         dcontrol->remote_callxs(owner(_target), distributed_graph<VertexData, EdgeData>::dist_update_edge_handler,
                             NULL, 0, e, edge_data(e));
       }
-      if (vertex2owner[_source] != myprocid) {
-         dcontrol->remote_callxs(vertex2owner[_source], distributed_graph<VertexData, EdgeData>::dist_update_edge_handler,
+      if (owner(_source) != myprocid) {
+         dcontrol->remote_callxs(owner(_source), distributed_graph<VertexData, EdgeData>::dist_update_edge_handler,
                             NULL, 0, e, edge_data(e));
       }
     }
@@ -173,19 +302,23 @@ namespace graphlab {
       ASSERT_EQ(receive_target, this);
       ASSERT_EQ(dcontrol->procid(), myprocid);
       
-      // Compute checksum of vertex ownerships
-      size_t cs = 0;
-      for(size_t i=0; i<mgraph.num_vertices(); i++) {
-         cs += (i % 31) * vertex2owner[i];
+      // Compute checksum of vertex ownerships. A streamed graph only
+      // knows the owners of its own vertices and their neighbors
+      if (!streamed) {
+        size_t cs = 0;
+        for(size_t i=0; i<mgraph.num_vertices(); i++) {
+           cs += (i % 31) * vertex2owner[i];
+        }
+        checksum = cs;
+        
+        dcontrol->mpi_barrier();
+        printf("%d My checksum :%ld %ld\n", dcontrol->procid(), checksum, receive_target->checksum);
+        if (dcontrol->procid() != 0)
+              dcontrol->remote_callxs(0, distributed_graph::check_checksum, NULL, 0, checksum);
       }
-      checksum = cs;
-      
-      dcontrol->mpi_barrier();
-      printf("%d My checksum :%ld %ld\n", dcontrol->procid(), checksum, receive_target->checksum);
-      if (dcontrol->procid() != 0)
-            dcontrol->remote_callxs(0, distributed_graph::check_checksum, NULL, 0, checksum);
    
   	  long int overhead = 0;
+      compute_mirrors();
   	 
      if (g_inedges.size() > 0) return;
       // Hack
@@ -196,15 +329,15 @@ namespace graphlab {
 	
 		  for(size_t i=0; i<mgraph.num_vertices(); i++) {
 			  if (vertex2owner[i] == myprocid) {
-				 std::vector< edge_id_t> ine = mgraph.in_edge_ids(i);
+				 edge_list ine = mgraph.in_edge_ids(i);
 				 for(size_t j=0; j<ine.size(); j++) {
-					g_inedges[i].push_back(eid_local_to_global[ine[j]]);
+					g_inedges[i].push_back(local_to_global_eid(ine[j]));
 					overhead += sizeof(edge_id_t);
 				 }
 				 
-				 std::vector< edge_id_t> oute = mgraph.out_edge_ids(i);
+				 edge_list oute = mgraph.out_edge_ids(i);
 				 for(size_t j=0; j<oute.size(); j++) {
-					g_outedges[i].push_back(eid_local_to_global[oute[j]]);
+					g_outedges[i].push_back(local_to_global_eid(oute[j]));
 					overhead += sizeof(edge_id_t);
 				 }
 			  }
@@ -227,6 +360,39 @@ namespace graphlab {
       mgraph.finalize();
       finalize_dist();
     }
+
+    /**
+     * Finds the other processes with an edge to each owned vertex.
+     * The local graph holds every edge of an owned vertex. Indexed by
+     * local vertex id.
+     */
+    void compute_mirrors() {
+      const size_t nverts = mgraph.num_vertices();
+      mirror_offsets.assign(nverts + 1, 0);
+      mirror_procs.clear();
+      std::vector<procid_t> procs;
+      for (vertex_id_t v = 0; v < nverts; ++v) {
+        mirror_offsets[v] = mirror_procs.size();
+        if (vertex2owner[v] != myprocid) continue;
+        procs.clear();
+        foreach(edge_id_t e, mgraph.out_edge_ids(v)) {
+          procs.push_back(vertex2owner[mgraph.target(e)]);
+        }
+        foreach(edge_id_t e, mgraph.in_edge_ids(v)) {
+          procs.push_back(vertex2owner[mgraph.source(e)]);
+        }
+        std::sort(procs.begin(), procs.end());
+        procs.erase(std::unique(procs.begin(), procs.end()), procs.end());
+        foreach(procid_t p, procs) {
+          if (p != myprocid) mirror_procs.push_back(p);
+        }
+      }
+      mirror_offsets[nverts] = mirror_procs.size();
+      ghost_dirty.resize(nverts);
+      ghost_dirty.clear();
+      logger(LOG_INFO, "%lu mirrors of %lu owned vertices",
+             (unsigned long)mirror_procs.size(), (unsigned long)myvertices.size());
+    }
    
     /** 
      * Creates a vertex containing the vertex data and returns the id
@@ -268,14 +434,52 @@ namespace graphlab {
     } 
     
     
+    /**
+     * The global id of a local edge. In a streamed graph the edges
+     * whose source is owned here come first and local edge l among
+     * them has the global id l * numprocs + procid, so only the other
+     * edges need a table.
+     */
     edge_id_t local_to_global_eid(const edge_id_t &e) const{
-      return eid_local_to_global[e];
+      if (only_local_edges) return e;
+      if (streamed && e < num_authored_edges) {
+        return e * dcontrol->numprocs() + myprocid;
+      }
+      return eid_local_to_global[e - num_authored_edges];
     }
     
     edge_id_t global_to_local_eid(const edge_id_t &e) const{
+      if (only_local_edges) return e;
+      if (streamed && e % dcontrol->numprocs() == myprocid) {
+        return e / dcontrol->numprocs();
+      }
       edge_id_t loceid = (eid_global_to_local.find(e))->second;
       return loceid;
     }
+
+    /**
+     * The id in the local graph of the vertex v. Every vertex is
+     * local unless the graph is streamed, which holds only the owned
+     * vertices and their neighbors.
+     */
+    vertex_id_t local_vid(vertex_id_t v) const {
+      if (!streamed) return v;
+      typename boost::unordered_map<vertex_id_t, vertex_id_t>::const_iterator
+        it = global2local_vid.find(v);
+      ASSERT_MSG(it != global2local_vid.end(),
+                 "Vertex %u is not held by process %d", v, (int)myprocid);
+      return it->second;
+    }
+
+    /** The global id of the local vertex l */
+    vertex_id_t global_vid(vertex_id_t l) const {
+      return streamed ? local2global_vid[l] : l;
+    }
+
+    /** Whether the vertex v is held by this process */
+    bool is_local_vertex(vertex_id_t v) const {
+      return streamed ? global2local_vid.count(v) > 0 : v < mgraph.num_vertices();
+    }
     
   
     distributed_graph<VertexData,EdgeData>&
@@ -290,7 +494,7 @@ namespace graphlab {
 
     /** Get the number of vetices */
     size_t num_vertices() const {
-      return mgraph.num_vertices();
+      return streamed ? global_num_vertices : mgraph.num_vertices();
     }
 
     /** Get the number of edges */
@@ -304,63 +508,63 @@ namespace graphlab {
 
     /** Get the number of in edges */
     size_t num_in_neighbors(vertex_id_t v) const {
-      ASSERT_EQ(vertex2owner[v], myprocid);
-      return mgraph.num_in_neighbors(v);
+      ASSERT_EQ(owner(v), myprocid);
+      return mgraph.num_in_neighbors(local_vid(v));
     } 
     
     /** get the number of out edges */
     size_t num_out_neighbors(vertex_id_t v) const  {
-      ASSERT_EQ(vertex2owner[v], myprocid);
-      return mgraph.num_out_neighbors(v);
+      ASSERT_EQ(owner(v), myprocid);
+      return mgraph.num_out_neighbors(local_vid(v));
     } 
 
     /** Find an edge */
     std::pair<bool, edge_id_t>
     find(vertex_id_t source, vertex_id_t target) const {
-      std::pair<bool, edge_id_t> loc = mgraph.find(source,target);
-      if (loc.first == true && !only_local_edges) 
-      	loc.second = eid_local_to_global[loc.second];
+      if (!is_local_vertex(source) || !is_local_vertex(target)) {
+        return std::make_pair(false, edge_id_t(0));
+      }
+      std::pair<bool, edge_id_t> loc = mgraph.find(local_vid(source),
+                                                   local_vid(target));
+      if (loc.first == true) loc.second = local_to_global_eid(loc.second);
       return loc;
     } 
 
     
     /** get the edge id for the edge */
     edge_id_t edge_id(vertex_id_t source, vertex_id_t target) const {
-      return (only_local_edges ? mgraph.edge_id(source,target) :
-      			eid_local_to_global[mgraph.edge_id(source,target)]);
+      return local_to_global_eid(mgraph.edge_id(local_vid(source),
+                                                local_vid(target)));
     } 
 
     
     /** get the reverser edge id for the edge */
     edge_id_t rev_edge_id(edge_id_t eid) const {
-      edge_id_t loceid = (only_local_edges ? eid : (eid_global_to_local.find(edge_id))->second);
-      return eid_local_to_global[mgraph.rev_edge_id(loceid)];
+      return local_to_global_eid(mgraph.rev_edge_id(global_to_local_eid(eid)));
     }
 
 
     /** get the source of the edge */
     vertex_id_t source(edge_id_t edge_id) const {
-      edge_id_t loceid = (only_local_edges ? edge_id : (eid_global_to_local.find(edge_id))->second);
-      return mgraph.source(loceid);
+      return global_vid(mgraph.source(global_to_local_eid(edge_id)));
     }
 
     /** get the dest of the edge */
     vertex_id_t target(edge_id_t edge_id) const {
-      edge_id_t loceid = (only_local_edges ? edge_id : (eid_global_to_local.find(edge_id))->second);
-      return mgraph.target(loceid);
+      return global_vid(mgraph.target(global_to_local_eid(edge_id)));
     }
 
 
     /** Get the ids of the in edges */
-    const std::vector<edge_id_t>& in_edge_ids(vertex_id_t v) const {
-      ASSERT_EQ(vertex2owner[v], myprocid);
-	  return (only_local_edges ? mgraph.in_edge_ids(v) : g_inedges[v]);
+    edge_list in_edge_ids(vertex_id_t v) const {
+      ASSERT_EQ(owner(v), myprocid);
+	  return (only_local_edges ? mgraph.in_edge_ids(v) : edge_list(g_inedges[local_vid(v)]));
     } 
 
     /** Get the ids of the out edges */
-    const std::vector<edge_id_t>& out_edge_ids(vertex_id_t v) const {
-      ASSERT_EQ(vertex2owner[v], myprocid);
-      return (only_local_edges ? mgraph.out_edge_ids(v) : g_outedges[v]);
+    edge_list out_edge_ids(vertex_id_t v) const {
+      ASSERT_EQ(owner(v), myprocid);
+      return (only_local_edges ? mgraph.out_edge_ids(v) : edge_list(g_outedges[local_vid(v)]));
     } 
 
 
@@ -369,7 +573,7 @@ namespace graphlab {
     }
 
     const procid_t owner(const vertex_id_t &v) const{
-      return vertex2owner[v];
+      return vertex2owner[local_vid(v)];
     }
     
     procid_t myproc() {
@@ -393,36 +597,36 @@ namespace graphlab {
     
     /** Get the vertex data */
     VertexData& vertex_data(vertex_id_t v) {
-      return mgraph.vertex_data(v);
+      return mgraph.vertex_data(local_vid(v));
     } 
     
     /** Get the vertex data */
     const VertexData& vertex_data(vertex_id_t v) const {
-      return mgraph.vertex_data(v);
+      return mgraph.vertex_data(local_vid(v));
     } 
 
     /** Get the edge_data */
     EdgeData& edge_data(vertex_id_t source, vertex_id_t target) {
-      ASSERT_TRUE(vertex2owner[source] == myprocid || vertex2owner[target] == myprocid);
-      return mgraph.edge_data(source, target);
+      ASSERT_TRUE(owner(source) == myprocid || owner(target) == myprocid);
+      return mgraph.edge_data(local_vid(source), local_vid(target));
     } 
     
     /** Get the edge_data */
     const EdgeData& edge_data(vertex_id_t source, vertex_id_t target) const {
-      ASSERT_TRUE(vertex2owner[source] == myprocid || vertex2owner[target] == myprocid);
-      return mgraph.edge_data(source, target);
+      ASSERT_TRUE(owner(source) == myprocid || owner(target) == myprocid);
+      return mgraph.edge_data(local_vid(source), local_vid(target));
     } 
 
     /** Get the edge_data */
     EdgeData& edge_data(edge_id_t edge_id) { 
-       edge_id_t loceid = (only_local_edges ? edge_id : eid_global_to_local[edge_id]);
+       edge_id_t loceid = global_to_local_eid(edge_id);
        ASSERT_TRUE(vertex2owner[mgraph.source(loceid)] == myprocid || vertex2owner[mgraph.target(loceid)] == myprocid);
        return mgraph.edge_data(loceid);
     }
     
     /** Get the edge_data */
     const EdgeData& edge_data(edge_id_t edge_id) const {
-       edge_id_t loceid  =  (only_local_edges ? edge_id : (eid_global_to_local.find(edge_id))->second);
+       edge_id_t loceid  =  global_to_local_eid(edge_id);
        ASSERT_TRUE(vertex2owner[mgraph.source(loceid)] == myprocid || vertex2owner[mgraph.target(loceid)] == myprocid);
        return mgraph.edge_data(loceid);
     }
@@ -459,6 +663,7 @@ namespace graphlab {
 
     /** Save the graph to an archive */
     void save(oarchive &arc) const {
+      ASSERT_MSG(!streamed, "A streamed graph cannot be saved");
       // Write the number of edges and vertices
       arc << mgraph
           << vertex2owner
@@ -527,6 +732,382 @@ namespace graphlab {
     	 }
     }
 
+    // Streaming ingest =======================================================
+
+    /** An edge read by ingest_edge_list() */
+    struct ingest_edge {
+      vertex_id_t source;
+      vertex_id_t target;
+      procid_t source_owner;
+      procid_t target_owner;
+      /// assigned by the owner of the source
+      edge_id_t id;
+      EdgeData data;
+      void save(oarchive& arc) const {
+        arc << source << target << source_owner << target_owner << id << data;
+      }
+      void load(iarchive& arc) {
+        arc >> source >> target >> source_owner >> target_owner >> id >> data;
+      }
+    };
+
+    /** The state of ingest_edge_list() shared with its handlers */
+    struct ingest_state {
+      mutex lock;
+      /// owners of the vertices v with v % numprocs == procid
+      boost::unordered_map<vertex_id_t, procid_t> directory;
+      /// vertices placed on each process by this directory this round
+      std::vector<size_t> placed;
+      /// owners of the endpoints of the chunk being read
+      boost::unordered_map<vertex_id_t, procid_t> chunk_owners;
+      /// edges whose source is owned elsewhere, added last
+      std::vector<ingest_edge> foreign_edges;
+    };
+
+    /**
+     * Builds the graph from an edge list file without holding all of
+     * it on any process. Every process reads the lines starting in its
+     * share of the bytes of the file, chunk_edges edges at a time, and
+     * the owner of each vertex is chosen by the streaming placement
+     * method when the vertex is first read. Each edge is sent to the
+     * owner of its source, which numbers it and passes it on to the
+     * owner of its target, so that a process only receives the edges
+     * of its own vertices and the owners of their neighbors. Under
+     * GREEDY and LDG the owner of the vertex v is recorded by process
+     * v % numprocs, which the readers ask before placing a vertex.
+     *
+     * parser(line, source, target, edata) returns false for lines
+     * which hold no edge. Self edges are dropped, and an edge may not
+     * appear twice. Vertices without edges are not created and the
+     * vertex data is default constructed. Must be called by all
+     * processes on an empty graph built with the distributed_control.
+     * The graph is finalized on return.
+     */
+    template <typename EdgeParser>
+    void ingest_edge_list(const std::string& filename,
+                          streaming_partition::streaming_partition_enum method,
+                          size_t chunk_edges, EdgeParser parser) {
+      ASSERT_TRUE(dcontrol != NULL);
+      ASSERT_TRUE(mgraph.num_vertices() == 0);
+      ASSERT_TRUE(receive_target == this);
+      ASSERT_TRUE(chunk_edges > 0);
+      const procid_t nprocs = dcontrol->numprocs();
+      ingest_state state;
+      state.placed.assign(nprocs, 0);
+      ingest = &state;
+      streamed = true;
+
+      edge_list_reader reader(filename, myprocid, nprocs);
+      std::string line;
+
+      // vertices owned by each process and one more than the largest
+      // vertex id, over all processes as of the last round
+      std::vector<size_t> loads(nprocs, 0);
+      size_t nvertices = 0;
+      size_t localbound = 0;
+      size_t nread = 0, nselfedges = 0;
+      bool more = true;
+      std::vector<ingest_edge> chunk;
+      while (true) {
+        chunk.clear();
+        while (more && chunk.size() < chunk_edges) {
+          if (!reader.next_line(line)) {
+            more = false;
+            break;
+          }
+          ingest_edge e;
+          if (!parser(line, e.source, e.target, e.data)) continue;
+          if (e.source == e.target) {
+            ++nselfedges;
+            continue;
+          }
+          localbound = std::max(localbound,
+                                size_t(std::max(e.source, e.target)) + 1);
+          chunk.push_back(e);
+        }
+        nread += chunk.size();
+
+        if (method == streaming_partition::HASH) {
+          foreach(ingest_edge& e, chunk) {
+            e.source_owner = streaming_partition::hash_owner(e.source, nprocs);
+            e.target_owner = streaming_partition::hash_owner(e.target, nprocs);
+          }
+        }
+        else {
+          place_chunk_vertices(method, chunk, loads,
+                               std::max(nvertices, localbound));
+        }
+        std::vector<std::vector<ingest_edge> > batches(nprocs);
+        foreach(const ingest_edge& e, chunk) {
+          batches[e.source_owner].push_back(e);
+        }
+        for (procid_t p = 0; p < nprocs; ++p) {
+          if (batches[p].empty()) continue;
+          oarchive arc;
+          arc << batches[p];
+          dcontrol->remote_call(p, distributed_graph<VertexData, EdgeData>::ingest_edges_handler,
+                                (void*)arc.data(), arc.size());
+        }
+        dcontrol->barrier();
+
+        // count the vertices the directories placed in this round and
+        // the processes which have lines left
+        std::vector<size_t> counts(state.placed);
+        counts.push_back(more ? 1 : 0);
+        dcontrol->mpi_allreduce_sum(counts);
+        for (procid_t p = 0; p < nprocs; ++p) loads[p] += counts[p];
+        state.placed.assign(nprocs, 0);
+        nvertices = dcontrol->mpi_allreduce_max(localbound);
+        if (counts[nprocs] == 0) break;
+      }
+
+      // the edges numbered by the owners of their sources elsewhere
+      // follow the edges numbered here
+      num_authored_edges = mgraph.num_edges();
+      eid_local_to_global.reserve(state.foreign_edges.size());
+      foreach(const ingest_edge& e, state.foreign_edges) {
+        const vertex_id_t source = add_local_vertex(e.source, e.source_owner);
+        const vertex_id_t target = add_local_vertex(e.target, e.target_owner);
+        const edge_id_t l = mgraph.add_edge(source, target, e.data);
+        eid_local_to_global.push_back(e.id);
+        eid_global_to_local[e.id] = l;
+      }
+      ingest = NULL;
+      global_num_vertices = nvertices;
+      std::sort(myvertices.begin(), myvertices.end());
+      logger(LOG_INFO, "%d: read %lu edges and dropped %lu self edges. "
+             "Holding %lu of %lu vertices, %lu owned, and %lu edges, "
+             "%lu numbered elsewhere", (int)myprocid, (unsigned long)nread,
+             (unsigned long)nselfedges, (unsigned long)mgraph.num_vertices(),
+             (unsigned long)global_num_vertices,
+             (unsigned long)myvertices.size(),
+             (unsigned long)mgraph.num_edges(),
+             (unsigned long)eid_local_to_global.size());
+      finalize();
+    }
+
+    /** ingest_edge_list() of a "source target" edge list */
+    void ingest_edge_list(const std::string& filename,
+                          streaming_partition::streaming_partition_enum method =
+                            streaming_partition::HASH,
+                          size_t chunk_edges = 65536) {
+      ingest_edge_list(filename, method, chunk_edges,
+                       parse_edge_pair<EdgeData>);
+    }
+
+    /**
+     * Finds the owners of the endpoints of a chunk under GREEDY or
+     * LDG. The directories are asked for the vertices placed before,
+     * the others are placed in the order they appear, counting their
+     * neighbors in the chunk, and the placements are proposed to the
+     * directories, which keep the first proposal for a vertex. Called
+     * by every process in each round of ingest_edge_list().
+     */
+    void place_chunk_vertices(streaming_partition::streaming_partition_enum method,
+                              std::vector<ingest_edge>& chunk,
+                              const std::vector<size_t>& loads,
+                              size_t nvertices) {
+      const procid_t nprocs = dcontrol->numprocs();
+      ingest_state& state = *ingest;
+      // the endpoints in order of appearance and their neighbors
+      std::vector<vertex_id_t> endpoints;
+      std::vector<std::vector<vertex_id_t> > neighbors;
+      boost::unordered_map<vertex_id_t, size_t> position;
+      foreach(const ingest_edge& e, chunk) {
+        const vertex_id_t ends[2] = {e.source, e.target};
+        for (size_t i = 0; i < 2; ++i) {
+          std::pair<typename boost::unordered_map<vertex_id_t, size_t>::iterator, bool>
+            ins = position.insert(std::make_pair(ends[i], endpoints.size()));
+          if (ins.second) {
+            endpoints.push_back(ends[i]);
+            neighbors.push_back(std::vector<vertex_id_t>());
+          }
+          neighbors[ins.first->second].push_back(ends[1 - i]);
+        }
+      }
+
+      state.lock.lock();
+      state.chunk_owners.clear();
+      state.lock.unlock();
+      std::vector<std::vector<vertex_id_t> > queries(nprocs);
+      foreach(vertex_id_t v, endpoints) queries[v % nprocs].push_back(v);
+      for (procid_t p = 0; p < nprocs; ++p) {
+        if (queries[p].empty()) continue;
+        oarchive arc;
+        arc << queries[p];
+        dcontrol->remote_call(p, distributed_graph<VertexData, EdgeData>::ingest_query_handler,
+                              (void*)arc.data(), arc.size());
+      }
+      dcontrol->barrier();
+
+      // loads includes the placements of this process in this round
+      std::vector<size_t> estimate(loads);
+      const double capacity = std::max(1.0, 1.05 * nvertices / nprocs);
+      std::vector<size_t> counts(nprocs);
+      std::vector<std::vector<vertex_id_t> > proposed(nprocs);
+      std::vector<std::vector<procid_t> > proposed_owners(nprocs);
+      state.lock.lock();
+      for (size_t i = 0; i < endpoints.size(); ++i) {
+        const vertex_id_t v = endpoints[i];
+        if (state.chunk_owners.count(v) > 0) continue;
+        counts.assign(nprocs, 0);
+        foreach(vertex_id_t u, neighbors[i]) {
+          typename boost::unordered_map<vertex_id_t, procid_t>::const_iterator
+            it = state.chunk_owners.find(u);
+          if (it != state.chunk_owners.end()) ++counts[it->second];
+        }
+        const procid_t p = streaming_partition::place(method, counts, estimate,
+                                                      capacity);
+        ++estimate[p];
+        state.chunk_owners[v] = p;
+        proposed[v % nprocs].push_back(v);
+        proposed_owners[v % nprocs].push_back(p);
+      }
+      state.lock.unlock();
+      for (procid_t p = 0; p < nprocs; ++p) {
+        if (proposed[p].empty()) continue;
+        oarchive arc;
+        arc << proposed[p] << proposed_owners[p];
+        dcontrol->remote_call(p, distributed_graph<VertexData, EdgeData>::ingest_propose_handler,
+                              (void*)arc.data(), arc.size());
+      }
+      dcontrol->barrier();
+
+      foreach(ingest_edge& e, chunk) {
+        e.source_owner = state.chunk_owners[e.source];
+        e.target_owner = state.chunk_owners[e.target];
+      }
+    }
+
+    /**
+     * Returns the local id of the vertex v owned by owner, adding it
+     * to the local graph the first time. Only called by ingest.
+     */
+    vertex_id_t add_local_vertex(vertex_id_t v, procid_t owner) {
+      std::pair<typename boost::unordered_map<vertex_id_t, vertex_id_t>::iterator, bool>
+        ins = global2local_vid.insert(std::make_pair(v, vertex_id_t(mgraph.num_vertices())));
+      if (ins.second) {
+        mgraph.add_vertex();
+        local2global_vid.push_back(v);
+        vertex2owner.push_back(owner);
+        if (owner == myprocid) myvertices.push_back(v);
+      }
+      return ins.first->second;
+    }
+
+    /** Sends owners of vertices to a process reading a chunk */
+    static void send_ingest_owners(distributed_control& dc, procid_t target,
+                                   const std::vector<vertex_id_t>& vertices,
+                                   const std::vector<procid_t>& owners) {
+      if (vertices.empty()) return;
+      oarchive arc;
+      arc << vertices << owners;
+      dc.remote_call(target, distributed_graph<VertexData, EdgeData>::ingest_owners_handler,
+                     (void*)arc.data(), arc.size());
+    }
+
+    /** Replies with the owners this directory knows of the vertices */
+    static void ingest_query_handler(distributed_control& dc, size_t source,
+                                     void* ptr, size_t len) {
+      ingest_state& state = *receive_target->ingest;
+      iarchive arc((const char*)ptr, len);
+      std::vector<vertex_id_t> vertices;
+      arc >> vertices;
+      std::vector<vertex_id_t> known;
+      std::vector<procid_t> owners;
+      state.lock.lock();
+      foreach(vertex_id_t v, vertices) {
+        typename boost::unordered_map<vertex_id_t, procid_t>::const_iterator
+          it = state.directory.find(v);
+        if (it == state.directory.end()) continue;
+        known.push_back(v);
+        owners.push_back(it->second);
+      }
+      state.lock.unlock();
+      send_ingest_owners(dc, procid_t(source), known, owners);
+    }
+
+    /**
+     * Records the proposed owners of vertices which have none yet and
+     * replies with the owner of each
+     */
+    static void ingest_propose_handler(distributed_control& dc, size_t source,
+                                       void* ptr, size_t len) {
+      ingest_state& state = *receive_target->ingest;
+      iarchive arc((const char*)ptr, len);
+      std::vector<vertex_id_t> vertices;
+      std::vector<procid_t> owners;
+      arc >> vertices >> owners;
+      state.lock.lock();
+      for (size_t i = 0; i < vertices.size(); ++i) {
+        std::pair<typename boost::unordered_map<vertex_id_t, procid_t>::iterator, bool>
+          ins = state.directory.insert(std::make_pair(vertices[i], owners[i]));
+        if (ins.second) ++state.placed[owners[i]];
+        else owners[i] = ins.first->second;
+      }
+      state.lock.unlock();
+      send_ingest_owners(dc, procid_t(source), vertices, owners);
+    }
+
+    /** Receives the owners of endpoints of the chunk being read */
+    static void ingest_owners_handler(distributed_control& dc, size_t source,
+                                      void* ptr, size_t len) {
+      ingest_state& state = *receive_target->ingest;
+      iarchive arc((const char*)ptr, len);
+      std::vector<vertex_id_t> vertices;
+      std::vector<procid_t> owners;
+      arc >> vertices >> owners;
+      state.lock.lock();
+      for (size_t i = 0; i < vertices.size(); ++i) {
+        state.chunk_owners[vertices[i]] = owners[i];
+      }
+      state.lock.unlock();
+    }
+
+    /**
+     * Adds edges whose source is owned here, numbering them, and
+     * passes on those whose target is owned elsewhere
+     */
+    static void ingest_edges_handler(distributed_control& dc, size_t source,
+                                     void* ptr, size_t len) {
+      distributed_graph<VertexData, EdgeData>& g = *receive_target;
+      iarchive arc((const char*)ptr, len);
+      std::vector<ingest_edge> edges;
+      arc >> edges;
+      std::vector<std::vector<ingest_edge> > forward(dc.numprocs());
+      g.ingest->lock.lock();
+      foreach(ingest_edge& e, edges) {
+        const vertex_id_t s = g.add_local_vertex(e.source, e.source_owner);
+        const vertex_id_t t = g.add_local_vertex(e.target, e.target_owner);
+        const size_t l = g.mgraph.add_edge(s, t, e.data);
+        const size_t id = l * dc.numprocs() + g.myprocid;
+        ASSERT_MSG(id == edge_id_t(id), "Too many edges for edge_id_t");
+        e.id = edge_id_t(id);
+        if (e.target_owner != g.myprocid) forward[e.target_owner].push_back(e);
+      }
+      g.ingest->lock.unlock();
+      for (procid_t p = 0; p < forward.size(); ++p) {
+        if (forward[p].empty()) continue;
+        oarchive out;
+        out << forward[p];
+        dc.remote_call(p, distributed_graph<VertexData, EdgeData>::ingest_foreign_handler,
+                       (void*)out.data(), out.size());
+      }
+    }
+
+    /** Keeps edges numbered by the owner of their source */
+    static void ingest_foreign_handler(distributed_control& dc, size_t source,
+                                       void* ptr, size_t len) {
+      ingest_state& state = *receive_target->ingest;
+      iarchive arc((const char*)ptr, len);
+      std::vector<ingest_edge> edges;
+      arc >> edges;
+      state.lock.lock();
+      state.foreign_edges.insert(state.foreign_edges.end(),
+                                 edges.begin(), edges.end());
+      state.lock.unlock();
+    }
+
         graph<VertexData, EdgeData> mgraph;
 
   private:    
@@ -551,6 +1132,28 @@ namespace graphlab {
     
     edge_id_t global_id_counter;
 
+    // ghost synchronization
+    /// mirror_procs[mirror_offsets[l] .. mirror_offsets[l+1]) are the
+    /// other processes with an edge to the owned local vertex l
+    std::vector<size_t> mirror_offsets;
+    std::vector<procid_t> mirror_procs;
+    /// owned vertices marked by mark_ghost_dirty() and not yet flushed
+    dense_bitset ghost_dirty;
+    std::vector<vertex_id_t> dirty_vertices;
+    spinlock dirty_lock;
+    size_t ghost_batch_size;
+    bool ghost_delta_encoding;
+
+    // streamed graphs, built by ingest_edge_list()
+    bool streamed;
+    size_t global_num_vertices;
+    /// the local graph holds the owned vertices and their neighbors
+    std::vector<vertex_id_t> local2global_vid;
+    boost::unordered_map<vertex_id_t, vertex_id_t> global2local_vid;
+    /// local edges below this were numbered here. The ids of the others
+    /// are in eid_local_to_global from 0
+    size_t num_authored_edges;
+    ingest_state* ingest;
 
   }; // End of graph
 
@@ -0,0 +1,583 @@
+#ifndef DISTRIBUTED_VERTEXCUT_GRAPH_HPP
+#define DISTRIBUTED_VERTEXCUT_GRAPH_HPP
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <boost/unordered_map.hpp>
+
+#include <graphlab/logger/logger.hpp>
+#include <graphlab/graph/graph.hpp>
+#include <graphlab/parallel/pthread_tools.hpp>
+#include <graphlab/serialization/serialization_includes.hpp>
+#include <graphlab/distributed/distributed_control.hpp>
+#include <graphlab/distributed/graph/streaming_partition.hpp>
+#include <graphlab/distributed/graph/edge_list_reader.hpp>
+
+#include <graphlab/macros_def.hpp>
+
+namespace graphlab {
+
+  /**
+   * \class distributed_vertexcut_graph
+   *
+   * Distributed graph partitioned by edges. Each edge is stored on one
+   * process and each process holds a replica of every endpoint of its
+   * edges. One replica of a vertex is its master and the others are
+   * its mirrors, so the edges of a high degree vertex are spread over
+   * many processes instead of all landing on its owner as in
+   * distributed_graph.
+   *
+   * Computation runs in gather_apply_scatter() steps: every replica
+   * gathers over its local edges, the partial results are combined at
+   * the master, which applies them to the vertex data, and the new
+   * data is sent back to the mirrors. The vertex data of mirrors is
+   * read only.
+   *
+   * Edges are added with add_edge() from any process, or read with
+   * ingest_edge_list(), and finalize() must then be called by all
+   * processes. The global id of the local edge l is l * numprocs +
+   * procid.
+   */
+  template<typename VertexData, typename EdgeData>
+  class distributed_vertexcut_graph {
+  public:
+
+    /** The type of the vertex data stored in the graph */
+    typedef VertexData vertex_data_type;
+
+    /** The type of the edge data stored in the graph */
+    typedef EdgeData   edge_data_type;
+
+    typedef distributed_vertexcut_graph<VertexData, EdgeData> graph_type;
+
+    distributed_vertexcut_graph(distributed_control& dc,
+                                vertexcut_partition::vertexcut_partition_enum
+                                  method = vertexcut_partition::GRID) :
+      mgraph(0), dcontrol(&dc), myprocid(dc.procid()), method(method),
+      finalized(false), global_num_vertices(0), replication(0), imbalance(0),
+      gather_accumulators(NULL) {
+      receive_target = this;
+      edge_batches.resize(dc.numprocs());
+      // edges may only be sent once every process can receive them
+      dc.mpi_barrier();
+    }
+
+    ~distributed_vertexcut_graph() {
+      foreach(oarchive* arc, edge_batches) delete arc;
+    }
+
+    static graph_type* receive_target;
+
+    // Construction ============================================================
+
+    /**
+     * Adds the edge from source to target on the process the
+     * placement method picks. May be called by any process for any
+     * edge, before finalize(). Thread safe. An edge may not be added
+     * twice.
+     */
+    void add_edge(vertex_id_t source, vertex_id_t target,
+                  const EdgeData& edata = EdgeData()) {
+      ASSERT_FALSE(finalized);
+      const procid_t p = vertexcut_partition::edge_owner(method, source, target,
+                                                         dcontrol->numprocs());
+      batch_lock.lock();
+      if (edge_batches[p] == NULL) edge_batches[p] = new oarchive;
+      (*edge_batches[p]) << source << target << edata;
+      const bool full = edge_batches[p]->size() >= EDGE_BATCH_BYTES;
+      oarchive* arc = NULL;
+      if (full) std::swap(arc, edge_batches[p]);
+      batch_lock.unlock();
+      if (full) send_edge_batch(p, arc);
+    }
+
+    /**
+     * Reads an edge list file, each process reading the lines starting
+     * in its share of the bytes, and finalizes the graph. parser(line,
+     * source, target, edata) returns false for lines which hold no
+     * edge. Self edges are dropped. Must be called by all processes.
+     */
+    template <typename EdgeParser>
+    void ingest_edge_list(const std::string& filename, EdgeParser parser) {
+      edge_list_reader reader(filename, myprocid, dcontrol->numprocs());
+      std::string line;
+      vertex_id_t source, target;
+      EdgeData edata;
+      while (reader.next_line(line)) {
+        if (parser(line, source, target, edata) && source != target) {
+          add_edge(source, target, edata);
+        }
+      }
+      finalize();
+    }
+
+    /** ingest_edge_list() of a "source target" edge list */
+    void ingest_edge_list(const std::string& filename) {
+      ingest_edge_list(filename, parse_edge_pair<EdgeData>);
+    }
+
+    /**
+     * Delivers the added edges, picks the master of every vertex and
+     * reports the replication factor and the edge balance. Must be
+     * called by all processes.
+     */
+    void finalize() {
+      ASSERT_FALSE(finalized);
+      const procid_t nprocs = dcontrol->numprocs();
+      for (procid_t p = 0; p < nprocs; ++p) {
+        if (edge_batches[p] != NULL) {
+          send_edge_batch(p, edge_batches[p]);
+          edge_batches[p] = NULL;
+        }
+      }
+      dcontrol->barrier();
+      master.resize(local2global_vid.size());
+      std::vector<std::vector<procid_t> > mirrors(local2global_vid.size());
+      mirror_lists = &mirrors;
+
+      // tell the directory of each replica, process v % numprocs for
+      // the vertex v, where it is
+      std::vector<std::vector<vertex_id_t> > replicas(nprocs);
+      foreach(vertex_id_t v, local2global_vid) replicas[v % nprocs].push_back(v);
+      for (procid_t p = 0; p < nprocs; ++p) {
+        if (replicas[p].empty()) continue;
+        oarchive arc;
+        arc << replicas[p];
+        dcontrol->remote_call(p, graph_type::replica_handler,
+                              (void*)arc.data(), arc.size());
+      }
+      dcontrol->barrier();
+
+      // the directories pick the masters and send every replica its
+      // master, and every master its mirrors
+      std::vector<std::vector<vertex_id_t> > vertices(nprocs);
+      std::vector<std::vector<procid_t> > masters(nprocs);
+      std::vector<std::vector<procid_t> > mirror_counts(nprocs);
+      std::vector<std::vector<procid_t> > mirror_procs_out(nprocs);
+      typedef typename boost::unordered_map<vertex_id_t,
+        std::vector<procid_t> >::iterator directory_iterator;
+      for (directory_iterator it = directory.begin(); it != directory.end(); ++it) {
+        std::vector<procid_t>& procs = it->second;
+        std::sort(procs.begin(), procs.end());
+        const procid_t m = procs[it->first / nprocs % procs.size()];
+        foreach(procid_t p, procs) {
+          vertices[p].push_back(it->first);
+          masters[p].push_back(m);
+          mirror_counts[p].push_back(p == m ? procid_t(procs.size() - 1) : 0);
+          if (p != m) continue;
+          foreach(procid_t q, procs) {
+            if (q != m) mirror_procs_out[p].push_back(q);
+          }
+        }
+      }
+      directory.clear();
+      for (procid_t p = 0; p < nprocs; ++p) {
+        if (vertices[p].empty()) continue;
+        oarchive arc;
+        arc << vertices[p] << masters[p] << mirror_counts[p] << mirror_procs_out[p];
+        dcontrol->remote_call(p, graph_type::master_handler,
+                              (void*)arc.data(), arc.size());
+      }
+      dcontrol->barrier();
+      mirror_lists = NULL;
+
+      mirror_offsets.assign(local2global_vid.size() + 1, 0);
+      mirror_procs.clear();
+      myvertices.clear();
+      for (vertex_id_t l = 0; l < local2global_vid.size(); ++l) {
+        mirror_offsets[l] = mirror_procs.size();
+        if (master[l] != myprocid) continue;
+        myvertices.push_back(local2global_vid[l]);
+        mirror_procs.insert(mirror_procs.end(), mirrors[l].begin(), mirrors[l].end());
+      }
+      mirror_offsets[local2global_vid.size()] = mirror_procs.size();
+      std::sort(myvertices.begin(), myvertices.end());
+      mgraph.finalize();
+      finalized = true;
+      report_balance();
+    }
+
+    // Structural Query Functions =============================================
+
+    /** The number of vertices over all processes */
+    size_t num_vertices() const {
+      return global_num_vertices;
+    }
+
+    /** The number of vertices with a replica on this process */
+    size_t num_local_vertices() const {
+      return mgraph.num_vertices();
+    }
+
+    /** The number of edges on this process */
+    size_t num_local_edges() const {
+      return mgraph.num_edges();
+    }
+
+    /** The vertices this process is the master of, sorted */
+    const std::vector<vertex_id_t>& my_vertices() const {
+      return myvertices;
+    }
+
+    /** Whether this process holds a replica of the vertex v */
+    bool has_replica(vertex_id_t v) const {
+      return global2local_vid.count(v) > 0;
+    }
+
+    /** The master of the vertex v, which must have a local replica */
+    procid_t master_of(vertex_id_t v) const {
+      return master[local_vid(v)];
+    }
+
+    /** The number of replicas of the vertex v this process is master of */
+    size_t num_replicas(vertex_id_t v) const {
+      const vertex_id_t l = local_vid(v);
+      ASSERT_EQ(master[l], myprocid);
+      return mirror_offsets[l + 1] - mirror_offsets[l] + 1;
+    }
+
+    /** get the source of the local edge */
+    vertex_id_t source(edge_id_t edge_id) const {
+      return local2global_vid[mgraph.source(local_eid(edge_id))];
+    }
+
+    /** get the dest of the local edge */
+    vertex_id_t target(edge_id_t edge_id) const {
+      return local2global_vid[mgraph.target(local_eid(edge_id))];
+    }
+
+    /** Replicas per vertex, over all processes. Set by finalize() */
+    double replication_factor() const {
+      return replication;
+    }
+
+    /** The most edges on a process over the mean. Set by finalize() */
+    double edge_imbalance() const {
+      return imbalance;
+    }
+
+    // Data Functions =========================================================
+
+    /** Get the vertex data of a local replica */
+    VertexData& vertex_data(vertex_id_t v) {
+      return mgraph.vertex_data(local_vid(v));
+    }
+
+    /** Get the vertex data of a local replica */
+    const VertexData& vertex_data(vertex_id_t v) const {
+      return mgraph.vertex_data(local_vid(v));
+    }
+
+    /** Get the edge data of a local edge */
+    EdgeData& edge_data(edge_id_t edge_id) {
+      return mgraph.edge_data(local_eid(edge_id));
+    }
+
+    /** Get the edge data of a local edge */
+    const EdgeData& edge_data(edge_id_t edge_id) const {
+      return mgraph.edge_data(local_eid(edge_id));
+    }
+
+    // Computation ============================================================
+
+    /**
+     * Runs one gather, apply and scatter step on every vertex. Each
+     * replica of the vertex v calls gather(graph, v, e, acc) for each
+     * local edge e into or out of v, on an Accum which starts default
+     * constructed. The partial results of the mirrors are sent to the
+     * master and added to its own with +=, and the master calls
+     * apply(graph, v, acc) to update the data of v, which is then sent
+     * to the mirrors. A default constructed Accum must be the identity
+     * of +=, and Accum must be serializable. apply() may only read the
+     * data of v. Must be called by all processes.
+     */
+    template <typename Accum, typename GatherFunction, typename ApplyFunction>
+    void gather_apply_scatter(GatherFunction gather, ApplyFunction apply) {
+      ASSERT_TRUE(finalized);
+      const procid_t nprocs = dcontrol->numprocs();
+      std::vector<Accum> accumulators(mgraph.num_vertices());
+      // the partial results from the mirrors of the vertices mastered here
+      std::vector<Accum> received(mgraph.num_vertices());
+      gather_accumulators = &received;
+      for (vertex_id_t l = 0; l < mgraph.num_vertices(); ++l) {
+        const vertex_id_t v = local2global_vid[l];
+        foreach(edge_id_t e, mgraph.in_edge_ids(l)) {
+          gather(*this, v, global_eid(e), accumulators[l]);
+        }
+        foreach(edge_id_t e, mgraph.out_edge_ids(l)) {
+          gather(*this, v, global_eid(e), accumulators[l]);
+        }
+      }
+
+      // send the partial results of the mirrors to the masters
+      std::vector<std::vector<vertex_id_t> > batches(nprocs);
+      for (vertex_id_t l = 0; l < mgraph.num_vertices(); ++l) {
+        if (master[l] != myprocid) batches[master[l]].push_back(l);
+      }
+      // every process must be ready to receive before any sends
+      dcontrol->mpi_barrier();
+      for (procid_t p = 0; p < nprocs; ++p) {
+        if (batches[p].empty()) continue;
+        oarchive arc(integer_encoding::VARINT);
+        write_vertex_ids(arc, batches[p]);
+        foreach(vertex_id_t l, batches[p]) arc << accumulators[l];
+        dcontrol->remote_call(p, graph_type::template gather_handler<Accum>,
+                              (void*)arc.data(), arc.size());
+      }
+      dcontrol->barrier();
+      gather_accumulators = NULL;
+
+      foreach(vertex_id_t v, myvertices) {
+        const vertex_id_t l = local_vid(v);
+        accumulators[l] += received[l];
+        apply(*this, v, accumulators[l]);
+      }
+      sync_vertices();
+    }
+
+    /**
+     * Sends the data of every vertex this process is master of to its
+     * mirrors and waits until all processes have done so. Must be
+     * called by all processes.
+     */
+    void sync_vertices() {
+      const procid_t nprocs = dcontrol->numprocs();
+      std::vector<std::vector<vertex_id_t> > batches(nprocs);
+      foreach(vertex_id_t v, myvertices) {
+        const vertex_id_t l = local_vid(v);
+        for (size_t i = mirror_offsets[l]; i < mirror_offsets[l + 1]; ++i) {
+          batches[mirror_procs[i]].push_back(l);
+        }
+      }
+      for (procid_t p = 0; p < nprocs; ++p) {
+        if (batches[p].empty()) continue;
+        oarchive arc(integer_encoding::VARINT);
+        write_vertex_ids(arc, batches[p]);
+        foreach(vertex_id_t l, batches[p]) arc << mgraph.vertex_data(l);
+        dcontrol->remote_call(p, graph_type::scatter_handler,
+                              (void*)arc.data(), arc.size());
+      }
+      dcontrol->barrier();
+    }
+
+  private:
+
+    /// bytes of edges buffered for a process before they are sent
+    static const size_t EDGE_BATCH_BYTES = 65536;
+
+    graph<VertexData, EdgeData> mgraph;
+    distributed_control* dcontrol;
+    procid_t myprocid;
+    vertexcut_partition::vertexcut_partition_enum method;
+    bool finalized;
+
+    /// the local graph holds a replica of every endpoint of its edges
+    std::vector<vertex_id_t> local2global_vid;
+    boost::unordered_map<vertex_id_t, vertex_id_t> global2local_vid;
+    /// the master of each local vertex
+    std::vector<procid_t> master;
+    std::vector<vertex_id_t> myvertices;
+    /// mirror_procs[mirror_offsets[l] .. mirror_offsets[l+1]) are the
+    /// mirrors of the local vertex l this process is master of
+    std::vector<size_t> mirror_offsets;
+    std::vector<procid_t> mirror_procs;
+
+    size_t global_num_vertices;
+    double replication;
+    double imbalance;
+
+    /// construction state
+    mutex graph_lock;
+    spinlock batch_lock;
+    std::vector<oarchive*> edge_batches;
+    /// the processes holding each vertex v with v % numprocs == procid
+    boost::unordered_map<vertex_id_t, std::vector<procid_t> > directory;
+    std::vector<std::vector<procid_t> >* mirror_lists;
+
+    /// std::vector<Accum> of the partial results received by the
+    /// running gather_apply_scatter()
+    void* gather_accumulators;
+
+    vertex_id_t local_vid(vertex_id_t v) const {
+      typename boost::unordered_map<vertex_id_t, vertex_id_t>::const_iterator
+        it = global2local_vid.find(v);
+      ASSERT_MSG(it != global2local_vid.end(),
+                 "Vertex %u has no replica on process %d", v, (int)myprocid);
+      return it->second;
+    }
+
+    edge_id_t local_eid(edge_id_t e) const {
+      DASSERT_TRUE(e % dcontrol->numprocs() == myprocid);
+      return e / dcontrol->numprocs();
+    }
+
+    edge_id_t global_eid(edge_id_t l) const {
+      return l * dcontrol->numprocs() + myprocid;
+    }
+
+    /** The local id of v, adding a replica the first time */
+    vertex_id_t add_replica(vertex_id_t v) {
+      std::pair<typename boost::unordered_map<vertex_id_t, vertex_id_t>::iterator, bool>
+        ins = global2local_vid.insert(std::make_pair(v, vertex_id_t(mgraph.num_vertices())));
+      if (ins.second) {
+        mgraph.add_vertex();
+        local2global_vid.push_back(v);
+      }
+      return ins.first->second;
+    }
+
+    void send_edge_batch(procid_t p, oarchive* arc) {
+      dcontrol->remote_call(p, graph_type::edge_batch_handler,
+                            (void*)arc->data(), arc->size());
+      delete arc;
+    }
+
+    /**
+     * Writes the global ids of the sorted local vertices as varint
+     * gaps, preceded by their number
+     */
+    void write_vertex_ids(oarchive& arc, std::vector<vertex_id_t>& locals) const {
+      std::vector<vertex_id_t> ids(locals.size());
+      for (size_t i = 0; i < locals.size(); ++i) ids[i] = local2global_vid[locals[i]];
+      // sort the local ids along with the global ones
+      std::vector<std::pair<vertex_id_t, vertex_id_t> > order(locals.size());
+      for (size_t i = 0; i < locals.size(); ++i) order[i] = std::make_pair(ids[i], locals[i]);
+      std::sort(order.begin(), order.end());
+      arc << locals.size();
+      vertex_id_t prev = 0;
+      for (size_t i = 0; i < order.size(); ++i) {
+        arc << size_t(order[i].first - prev);
+        prev = order[i].first;
+        locals[i] = order[i].second;
+      }
+    }
+
+    /** Reads the ids written by write_vertex_ids() as local ids */
+    static void read_vertex_ids(iarchive& arc, std::vector<vertex_id_t>& locals) {
+      size_t n;
+      arc >> n;
+      locals.resize(n);
+      vertex_id_t v = 0;
+      for (size_t i = 0; i < n; ++i) {
+        size_t gap;
+        arc >> gap;
+        v += vertex_id_t(gap);
+        locals[i] = receive_target->local_vid(v);
+      }
+    }
+
+    /** Computes and logs the replication factor and edge balance */
+    void report_balance() {
+      const procid_t nprocs = dcontrol->numprocs();
+      // the edges of each process, then the replicas and the masters
+      std::vector<size_t> counts(nprocs + 2, 0);
+      counts[myprocid] = mgraph.num_edges();
+      counts[nprocs] = mgraph.num_vertices();
+      counts[nprocs + 1] = myvertices.size();
+      dcontrol->mpi_allreduce_sum(counts);
+      global_num_vertices = counts[nprocs + 1];
+      replication = double(counts[nprocs]) / std::max(size_t(1), counts[nprocs + 1]);
+      size_t total = 0, most = 0;
+      for (procid_t p = 0; p < nprocs; ++p) {
+        total += counts[p];
+        most = std::max(most, counts[p]);
+      }
+      imbalance = total == 0 ? 1.0 : double(most) * nprocs / total;
+      if (myprocid == 0) {
+        logger(LOG_INFO, "Vertex cut of %lu vertices and %lu edges: "
+               "replication factor %f, edge imbalance %f (%lu edges at most)",
+               (unsigned long)global_num_vertices, (unsigned long)total,
+               replication, imbalance, (unsigned long)most);
+      }
+    }
+
+    /** Adds edges placed on this process */
+    static void edge_batch_handler(distributed_control& dc, size_t source,
+                                   void* ptr, size_t len) {
+      graph_type& g = *receive_target;
+      iarchive arc((const char*)ptr, len);
+      vertex_id_t s, t;
+      EdgeData edata;
+      g.graph_lock.lock();
+      while (arc.remaining() > 0) {
+        arc >> s >> t >> edata;
+        g.mgraph.add_edge(g.add_replica(s), g.add_replica(t), edata);
+      }
+      g.graph_lock.unlock();
+    }
+
+    /** Records the replicas of vertices this process is directory of */
+    static void replica_handler(distributed_control& dc, size_t source,
+                                void* ptr, size_t len) {
+      graph_type& g = *receive_target;
+      iarchive arc((const char*)ptr, len);
+      std::vector<vertex_id_t> vertices;
+      arc >> vertices;
+      g.graph_lock.lock();
+      foreach(vertex_id_t v, vertices) g.directory[v].push_back(procid_t(source));
+      g.graph_lock.unlock();
+    }
+
+    /** Receives the masters of local vertices and the mirrors of masters */
+    static void master_handler(distributed_control& dc, size_t source,
+                               void* ptr, size_t len) {
+      graph_type& g = *receive_target;
+      iarchive arc((const char*)ptr, len);
+      std::vector<vertex_id_t> vertices;
+      std::vector<procid_t> masters, counts, mirrors;
+      arc >> vertices >> masters >> counts >> mirrors;
+      g.graph_lock.lock();
+      size_t next = 0;
+      for (size_t i = 0; i < vertices.size(); ++i) {
+        const vertex_id_t l = g.local_vid(vertices[i]);
+        g.master[l] = masters[i];
+        (*g.mirror_lists)[l].assign(mirrors.begin() + next,
+                                    mirrors.begin() + next + counts[i]);
+        next += counts[i];
+      }
+      g.graph_lock.unlock();
+    }
+
+    /** Adds the partial results of mirrors to those of the master */
+    template <typename Accum>
+    static void gather_handler(distributed_control& dc, size_t source,
+                               void* ptr, size_t len) {
+      graph_type& g = *receive_target;
+      std::vector<Accum>& accumulators =
+        *reinterpret_cast<std::vector<Accum>*>(g.gather_accumulators);
+      iarchive arc((const char*)ptr, len, integer_encoding::VARINT);
+      std::vector<vertex_id_t> locals;
+      read_vertex_ids(arc, locals);
+      Accum acc;
+      g.graph_lock.lock();
+      foreach(vertex_id_t l, locals) {
+        arc >> acc;
+        accumulators[l] += acc;
+      }
+      g.graph_lock.unlock();
+    }
+
+    /** Receives the data of vertices from their masters */
+    static void scatter_handler(distributed_control& dc, size_t source,
+                                void* ptr, size_t len) {
+      graph_type& g = *receive_target;
+      iarchive arc((const char*)ptr, len, integer_encoding::VARINT);
+      std::vector<vertex_id_t> locals;
+      read_vertex_ids(arc, locals);
+      foreach(vertex_id_t l, locals) arc >> g.mgraph.vertex_data(l);
+    }
+
+    // Not copyable
+    distributed_vertexcut_graph(const distributed_vertexcut_graph&);
+    distributed_vertexcut_graph& operator=(const distributed_vertexcut_graph&);
+  }; // End of graph
+
+  template<typename VertexData, typename EdgeData>
+  distributed_vertexcut_graph<VertexData, EdgeData>*
+  distributed_vertexcut_graph<VertexData, EdgeData>::receive_target = NULL;
+
+} // end of namespace graphlab
+
+#include <graphlab/macros_undef.hpp>
+
+#endif
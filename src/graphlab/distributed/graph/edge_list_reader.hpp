@@ -0,0 +1,67 @@
+#ifndef DISTRIBUTED_EDGE_LIST_READER_HPP
+#define DISTRIBUTED_EDGE_LIST_READER_HPP
+#include <string>
+#include <fstream>
+#include <cstdlib>
+
+#include <graphlab/logger/logger.hpp>
+#include <graphlab/graph/graph.hpp>
+
+namespace graphlab {
+
+  /**
+   * Reads "source target" edge list lines. Returns false for lines
+   * which do not start with two vertex ids, such as comments.
+   */
+  template <typename EdgeData>
+  bool parse_edge_pair(const std::string& line, vertex_id_t& source,
+                       vertex_id_t& target, EdgeData& edata) {
+    const char* str = line.c_str();
+    char* end;
+    source = vertex_id_t(strtoul(str, &end, 10));
+    if (end == str) return false;
+    str = end;
+    target = vertex_id_t(strtoul(str, &end, 10));
+    return end != str;
+  }
+
+
+  /**
+   * Reads the lines of a text file which start in the part'th of
+   * nparts equal byte ranges, so that nparts processes together read
+   * every line once without coordinating.
+   */
+  class edge_list_reader {
+  public:
+    edge_list_reader(const std::string& filename, size_t part, size_t nparts) :
+      fin(filename.c_str(), std::ios::binary) {
+      ASSERT_MSG(fin.good(), "Could not open %s", filename.c_str());
+      fin.seekg(0, std::ios::end);
+      const size_t filesize = fin.tellg();
+      pos = filesize * part / nparts;
+      end = filesize * (part + 1) / nparts;
+      // the line running into the range belongs to the previous part
+      fin.seekg(pos > 0 ? pos - 1 : 0);
+      if (pos > 0 && fin.get() != '\n') {
+        std::string line;
+        std::getline(fin, line);
+        pos += line.size() + 1;
+      }
+    }
+
+    /** Reads the next line of the range. Returns false at its end */
+    bool next_line(std::string& line) {
+      if (pos >= end || !std::getline(fin, line)) return false;
+      pos += line.size() + 1;
+      return true;
+    }
+
+  private:
+    std::ifstream fin;
+    size_t pos;
+    size_t end;
+  };
+
+} // end of namespace graphlab
+
+#endif
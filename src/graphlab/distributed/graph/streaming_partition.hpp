@@ -0,0 +1,130 @@
+#ifndef DISTRIBUTED_STREAMING_PARTITION_HPP
+#define DISTRIBUTED_STREAMING_PARTITION_HPP
+#include <vector>
+#include <limits>
+#include <cmath>
+
+#include <graphlab/graph/graph.hpp>
+#include <graphlab/distributed/distributed_control_types.hpp>
+
+namespace graphlab {
+
+  /**
+   * \brief the streaming vertex placement methods.
+   *
+   * Used by distributed_graph::ingest_edge_list() to choose the owner
+   * of each vertex the first time it is read, without seeing the rest
+   * of the graph.
+   *
+   * <ul>
+   *
+   *   <li> HASH: The owner is a hash of the vertex id. Needs no
+   *   communication to place or to look up a vertex. </li>
+   *
+   *   <li> GREEDY: The process owning the most of the neighbors
+   *   placed so far, among the processes below capacity. </li>
+   *
+   *   <li> LDG: Linear deterministic greedy. The neighbor count of
+   *   each process is weighted by 1 - load / capacity. </li>
+   *
+   * </ul>
+   */
+  struct streaming_partition {
+
+    enum streaming_partition_enum {
+      HASH,
+      GREEDY,
+      LDG,
+    };
+
+    /** The owner of v under HASH */
+    static procid_t hash_owner(vertex_id_t v, size_t numprocs) {
+      // multiplicative hashing spreads runs of consecutive ids
+      return procid_t(((uint64_t(v) * 0x9E3779B97F4A7C15ULL) >> 32) % numprocs);
+    }
+
+    /**
+     * Places a vertex under GREEDY or LDG. neighbors[p] is the number
+     * of its neighbors owned by process p and loads[p] the number of
+     * vertices p owns. Ties, such as a vertex with no placed
+     * neighbors, go to the least loaded process.
+     */
+    static procid_t place(streaming_partition_enum method,
+                          const std::vector<size_t>& neighbors,
+                          const std::vector<size_t>& loads,
+                          double capacity) {
+      procid_t best = 0;
+      double bestscore = -std::numeric_limits<double>::max();
+      for (procid_t p = 0; p < loads.size(); ++p) {
+        double score = double(neighbors[p]);
+        if (method == LDG) {
+          score *= 1.0 - double(loads[p]) / capacity;
+        }
+        else if (loads[p] >= capacity) {
+          score = -1;
+        }
+        if (score > bestscore ||
+            (score == bestscore && loads[p] < loads[best])) {
+          best = p;
+          bestscore = score;
+        }
+      }
+      return best;
+    }
+  };
+
+
+  /**
+   * \brief the edge placement methods of distributed_vertexcut_graph.
+   *
+   * <ul>
+   *
+   *   <li> RANDOM: The owner is a hash of the edge. A vertex of degree
+   *   d has min(d, numprocs) replicas in expectation. </li>
+   *
+   *   <li> GRID: The processes form a grid of rows x cols and each
+   *   vertex hashes to a cell. An edge is placed on the cell in the
+   *   row of one endpoint and the column of the other, so a vertex has
+   *   at most rows + cols - 1 replicas. </li>
+   *
+   * </ul>
+   */
+  struct vertexcut_partition {
+
+    enum vertexcut_partition_enum {
+      RANDOM,
+      GRID,
+    };
+
+    /** The process which owns the edge from source to target */
+    static procid_t edge_owner(vertexcut_partition_enum method,
+                               vertex_id_t source, vertex_id_t target,
+                               size_t numprocs) {
+      const uint64_t edgehash = mix((uint64_t(source) << 32) | target);
+      if (method == RANDOM) return procid_t(edgehash % numprocs);
+      // the most square grid, down to a single row for a prime count
+      size_t rows = size_t(std::sqrt(double(numprocs)));
+      while (numprocs % rows != 0) --rows;
+      const size_t cols = numprocs / rows;
+      const size_t sourcecell = mix(source) % numprocs;
+      const size_t targetcell = mix(target) % numprocs;
+      if (edgehash & 1) {
+        return procid_t((sourcecell / cols) * cols + targetcell % cols);
+      }
+      return procid_t((targetcell / cols) * cols + sourcecell % cols);
+    }
+
+  private:
+    static uint64_t mix(uint64_t x) {
+      x ^= x >> 33;
+      x *= 0xff51afd7ed558ccdULL;
+      x ^= x >> 33;
+      x *= 0xc4ceb9fe1a85ec53ULL;
+      x ^= x >> 33;
+      return x;
+    }
+  };
+
+} // end of namespace graphlab
+
+#endif
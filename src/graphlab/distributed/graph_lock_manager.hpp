@@ -871,8 +871,8 @@ class graph_lock_manager{
     }
     // fill the lock requests
     // loop over all the in and out neighbors
-    const std::vector<edge_id_t> &inedges =  graph.in_edge_ids(vertex);
-    const std::vector<edge_id_t> &outedges = graph.out_edge_ids(vertex);
+    edge_list inedges =  graph.in_edge_ids(vertex);
+    edge_list outedges = graph.out_edge_ids(vertex);
     // type of lock to use for neighbors
     lock_type nbrlocktype = RDLOCK;
     lock_type vtxlocktype = WRLOCK;
@@ -186,10 +186,11 @@ namespace graphlab {
       * Pushes all changes to neighboring partitions.
       * Unfortunately currently we do not track changes,
       * so all changes must be sent...
+      * The vertex is sent in a batch with other changed vertices.
       */
      void push_changes(iscope_type *scope) { 
      	// Replicate the vertex 
-     	_distgraph.update_vertex(scope->vertex());
+     	_distgraph.mark_ghost_dirty(scope->vertex());
      	
      	// Replicate remote edges. Distribute graph
      	// takes care that edge is update to proper owner.
@@ -359,6 +360,8 @@ namespace graphlab {
       /* Wait for all threads to return */
       logger(LOG_INFO, "Wait until finished...");
       threads.join();
+      // send the vertices changed since the last batch
+      _distgraph.sync_ghosts();
      
       double running_time = _timer->current_time();
       logstream(LOG_INFO) << "Running time: " << running_time << std::endl;
@@ -8,11 +8,14 @@
 
 #include <graphlab/parallel/pthread_tools.hpp>
 #include <graphlab/parallel/atomic.hpp>
+#include <graphlab/parallel/numa.hpp>
 #include <graphlab/util/timer.hpp>
 
 #include <graphlab/graph/graph.hpp>
 #include <graphlab/scope/iscope.hpp>
 #include <graphlab/engine/iengine.hpp>
+#include <graphlab/engine/idle_policy.hpp>
+#include <graphlab/engine/worker_stats.hpp>
 #include <graphlab/tasks/update_task.hpp>
 #include <graphlab/logger/logger.hpp>
 #include <graphlab/monitoring/imonitor.hpp>
@@ -59,6 +62,9 @@ namespace graphlab {
           // If this was nothing to execute then fail
           if (!executed_task) break;
         }   
+        engine->idle.finish(workerid);
+        // Release the workers which are still parked
+        engine->idle.wake_all();
         // // Do any remaining syncs if any
         if(engine->shared_data != NULL)
           engine->shared_data->signal_all();
@@ -81,6 +87,12 @@ namespace graphlab {
 
     /** Use processor affinities */
     bool use_cpu_affinity;
+
+    /** Pin workers and place the graph by NUMA node */
+    bool use_numa;
+
+    /** The NUMA nodes of this machine */
+    numa_topology numa;
     
     /** Responsible for managing the update of scopes */
     ScopeFactory scope_manager;
@@ -88,8 +100,9 @@ namespace graphlab {
     /** Responsible for maintaining the schedule over tasks */
     Scheduler scheduler;
 
-    /** Track the number of updates */
-    std::vector<size_t> update_counts;
+    /** Track the number of updates and where the workers spend
+        their time */
+    worker_stats_array stats;
 
     /** The monitor which tracks and records engine events */
     imonitor_type* monitor;
@@ -117,6 +130,9 @@ namespace graphlab {
 
     /** The cause of the last termination condition */
     exec_status termination_reason;
+
+    /** Decides whether workers without a task spin or sleep */
+    idle_policy idle;
     
   public:
 
@@ -133,16 +149,20 @@ namespace graphlab {
       ncpus( std::max(ncpus, size_t(1)) ),
       exec_type(exec_type),
       use_cpu_affinity(false),
+      use_numa(false),
       scope_manager(graph, std::max(ncpus, size_t(1) ) ),
       scheduler(this, graph, std::max(ncpus, size_t(1)) ),
-      update_counts(std::max(ncpus, size_t(1)), 0),
+      stats(std::max(ncpus, size_t(1))),
       monitor(NULL),
       shared_data(NULL),
       start_time_millis(lowres_time_millis()),
       timeout_millis(0),
       last_check_millis(0),
       task_budget(0),
-      active(false) { }
+      active(false),
+      idle(std::max(ncpus, size_t(1))) {
+      scheduler.register_idle_policy(&idle);
+    }
 
 
     //! Get the number of cpus
@@ -181,9 +201,11 @@ namespace graphlab {
 		 * 2) Reset engine fields
 		 */
 		// Prepare the graph
-		graph.finalize();      
+		graph.finalize(ncpus);
+		// Move the vertex blocks to the nodes of their workers
+		if(use_numa) graph.place_numa(numa);
 		// Clear the update counts
-		std::fill(update_counts.begin(), update_counts.end(), 0);
+		stats.reset();
 		// Reset timers
 		start_time_millis = lowres_time_millis();
 		last_check_millis = 0;
@@ -193,6 +215,8 @@ namespace graphlab {
 		termination_reason = EXEC_TASK_DEPLETION;
 		// Ensure that the data manager has the correct scope_factory
 		if(shared_data != NULL) shared_data->set_scope_factory(&scope_manager);
+		// Clear the idle statistics of the last run
+		idle.reset();
 		// Start any scheduler threads (if necessary)
 
 		//start time for updates!
@@ -206,6 +230,7 @@ namespace graphlab {
 		 */
 		if(exec_type == THREADED) run_threaded();
 		else run_simulated();
+		idle.print_stats();
 
 		/**
 		 * Run any necessary cleanup
@@ -223,6 +248,7 @@ namespace graphlab {
     void stop() {
       termination_reason = EXEC_FORCED_ABORT;
       active = false;
+      idle.wake_all();
     }
     
 
@@ -242,13 +268,14 @@ namespace graphlab {
      * conservative estimate.
      */
     size_t last_update_count() const {
-      size_t sum = 0;
-      for(size_t i = 0; i < update_counts.size(); ++i)
-        sum += update_counts[i];
-      return sum;
+      return stats.total_updates();
     } // end of last_update_count
 
 
+    /** The per worker counters of the current (or last) run */
+    worker_stats_array* worker_statistics() { return &stats; }
+
+
 
     /**
      * Register a monitor with this engine.  Currently this engine
@@ -291,6 +318,32 @@ namespace graphlab {
     virtual void set_task_budget(size_t max_tasks) {
       task_budget = max_tasks;
     }
+
+    /**
+     * Number of times a worker polls an empty scheduler before it
+     * parks.  Zero never parks.
+     */
+    void set_idle_spins(size_t spins) {
+      idle.set_spin_limit(spins);
+    }
+
+    /**
+     * Pin the workers by NUMA node, place the graph data on the node
+     * of its vertices and let the scheduler prefer local tasks.
+     */
+    void set_numa(bool enable) {
+      use_numa = enable;
+      scheduler.register_numa_topology(use_numa ? &numa : NULL);
+      if(use_numa) numa.print();
+    }
+
+    /**
+     * The spinning and parked time of worker cpuid during the last
+     * run
+     */
+    const idle_policy::worker_stats& idle_stats(size_t cpuid) const {
+      return idle.get_stats(cpuid);
+    }
     
 
 
@@ -309,7 +362,8 @@ namespace graphlab {
         // Start the worker thread using the thread group with cpu
         // affinity attached (CPU affinity currently only supported in
         // linux) since Mac affinity is set through the NX frameworks
-        if(use_cpu_affinity) threads.launch(&(workers[i]), i);
+        if(use_numa) threads.launch(&(workers[i]), numa.worker_cpu(i, ncpus));
+        else if(use_cpu_affinity) threads.launch(&(workers[i]), i);
         else threads.launch(&(workers[i]));        
       }
       threads.join();
@@ -395,9 +449,12 @@ namespace graphlab {
           // Check all termination conditions
           if(satisfies_termination_condition()) {
             active = false;
+            idle.wake_all();
             return false;
           }
         }
+        // Join a parallel sync started by another worker
+        if(shared_data != NULL) shared_data->help_syncs();
         
         /**
          * Get and execute the next task from the scheduler.
@@ -406,12 +463,24 @@ namespace graphlab {
         sched_status::status_enum stat = scheduler.get_next_task(cpuid, task);
         switch(stat) {
         case sched_status::WAITING :
-          sched_yield();
+          // A simulated worker must not sleep, the next poll may be
+          // on behalf of another cpu
+          if(exec_type == THREADED) idle.idle(cpuid);
+          else sched_yield();
           break;
         case sched_status::COMPLETE :          
+          idle.wake_all();
           return false;
           break;
         case sched_status::NEWTASK :
+          idle.busy(cpuid);
+          worker_stats& wstats = stats[cpuid];
+          const bool timing = stats.timing_enabled();
+          uint64_t time_start = 0, time_scope = 0, time_update = 0;
+          if(timing) {
+            time_start = worker_stats_array::now_ns();
+            wstats.wait_ns += time_start - wstats.wait_start_ns;
+          }
           // If the status is new task than we must execute the task
           const vertex_id_t vertex = task.vertex();
 			//std::cout<<"add vertex id="<<vertex<<"to upate==========================="<<std::endl;
@@ -421,11 +490,17 @@ namespace graphlab {
           // to take it build a scope
           iscope_type* scope = scope_manager.get_scope(cpuid, vertex);          
           assert(scope != NULL);                    
+          if(timing) {
+            time_scope = worker_stats_array::now_ns();
+            wstats.work += scope->in_edge_ids().size() + 
+              scope->out_edge_ids().size();
+          }
           // get the callback for this cpu
           typename Scheduler::callback_type& scallback =
             scheduler.get_callback(cpuid);        
           // execute the task
           task.function()(*scope, scallback, shared_data);
+          if(timing) time_update = worker_stats_array::now_ns();
           // Commit any changes to the scope
           scope->commit();
           // Release the scope
@@ -433,7 +508,13 @@ namespace graphlab {
           // Mark the task as completed in the scheduler
           scheduler.completed_task(cpuid, task);
           // record the successful execution of the task
-          update_counts[cpuid]++;
+          wstats.updates++;
+          if(timing) {
+            const uint64_t time_end = worker_stats_array::now_ns();
+            wstats.scope_ns += (time_scope - time_start) + (time_end - time_update);
+            wstats.update_ns += time_update - time_scope;
+            wstats.wait_start_ns = time_end;
+          }
           return true;
           break;
         } // end of switch
@@ -0,0 +1,516 @@
+#ifndef GRAPHLAB_CHROMATIC_ENGINE_HPP
+#define GRAPHLAB_CHROMATIC_ENGINE_HPP
+
+#include <cassert>
+#include <vector>
+#include <algorithm>
+
+
+#include <graphlab/graph/graph.hpp>
+#include <graphlab/scope/iscope.hpp>
+#include <graphlab/scope/general_scope_factory.hpp>
+#include <graphlab/schedulers/ischeduler.hpp>
+#include <graphlab/schedulers/support/binary_scheduler_callback.hpp>
+#include <graphlab/schedulers/support/vertex_frontier.hpp>
+#include <graphlab/engine/iengine.hpp>
+#include <graphlab/engine/worker_stats.hpp>
+#include <graphlab/tasks/update_task.hpp>
+#include <graphlab/logger/logger.hpp>
+#include <graphlab/parallel/pthread_tools.hpp>
+#include <graphlab/util/timer.hpp>
+
+#include <graphlab/shared_data/ishared_data.hpp>
+#include <graphlab/shared_data/ishared_data_manager.hpp>
+#include <graphlab/monitoring/imonitor.hpp>
+
+#include <graphlab/macros_def.hpp>
+namespace graphlab {
+
+  /**
+   * This class defines a chromatic engine which runs the scheduled
+   * vertices one color of the graph coloring at a time.
+   *
+   * Each sweep goes through the colors in order.  The scheduled
+   * vertices of a color are split into one contiguous block per
+   * worker, and the workers wait at a barrier before moving on to the
+   * next color.  No two vertices of a color are neighbors so the
+   * update functions run on scopes which take no locks at all:
+   *
+   * <ul>
+   *   <li> edge (and read) consistency needs a coloring in which
+   *   neighbors differ, see graph::compute_coloring(). </li>
+   *   <li> full consistency needs a distance-2 coloring, see
+   *   graph::compute_distance2_coloring(). </li>
+   *   <li> vertex and null consistency hold for any coloring. </li>
+   * </ul>
+   *
+   * If the colors of the graph do not satisfy the default scope when
+   * the engine starts the graph is colored again.
+   *
+   * Tasks added by update functions run in the next sweep, and the
+   * engine stops when a sweep schedules nothing, after the maximum
+   * number of sweeps (the MAX_ITERATIONS option of the scheduler), or
+   * on a timeout, task budget or termination function, which are
+   * checked between sweeps.  Like the colored scheduler the engine
+   * runs a single update function, that of the last task added.
+   **/
+  template<typename Graph>
+  class chromatic_engine :
+    public iengine<Graph> {
+
+  public:
+    typedef iengine<Graph> base;
+    typedef typename base::update_task_type update_task_type;
+    typedef typename base::update_function_type update_function_type;
+    typedef typename base::ischeduler_type ischeduler_type;
+    typedef typename base::imonitor_type imonitor_type;
+    typedef typename base::termination_function_type termination_function_type;
+    typedef typename base::iscope_type iscope_type;
+    typedef typename base::ishared_data_type ishared_data_type;
+    typedef typename base::ishared_data_manager_type ishared_data_manager_type;
+
+    typedef general_scope_factory<Graph> scope_factory_type;
+    typedef binary_scheduler_callback<Graph> binary_callback_type;
+
+  private:
+
+    /**
+     * The scheduler returned by get_scheduler().  It only records the
+     * vertices which have a task and the update function; the engine
+     * decides the order.
+     */
+    class chromatic_task_set : public ischeduler<Graph> {
+    public:
+      typedef ischeduler<Graph> sched_base;
+      typedef typename sched_base::callback_type callback_type;
+
+      chromatic_task_set(chromatic_engine* engine) : engine(engine) { }
+
+      void add_task(update_task_type task, double priority) {
+        engine->schedule(task.vertex(), task.function());
+      }
+
+      void add_tasks(const std::vector<vertex_id_t>& vertices,
+                     update_function_type func, double priority) {
+        foreach(vertex_id_t vertex, vertices) engine->schedule(vertex, func);
+      }
+
+      void add_task_to_all(update_function_type func, double priority) {
+        engine->schedule_all(func);
+      }
+
+      callback_type& get_callback(size_t cpuid) {
+        return engine->callback;
+      }
+
+      /** The engine runs the tasks itself */
+      sched_status::status_enum get_next_task(size_t cpuid,
+                                              update_task_type& ret_task) {
+        return sched_status::COMPLETE;
+      }
+
+      void completed_task(size_t cpuid, const update_task_type& task) { }
+
+      void set_option(scheduler_options::options_enum opt, void* value) {
+        if(opt == scheduler_options::UPDATE_FUNCTION) {
+          engine->set_update_function((update_function_type)value);
+        } else if(opt == scheduler_options::MAX_ITERATIONS) {
+          engine->set_max_sweeps((size_t)value);
+        } else {
+          logger(LOG_WARNING,
+                 "Chromatic engine was passed an invalid option %d", opt);
+        }
+      }
+
+    private:
+      chromatic_engine* engine;
+    }; // end of chromatic task set
+
+
+    /** The internal worker thread class */
+    class chromatic_worker : public runnable {
+      chromatic_engine* engine;
+      size_t workerid;
+    public:
+      chromatic_worker() : engine(NULL), workerid(0) { }
+      void init(chromatic_engine* _engine, size_t _workerid) {
+        engine = _engine;
+        workerid = _workerid;
+      } // End of init
+      void run() {
+        assert(engine != NULL);
+        logger(LOG_INFO, "Worker %d started\n", workerid);
+        while(engine->sweep(workerid)) { }
+        // Record worker death with the listener
+        if (engine->listener != NULL)
+          engine->listener->
+            engine_worker_dies(workerid,
+                               engine->stats[workerid].updates);
+        logger(LOG_INFO, "Worker %d died\n", workerid);
+      }
+    }; // end of chromatic worker
+
+
+    /** The number of cpus to use */
+    size_t ncpus;
+    /** Per worker update counts and times */
+    worker_stats_array stats;
+
+    Graph& src;
+    update_function_type updatefunc;
+
+    /** Hands out the (unlocked) null scopes */
+    scope_factory_type scope_manager;
+    /** The consistency the coloring has to provide */
+    scope_range::scope_range_enum default_scope;
+
+    chromatic_task_set task_set;
+    binary_callback_type callback;
+
+    /** The vertices of each color */
+    std::vector< std::vector<vertex_id_t> > color_blocks;
+
+    vertex_frontier frontiers[2];
+    /** Vertices run in the current sweep */
+    vertex_frontier* active;
+    /** Vertices scheduled for the next sweep */
+    vertex_frontier* next;
+    /** True while the workers run, when new tasks go to next */
+    bool running;
+
+    barrier colorbarrier;
+    size_t nsweeps;
+    size_t max_sweeps;
+
+    timer _timer;
+    size_t timeout;
+    size_t taskbudget;
+    bool aborted;
+    bool finished;
+    exec_status termination_reason;
+
+    imonitor_type* listener;
+    ishared_data_manager_type* data_manager;
+    std::vector<termination_function_type> term_functions;
+
+  public:
+    /** Initialize the chromatic engine */
+    chromatic_engine(Graph& g, size_t num_cpus = thread::cpu_count()) :
+      ncpus(num_cpus),
+      stats(num_cpus),
+      src(g),
+      updatefunc(NULL),
+      scope_manager(g, num_cpus, scope_range::NULL_CONSISTENCY),
+      default_scope(scope_range::EDGE_CONSISTENCY),
+      task_set(this),
+      active(&frontiers[0]),
+      next(&frontiers[1]),
+      running(false),
+      colorbarrier(num_cpus),
+      nsweeps(0),
+      max_sweeps(-1),
+      timeout(0),
+      taskbudget(0),
+      aborted(false),
+      finished(false),
+      termination_reason(EXEC_TASK_DEPLETION),
+      listener(NULL),
+      data_manager(NULL) {
+      assert(num_cpus >= 1);
+      frontiers[0].resize(g.num_vertices(), 0);
+      frontiers[1].resize(g.num_vertices(), 0);
+    }
+
+    size_t get_ncpus() const { return ncpus; }
+
+    /** register the listener */
+    void register_monitor(imonitor_type* _listener) {
+      if(_listener == NULL) return;
+      this->listener = _listener;
+      listener->init(this);
+    }
+
+    /**
+     * Set the consistency the coloring must provide.  The scopes
+     * themselves never lock.
+     */
+    void set_default_scope(scope_range::scope_range_enum default_scope_range) {
+      default_scope = default_scope_range;
+      if(default_scope == scope_range::USE_DEFAULT)
+        default_scope = scope_range::EDGE_CONSISTENCY;
+    }
+
+    /**
+     * Timeout. Default - no timeout.
+     */
+    void set_timeout(size_t timeout_secs) {
+      timeout = timeout_secs;
+    }
+
+    /**
+     * Task budget - max number of tasks to allow
+     */
+    void set_task_budget(size_t max_tasks) {
+      taskbudget = max_tasks;
+    }
+
+    /** Stop after the given number of sweeps over the colors */
+    void set_max_sweeps(size_t sweeps) {
+      max_sweeps = sweeps;
+    }
+
+    void set_update_function(update_function_type u) {
+      if(updatefunc != NULL && u != updatefunc) {
+        logger(LOG_WARNING, "The chromatic engine runs a single update "
+               "function. Replacing the previous one.");
+      }
+      updatefunc = u;
+    }
+
+    /** get a reference to the scheduler */
+    ischeduler_type& get_scheduler() { return task_set; }
+
+    void set_shared_data_manager(ishared_data_manager_type* manager) {
+      data_manager = manager;
+      if(data_manager != NULL) {
+        data_manager->set_scope_factory(&scope_manager);
+      }
+    }
+
+    void add_terminator(termination_function_type term) {
+      term_functions.push_back(term);
+    }
+
+    void clear_terminators() {
+      term_functions.clear();
+    }
+
+    /** Stop at the end of the current sweep */
+    void stop() {
+      aborted = true;
+    }
+
+    /** Execute the scheduled tasks color by color */
+    void start() {
+      assert(updatefunc != NULL);
+      //! Finalize the graph (this could take a while so you should do
+      //! it before calling start for timing purposes)
+      src.finalize(ncpus);
+      prepare_colors();
+
+      // Ensure that the data manager has the correct scope_factory
+      if(data_manager != NULL) {
+        data_manager->set_scope_factory(&scope_manager);
+      }
+
+      aborted = false;
+      finished = active->empty();
+      termination_reason = EXEC_TASK_DEPLETION;
+      nsweeps = 0;
+      stats.reset();
+      _timer.start();
+      callback.reset();
+      callback.set_frontier(next);
+      running = true;
+
+      /* Initialize a pool of threads */
+      std::vector<chromatic_worker> workers(ncpus);
+      thread_group threads;
+      for(size_t i = 0; i < ncpus; ++i) {
+        workers[i].init(this, i);
+        threads.launch(&(workers[i]));
+        if (listener != NULL)
+          listener->engine_worker_starts(i);
+      }
+      /* Wait for all threads to return */
+      logger(LOG_INFO, "Wait until finished...");
+      threads.join();
+      // The tasks scheduled by the last sweep, if the engine stopped
+      // before running them, are run by the next start
+      running = false;
+
+      size_t total_counts = 0;
+      size_t total_work = 0;
+      for(size_t wid = 0; wid < stats.size(); ++wid) {
+        total_counts += stats[wid].updates;
+        total_work += stats[wid].work;
+        logger(LOG_INFO,
+               "Worker %lu finished: task count = %lu, work = %lu",
+               (unsigned long)wid, (unsigned long)stats[wid].updates,
+               (unsigned long)stats[wid].work);
+      } // end of loop over task_counts
+      logger(LOG_INFO, "=== Total task count: %lu, work = %lu, sweeps = %lu",
+             (unsigned long)total_counts, (unsigned long)total_work,
+             (unsigned long)nsweeps);
+    } // end of start
+
+    exec_status last_exec_status() const {
+      return termination_reason;
+    }
+
+    /**
+     * Get the total number of updates executed by this engine.
+     */
+    size_t last_update_count() const {
+      return stats.total_updates();
+    }
+
+    /** The per worker counters of the current (or last) run */
+    worker_stats_array* worker_statistics() { return &stats; }
+
+  private:
+
+    /** Schedule vertex, in the next sweep if the engine runs */
+    void schedule(vertex_id_t vertex, update_function_type func) {
+      set_update_function(func);
+      if(running) next->add(vertex);
+      else active->add(vertex);
+    }
+
+    void schedule_all(update_function_type func) {
+      set_update_function(func);
+      if(running) next->fill();
+      else active->fill();
+    }
+
+    /**
+     * Color the graph again if its colors do not provide the default
+     * consistency, and group the vertices by color.
+     */
+    void prepare_colors() {
+      switch(default_scope) {
+      case scope_range::EDGE_CONSISTENCY:
+      case scope_range::READ_CONSISTENCY:
+        if(!src.valid_coloring()) src.compute_coloring(ncpus);
+        break;
+      case scope_range::FULL_CONSISTENCY:
+        if(!src.valid_distance2_coloring())
+          src.compute_distance2_coloring(ncpus);
+        break;
+      default:
+        // Any coloring serves vertex and null consistency
+        break;
+      }
+      color_blocks.clear();
+      for(vertex_id_t vertex = 0; vertex < src.num_vertices(); ++vertex) {
+        const size_t color = src.color(vertex);
+        if(color >= color_blocks.size()) color_blocks.resize(color + 1);
+        color_blocks[color].push_back(vertex);
+      }
+      logger(LOG_INFO, "Chromatic engine running %lu colors",
+             (unsigned long)color_blocks.size());
+    } // end of prepare colors
+
+
+    /** Run the update function on a single vertex */
+    void run_update(size_t cpuid, vertex_id_t vertex) {
+      worker_stats& wstats = stats[cpuid];
+      const bool timing = stats.timing_enabled();
+      uint64_t time_start = 0, time_scope = 0, time_update = 0;
+      if(timing) time_start = worker_stats_array::now_ns();
+      iscope_type* scope =
+        scope_manager.get_scope(cpuid, vertex, scope_range::NULL_CONSISTENCY);
+      assert(scope != NULL);
+      if(timing) time_scope = worker_stats_array::now_ns();
+      wstats.updates++;
+      wstats.work += scope->in_edge_ids().size() +
+        scope->out_edge_ids().size();
+
+      update_task_type task(vertex, updatefunc);
+      if (listener != NULL) {
+        listener->scheduler_task_scheduled(task, 0.0);
+        listener->engine_task_execute_start(task, scope, cpuid);
+      }
+      updatefunc(*scope, callback, data_manager);
+      if(timing) time_update = worker_stats_array::now_ns();
+      if (listener != NULL)
+        listener->engine_task_execute_finished(task, scope, cpuid);
+
+      scope->commit();
+      scope_manager.release_scope(scope);
+      if(timing) {
+        const uint64_t time_end = worker_stats_array::now_ns();
+        wstats.scope_ns += (time_scope - time_start) + (time_end - time_update);
+        wstats.update_ns += time_update - time_scope;
+      }
+    } // end of run_update
+
+
+    /** Wait for the other workers, counting the time as waiting */
+    void barrier_wait(size_t cpuid) {
+      if(!stats.timing_enabled()) {
+        colorbarrier.wait();
+        return;
+      }
+      const uint64_t time_start = worker_stats_array::now_ns();
+      colorbarrier.wait();
+      stats[cpuid].wait_ns += worker_stats_array::now_ns() - time_start;
+    }
+
+
+    /**
+     * Run one sweep over the colors.  Returns false when the engine
+     * should stop.
+     */
+    bool sweep(size_t cpuid) {
+      if(finished) return false;
+      foreach(const std::vector<vertex_id_t>& block, color_blocks) {
+        // Static chunking: each worker runs one contiguous block
+        const size_t begin = block.size() * cpuid / ncpus;
+        const size_t end = block.size() * (cpuid + 1) / ncpus;
+        for(size_t i = begin; i < end; ++i) {
+          if(active->contains(block[i])) run_update(cpuid, block[i]);
+        }
+        barrier_wait(cpuid);
+      }
+      if(cpuid == 0) end_sweep();
+      barrier_wait(cpuid);
+      return !finished;
+    } // end of sweep
+
+
+    /** Called by worker 0 between sweeps while the others wait */
+    void end_sweep() {
+      ++nsweeps;
+      logger(LOG_INFO, "Sweep %lu complete. %lu vertices run, %lu scheduled.",
+             (unsigned long)nsweeps, (unsigned long)active->size(),
+             (unsigned long)next->size());
+      active->clear();
+      std::swap(active, next);
+      callback.set_frontier(next);
+      callback.reset();
+      if(data_manager != NULL) data_manager->signal_all();
+      if(active->empty()) {
+        termination_reason = EXEC_TASK_DEPLETION;
+        finished = true;
+      } else if(nsweeps >= max_sweeps) {
+        termination_reason = EXEC_TASK_DEPLETION;
+        finished = true;
+      } else if(aborted) {
+        termination_reason = EXEC_FORCED_ABORT;
+        finished = true;
+      } else if(timeout > 0 && _timer.current_time() > timeout) {
+        termination_reason = EXEC_TIMEOUT;
+        finished = true;
+      } else if(taskbudget > 0 && stats.total_updates() >= taskbudget) {
+        termination_reason = EXEC_TASK_BUDGET_EXCEEDED;
+        finished = true;
+      } else if(check_all_terminators()) {
+        termination_reason = EXEC_TERM_FUNCTION;
+        finished = true;
+      }
+    } // end of end sweep
+
+    bool check_all_terminators() {
+      for (size_t i = 0;i < term_functions.size();++i) {
+        if (term_functions[i](data_manager)) return true;
+      }
+      return false;
+    }
+
+  }; // end of chromatic_engine
+
+}; // end of namespace graphlab
+#include <graphlab/macros_undef.hpp>
+
+#endif
@@ -11,6 +11,7 @@
 #include <graphlab/engine/iengine.hpp>
 #include <graphlab/engine/asynchronous_engine.hpp>
 #include <graphlab/engine/synchronous_engine.hpp>
+#include <graphlab/engine/chromatic_engine.hpp>
 
 
 
@@ -29,7 +30,9 @@
 #include <graphlab/schedulers/set_scheduler/set_scheduler.hpp>
 #include <graphlab/schedulers/sweep_scheduler.hpp>
 #include <graphlab/schedulers/multiqueue_fifo_scheduler.hpp>
+#include <graphlab/schedulers/work_stealing_scheduler.hpp>
 #include <graphlab/schedulers/multiqueue_priority_scheduler.hpp>
+#include <graphlab/schedulers/relaxed_priority_scheduler.hpp>
 #include <graphlab/schedulers/clustered_priority_scheduler.hpp>
 
 namespace graphlab {
@@ -54,6 +57,9 @@ namespace graphlab {
       } else if(engine == "synchronous" || engine == "sync") {
         typedef synchronous_engine<Graph> engine_type;
         return new engine_type(_graph, ncpus);     
+      } else if(engine == "chromatic") {
+        typedef chromatic_engine<Graph> engine_type;
+        return new engine_type(_graph, ncpus);
       } else {
         std::cout << "Invalid engine type: " << engine
                   << std::endl;
@@ -103,13 +109,21 @@ namespace graphlab {
      * Allocate an engine given the strings for the engine type, scope
      * factory, and scheduler.
      *
-     * engine       = {async, sim_async, synchronous}
+     * engine       = {async, sim_async, synchronous, chromatic}
      * scope        = {none, vertex, edge, full}
      * scheduler    = {synchronous, fifo, priority, sampling, splash(splash size),
      *                 sweep, multiqueue_fifo, multiqueue_priority,
+     *                 relaxed_priority(queues per cpu, stickiness),
+     *                 work_stealing,
      *                 set,
      *                 clustered_priority({metis, bfs, random}, verts. per part)
      *                 round_robin, colored}
+     *
+     * The chromatic engine runs the tasks color by color without a
+     * scheduler. The scope selects the coloring it needs (edge: a
+     * coloring, full: a distance-2 coloring) and colored(n) limits
+     * the run to n sweeps over the colors. Other schedulers are
+     * ignored.
      * 
      * Note that the caller is responsible for freeing the
      * corresponding engine
@@ -142,6 +156,22 @@ namespace graphlab {
       if(engine == "synchronous" || engine == "sync") {
         return new synchronous_engine<Graph>(_graph, ncpus);
       
+      } else if(engine == "chromatic") {
+        // The scheduler type is not used by the chromatic engine
+        iengine<Graph>* eng =
+          new_engine<Graph, colored_scheduler<Graph> >(engine,
+                                                       scope_factory,
+                                                       _graph,
+                                                       ncpus);
+        if(eng != NULL && scheduler == "colored" && !arguments.empty()) {
+          size_t sweeps = -1;
+          arg_strm >> sweeps;
+          std::cout << "Using max sweeps: " << sweeps << std::endl;
+          eng->get_scheduler().set_option(scheduler_options::MAX_ITERATIONS,
+                                          (void*) sweeps);
+        }
+        return eng;
+
       } else if(scheduler == "fifo") {
         return new_engine<Graph, fifo_scheduler<Graph> >(engine,
                                                   scope_factory,
@@ -190,11 +220,39 @@ namespace graphlab {
                                                              _graph,
                                                              ncpus);     
 
+      } else if(scheduler == "work_stealing") {
+        return new_engine<Graph, work_stealing_scheduler<Graph> >(engine,
+                                                                  scope_factory,
+                                                                  _graph,
+                                                                  ncpus);
       } else if(scheduler == "multiqueue_priority") {
         return new_engine<Graph, multiqueue_priority_scheduler<Graph> >(engine,
                                                                         scope_factory,
                                                                         _graph,
                                                                         ncpus);     
+      } else if(scheduler == "relaxed_priority") {
+        iengine<Graph>* eng =
+          new_engine<Graph, relaxed_priority_scheduler<Graph> >(engine,
+                                                                scope_factory,
+                                                                _graph,
+                                                                ncpus);
+        if(eng != NULL) {
+          size_t queues_per_cpu =
+            relaxed_priority_scheduler<Graph>::DEFAULT_QUEUES_PER_CPU;
+          size_t stickiness =
+            relaxed_priority_scheduler<Graph>::DEFAULT_STICKINESS;
+          if(!arguments.empty()) {
+            arg_strm >> queues_per_cpu;
+            if(arg_strm.good()) arg_strm >> stickiness;
+          }
+          std::cout << "Using " << queues_per_cpu << " queues per cpu with "
+                    << "stickiness " << stickiness << std::endl;
+          eng->get_scheduler().set_option(scheduler_options::QUEUES_PER_CPU,
+                                          (void*) queues_per_cpu);
+          eng->get_scheduler().set_option(scheduler_options::STICKINESS,
+                                          (void*) stickiness);
+        }
+        return eng;
       } else if(scheduler == "set") {
         return new_engine<Graph, set_scheduler<Graph> >(engine,
                                                  scope_factory,
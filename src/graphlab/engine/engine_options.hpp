@@ -19,7 +19,7 @@ namespace graphlab {
    engine. </li>
 
    <li> std::string engine_type: The type of engine to use.  Currently
-   we support {async, async_sim, synchronous}. </li>
+   we support {async, async_sim, synchronous, chromatic}. </li>
 
    <li> std::string scope_type: The type of locking protocol (scope)
    to use. Currently we support {none, vertex, edge, full}. </li>
@@ -27,17 +27,23 @@ namespace graphlab {
    <li> std::string scheduler_type: The type of scheduler to user.
    Currently we support a wide range of schedulers: {synchronous,
    fifo, priority, sampling, splash,  sweep, multiqueue_fifo,
-   multiqueue_priority,  set, clustered_priority, round_robin,
-   colored} </li>
+   multiqueue_priority, relaxed_priority, set, clustered_priority,
+   round_robin, colored} </li>
 
    <li> size_t splash_size: The size parameter for the splash
    scheduler. </li>
+
+   <li> size_t idle_spins: The number of times a worker polls an
+   empty scheduler before it sleeps. Zero never sleeps. </li>
+
+   <li> bool numa: Pin the workers and place the graph by NUMA node
+   (see iengine::set_numa()). </li>
    </ul>
    */
   struct engine_options {
     //! The number of cpus
     size_t ncpus;
-    //! The type of engine {async, async_sim, synchronous}
+    //! The type of engine {async, async_sim, synchronous, chromatic}
     std::string engine_type;
     //! The type of scope
     std::string scope_type;
@@ -45,13 +51,19 @@ namespace graphlab {
     std::string scheduler_type;
     //! The compiler flags
     std::string compile_flags;
+    //! Polls of an empty scheduler before a worker sleeps
+    size_t idle_spins;
+    //! Pin workers and place the graph by NUMA node
+    bool numa;
 
     
     engine_options() :
       ncpus(6),
       engine_type("async"),
       scope_type("vertex"),
-      scheduler_type("fifo") {
+      scheduler_type("fifo"),
+      idle_spins(1000),
+      numa(false) {
       // Grab all the compiler flags 
 #ifdef COMPILEFLAGS
 #define QUOTEME_(x) #x
@@ -76,6 +88,10 @@ namespace graphlab {
                                    scope_type,
                                    graph,
                                    ncpus);
+      if(eng != NULL) {
+        eng->set_idle_spins(idle_spins);
+        eng->set_numa(numa);
+      }
       return eng;
     }
 
@@ -88,7 +104,9 @@ namespace graphlab {
                 << "ncpus:       " << ncpus << "\n"
                 << "engine:      " << engine_type << "\n"
                 << "scope:       " << scope_type  << "\n"
-                << "scheduler:   " << scheduler_type << std::endl;
+                << "scheduler:   " << scheduler_type << "\n"
+                << "idle spins:  " << idle_spins << "\n"
+                << "numa:        " << numa << std::endl;
     }
 
 
@@ -101,7 +119,9 @@ namespace graphlab {
           << engine_type
           << scope_type
           << scheduler_type
-          << compile_flags;
+          << compile_flags
+          << idle_spins
+          << numa;
     } // end of save
 
 
@@ -113,7 +133,9 @@ namespace graphlab {
           >> engine_type
           >> scope_type
           >> scheduler_type
-          >> compile_flags;
+          >> compile_flags
+          >> idle_spins
+          >> numa;
     } // end of load
   };
 
@@ -0,0 +1,192 @@
+#ifndef GRAPHLAB_IDLE_POLICY_HPP
+#define GRAPHLAB_IDLE_POLICY_HPP
+
+#include <vector>
+#include <cassert>
+#include <sched.h>
+
+#include <graphlab/parallel/pthread_tools.hpp>
+#include <graphlab/parallel/atomic.hpp>
+#include <graphlab/util/timer.hpp>
+#include <graphlab/logger/logger.hpp>
+
+
+namespace graphlab {
+
+  /**
+   * Decides what an engine worker does while the scheduler returns
+   * sched_status::WAITING.
+   *
+   * The worker yields the processor for up to spin_limit consecutive
+   * polls and then parks on a condition variable.  Schedulers call
+   * wake_one() whenever they queue a new task and the engine calls
+   * wake_all() when execution ends.  A park is bounded by
+   * park_millis so a wakeup which races with a worker going to sleep,
+   * or a scheduler which never signals, only delays that worker.  A
+   * spin limit of zero never parks, which is the old behavior of
+   * spinning on sched_yield().
+   *
+   * The time every worker spends spinning and parked is recorded and
+   * can be reported with print_stats().
+   */
+  class idle_policy {
+  public:
+    /** Idle accounting of a single worker */
+    struct worker_stats {
+      //! Seconds spent polling an empty scheduler
+      double spin_time;
+      //! Seconds spent parked
+      double park_time;
+      //! Number of times the worker parked
+      size_t parks;
+      worker_stats() : spin_time(0), park_time(0), parks(0) { }
+    };
+
+  private:
+    /** Per worker state, padded so workers do not share lines */
+    struct worker_state {
+      worker_stats stats;
+      size_t spins;
+      bool idle;
+      timer idle_timer;
+      char padding[64];
+      worker_state() : spins(0), idle(false) { }
+    };
+
+    size_t spin_limit;
+    size_t park_millis;
+    std::vector<worker_state> workers;
+
+    mutex park_lock;
+    conditional park_cond;
+    atomic<size_t> nparked;
+    /** Wakeups not yet consumed by a parked worker */
+    size_t pending_wakeups;
+    /** Set by wake_all() until the next reset() */
+    bool released;
+
+    /** Close the current spin interval of a worker */
+    void end_spin(worker_state& w) {
+      w.stats.spin_time += w.idle_timer.current_time();
+    }
+
+  public:
+
+    idle_policy(size_t ncpus = 1,
+                size_t spin_limit = 0,
+                size_t park_millis = 10) :
+      spin_limit(spin_limit), park_millis(park_millis),
+      workers(ncpus), pending_wakeups(0), released(false) { }
+
+    //! Number of polls before a worker parks, zero to never park
+    void set_spin_limit(size_t spins) { spin_limit = spins; }
+    size_t get_spin_limit() const { return spin_limit; }
+
+    //! Upper bound on a single park in milliseconds
+    void set_park_millis(size_t millis) {
+      park_millis = millis > 0 ? millis : 1;
+    }
+
+    /** Clear all statistics and wakeups.  Called before a run. */
+    void reset() {
+      for(size_t i = 0; i < workers.size(); ++i)
+        workers[i] = worker_state();
+      park_lock.lock();
+      pending_wakeups = 0;
+      released = false;
+      park_lock.unlock();
+    }
+
+    /**
+     * Called by worker cpuid each time the scheduler returned
+     * WAITING.
+     */
+    void idle(size_t cpuid) {
+      assert(cpuid < workers.size());
+      worker_state& w = workers[cpuid];
+      if(!w.idle) {
+        w.idle = true;
+        w.spins = 0;
+        w.idle_timer.start();
+      }
+      if(spin_limit == 0 || w.spins < spin_limit || released) {
+        ++w.spins;
+        sched_yield();
+        return;
+      }
+      end_spin(w);
+      timer park_timer;
+      park_timer.start();
+      bool signaled = false;
+      nparked.inc();
+      park_lock.lock();
+      if(!released && pending_wakeups == 0) {
+        park_cond.timedwait_ms(park_lock, park_millis);
+      }
+      if(pending_wakeups > 0) {
+        --pending_wakeups;
+        signaled = true;
+      }
+      signaled = signaled || released;
+      park_lock.unlock();
+      nparked.dec();
+      w.stats.park_time += park_timer.current_time();
+      w.stats.parks++;
+      // After a timeout go straight back to sleep on the next poll,
+      // after a wakeup poll for a while again.
+      w.spins = signaled ? 0 : spin_limit;
+      w.idle_timer.start();
+    } // end of idle
+
+
+    /** Called by worker cpuid when it got a task */
+    inline void busy(size_t cpuid) {
+      worker_state& w = workers[cpuid];
+      if(w.idle) {
+        end_spin(w);
+        w.idle = false;
+      }
+    }
+
+    /** Called by worker cpuid when it stops */
+    void finish(size_t cpuid) { busy(cpuid); }
+
+
+    /** Wake a single parked worker if there is one */
+    inline void wake_one() {
+      if(nparked.value == 0) return;
+      park_lock.lock();
+      if(pending_wakeups < nparked.value) ++pending_wakeups;
+      park_cond.signal();
+      park_lock.unlock();
+    }
+
+    /** Wake every parked worker and keep them from parking again */
+    void wake_all() {
+      park_lock.lock();
+      released = true;
+      park_cond.broadcast();
+      park_lock.unlock();
+    }
+
+    //! Statistics of worker cpuid of the last run
+    const worker_stats& get_stats(size_t cpuid) const {
+      assert(cpuid < workers.size());
+      return workers[cpuid].stats;
+    }
+
+    /** Log the spinning and parked time of every worker */
+    void print_stats() const {
+      for(size_t i = 0; i < workers.size(); ++i) {
+        const worker_stats& s = workers[i].stats;
+        logger(LOG_INFO,
+               "Worker %lu idle: %f s spinning, %f s parked (%lu parks)\n",
+               (unsigned long)i, s.spin_time, s.park_time,
+               (unsigned long)s.parks);
+      }
+    }
+  }; // end of idle_policy
+
+} // end of namespace graphlab
+
+#endif
@@ -15,6 +15,7 @@
 #include <graphlab/scope/iscope.hpp>
 #include <graphlab/shared_data/ishared_data.hpp>
 #include <graphlab/shared_data/ishared_data_manager.hpp>
+#include <graphlab/engine/worker_stats.hpp>
 
 namespace graphlab {
   
@@ -233,6 +234,41 @@ namespace graphlab {
      */
     virtual void set_task_budget(size_t max_tasks) = 0;
 
+
+    /**
+     * \brief set how long a worker without work spins before it
+     * sleeps.
+     *
+     * A worker for which the scheduler has no task polls it up to
+     * spins times and then sleeps until a new task is added.  If
+     * spins is zero the worker never sleeps.  Engines which do not
+     * have idle workers ignore this setting.
+     */
+    virtual void set_idle_spins(size_t spins) { }
+
+
+    /**
+     * \brief enable NUMA aware execution.
+     *
+     * Workers are pinned to cpus with the workers and the vertices
+     * split into one block per NUMA node.  The data of each vertex
+     * block is moved to its node, the edge data is interleaved over
+     * all nodes and schedulers which support it prefer tasks on
+     * vertices of the node of the worker.  Engines which do not
+     * support NUMA placement ignore this setting.
+     */
+    virtual void set_numa(bool enable) { }
+
+
+    /**
+     * \brief the per worker update counts and times of the current
+     * (or last) run.
+     *
+     * Monitors may read the stats while the engine runs.  Returns
+     * NULL if the engine does not keep per worker stats.
+     */
+    virtual worker_stats_array* worker_statistics() { return NULL; }
+
   };
 
 }
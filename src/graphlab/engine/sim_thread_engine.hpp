@@ -10,6 +10,7 @@
 #include <graphlab/graph/graph.hpp>
 #include <graphlab/scope/iscope.hpp>
 #include <graphlab/engine/iengine.hpp>
+#include <graphlab/engine/worker_stats.hpp>
 #include <graphlab/tasks/update_task.hpp>
 #include <graphlab/logger/logger.hpp>
 #include <graphlab/parallel/pthread_tools.hpp>
@@ -54,8 +55,8 @@ namespace graphlab {
     size_t ncpus;
 
     /* Worker bookkeeping */
-    std::vector<size_t> task_counts;
-    std::vector<size_t> worker_works;
+    /** Per worker update counts, work and times */
+    worker_stats_array stats;
     
     /* Listener */
     imonitor_type* listener;
@@ -85,8 +86,7 @@ namespace graphlab {
       scope_manager(g, num_cpus),
       scheduler(g, num_cpus),
       ncpus(num_cpus),
-      task_counts(num_cpus,0),
-      worker_works(num_cpus,0),
+      stats(num_cpus),
       listener(NULL),
       data_manager(NULL),
       _graph(g), taskcount(0) {
@@ -193,8 +193,9 @@ namespace graphlab {
           assert(scope != NULL);
           
           // Update task counts and "work". Work is indegree+outdegree          
-          task_counts[cpuid] = task_counts[cpuid]++;
-          worker_works[cpuid] += scope->in_edge_ids().size() +
+          worker_stats& wstats = stats[cpuid];
+          wstats.updates++;
+          wstats.work += scope->in_edge_ids().size() +
             scope->out_edge_ids().size();
           
           // get the callback for this cpu
@@ -295,15 +296,16 @@ namespace graphlab {
        */
       size_t total_counts = 0;
       size_t total_work = 0;
-      for(size_t wid = 0; wid < task_counts.size(); ++wid) {
-        total_counts += task_counts[wid];
-        total_work += worker_works[wid];
+      for(size_t wid = 0; wid < stats.size(); ++wid) {
+        total_counts += stats[wid].updates;
+        total_work += stats[wid].work;
         logger(LOG_INFO,
-               "Worker %d finished: task count = %d, work = %ld",
-               wid, task_counts[wid], worker_works[wid]);
+               "Worker %lu finished: task count = %lu, work = %lu",
+               (unsigned long)wid, (unsigned long)stats[wid].updates,
+               (unsigned long)stats[wid].work);
       } // end of loop over task_counts
-      logger(LOG_INFO, "=== Total task count: %d,   work=%ld", total_counts, 
-             total_work);
+      logger(LOG_INFO, "=== Total task count: %lu,   work=%lu",
+             (unsigned long)total_counts, (unsigned long)total_work);
       
       if (!aborted) {
         return EXEC_COMPLETED;
@@ -321,11 +323,7 @@ namespace graphlab {
      * Get the total number of updates executed by this engine
      */
     size_t last_update_count() {
-      size_t total_updates = 0;
-      foreach(size_t tc, task_counts) {
-        total_updates += tc;
-      }
-      return total_updates;
+      return stats.total_updates();
     } // end of get the total number of updates
 
 
@@ -10,12 +10,15 @@
 #include <graphlab/scope/iscope.hpp>
 #include <graphlab/scope/synchronous_scope_factory.hpp>
 #include <graphlab/schedulers/support/binary_scheduler_callback.hpp>
+#include <graphlab/schedulers/support/vertex_frontier.hpp>
 #include <graphlab/engine/iengine.hpp>
+#include <graphlab/engine/worker_stats.hpp>
 #include <graphlab/tasks/update_task.hpp>
 #include <graphlab/logger/logger.hpp>
 #include <graphlab/parallel/pthread_tools.hpp>
 #include <graphlab/parallel/atomic.hpp>
 #include <graphlab/util/timer.hpp>
+#include <graphlab/util/system_usage.hpp>
 
 #include <graphlab/shared_data/ishared_data.hpp>
 #include <graphlab/shared_data/ishared_data_manager.hpp>
@@ -27,6 +30,12 @@ namespace graphlab {
   /**
    * This class defines a synchronous engine. Writes are visible
    * only on next iteration.
+   *
+   * The first iteration runs every vertex.  With frontier execution
+   * (the default) every later iteration only runs the vertices
+   * scheduled through the callback during the previous one.  A small
+   * frontier is walked as a list of vertices, a large one by scanning
+   * its bitmap (see vertex_frontier).
    **/  
  
   template<typename Graph>
@@ -53,10 +62,10 @@ namespace graphlab {
 
     /** The number of cpus to use */
     size_t ncpus;
-    std::vector<size_t> task_counts;
+    /** Per worker update counts and times */
+    worker_stats_array stats;
     
     Graph& src;
-    Graph dest;
     update_function_type updatefunc;
     
     synch_scope_factory_type scope_manager;
@@ -80,28 +89,37 @@ namespace graphlab {
 
     exec_status termination_reason;
 
+    /** Only run the scheduled vertices in each iteration */
+    bool use_frontier;
+    /** The frontier is walked as a list while it holds at most this
+        fraction of the vertices */
+    double sparse_fraction;
+    vertex_frontier frontiers[2];
+    /** Vertices run in the current iteration */
+    vertex_frontier* active;
+    /** Vertices scheduled for the next iteration */
+    vertex_frontier* next;
+
   public:
     /** Initialize the multi threaded engine */
     synchronous_engine(Graph& g, size_t num_cpus = thread::cpu_count()) :
       ncpus(num_cpus),
-      task_counts(num_cpus,0),
+      stats(num_cpus),
       src(g),      
-      scope_manager(src, dest, num_cpus), 
+      scope_manager(src, num_cpus), 
       taskcount(0), 
       iterationbarrier(num_cpus),
       listener(NULL), 
-      data_manager(NULL) {
+      data_manager(NULL),
+      use_frontier(true),
+      sparse_fraction(0.05),
+      active(&frontiers[0]),
+      next(&frontiers[1]) {
       timeout = 0;
       taskbudget = 0;
       aborted = false;
       updatefunc = NULL;
       assert(num_cpus >= 1);
-      
-      // Todo: fix this?
-      // dest.copy_from(src);
-      dest = src;
-
-
       niterations = 0;
       cloneedges = true;
     }
@@ -135,13 +153,26 @@ namespace graphlab {
     }
 
     void set_clone_edges(bool clone_edges) {
-      if (clone_edges == false) {
-        // TODO: support disabling edge cloning
-        logger(LOG_WARNING, "Edge cloning cannot be disabled.(TODO)");
-      }
       cloneedges=clone_edges;
+      scope_manager.set_clone_edges(clone_edges);
     }
     
+    /**
+     * Enable or disable frontier execution.  When disabled every
+     * iteration runs every vertex.
+     */
+    void set_frontier_execution(bool frontier_execution) {
+      use_frontier = frontier_execution;
+    }
+
+    /**
+     * Frontiers holding at most this fraction of the vertices are
+     * walked as a list instead of scanning the bitmap.
+     */
+    void set_sparse_fraction(double fraction) {
+      sparse_fraction = fraction;
+    }
+
     bool check_all_terminators() {
       for (size_t i = 0;i < term_functions.size();++i) {
         if (term_functions[i](data_manager)) return true;
@@ -170,49 +201,120 @@ namespace graphlab {
         if (engine->listener != NULL)
           engine->listener->
             engine_worker_dies(workerid, 
-                               engine->task_counts[workerid]);
+                               engine->stats[workerid].updates);
         logger(LOG_INFO, "Worker %d died\n", workerid);
       }      
     }; // end of task worker
 
  
-    bool iteration(int cpuid) {
-      if (cpuid == 0) {
-        ++niterations;
-      }
-      iterationbarrier.wait();
-      for(vertex_id_t vertex = cpuid; vertex < src.num_vertices(); 
-          vertex += ncpus) {
-        task_counts[cpuid] = task_counts[cpuid]++;
-        // build a scope
-        iscope_type* scope = scope_manager.get_scope(cpuid, vertex);
-        
-        assert(scope != NULL);
-
-        update_task_type task(vertex, updatefunc);
-        
-        if (listener != NULL) {
-          listener->scheduler_task_scheduled(task, 0.0);
-          listener->engine_task_execute_start(task, scope, cpuid);
-        }
-        // execute the task
-        // task.execute(*scope, callback, data_manager);
-        assert(task.function() != NULL);
-        task.function()(*scope, callback, data_manager);
+    /** Run the update function on a single vertex */
+    void run_update(size_t cpuid, vertex_id_t vertex) {
+      worker_stats& wstats = stats[cpuid];
+      const bool timing = stats.timing_enabled();
+      uint64_t time_start = 0, time_scope = 0, time_update = 0;
+      if(timing) time_start = worker_stats_array::now_ns();
+      wstats.updates++;
+      // build a scope
+      iscope_type* scope = scope_manager.get_scope(cpuid, vertex);
+      
+      assert(scope != NULL);
+      if(timing) time_scope = worker_stats_array::now_ns();
 
-        if (listener != NULL)
-          listener->engine_task_execute_finished(task, scope, cpuid);      
+      update_task_type task(vertex, updatefunc);
+      
+      if (listener != NULL) {
+        listener->scheduler_task_scheduled(task, 0.0);
+        listener->engine_task_execute_start(task, scope, cpuid);
+      }
+      // execute the task
+      // task.execute(*scope, callback, data_manager);
+      assert(task.function() != NULL);
+      task.function()(*scope, callback, data_manager);
+      if(timing) time_update = worker_stats_array::now_ns();
+
+      if (listener != NULL)
+        listener->engine_task_execute_finished(task, scope, cpuid);      
      
-        scope->commit();
+      scope->commit();
+
+      scope_manager.release_scope(scope);
+      if(timing) {
+        const uint64_t time_end = worker_stats_array::now_ns();
+        wstats.scope_ns += (time_scope - time_start) + (time_end - time_update);
+        wstats.update_ns += time_update - time_scope;
+      }
+
+      // commit the callback ad update the state of the scheduler
+    } // end of run_update
+
 
-        scope_manager.release_scope(scope);
+    /**
+     * Vertices which ran in this iteration but are not scheduled for
+     * the next one will not rewrite their data or out edges in the
+     * other buffers.  Copy the new values across so the next readers
+     * do not see values from two iterations ago.
+     */
+    void sync_retired_vertices(size_t cpuid) {
+      if(active->is_sparse()) {
+        for(size_t i = cpuid; i < active->size(); i += ncpus) {
+          const vertex_id_t vertex = active->sparse_vertex(i);
+          if(!next->contains(vertex)) scope_manager.sync_vertex(vertex);
+        }
+      } else {
+        for(vertex_id_t vertex = cpuid; vertex < src.num_vertices(); 
+            vertex += ncpus) {
+          if(active->contains(vertex) && !next->contains(vertex))
+            scope_manager.sync_vertex(vertex);
+        }
+      }
+    } // end of sync_retired_vertices
 
-        // commit the callback ad update the state of the scheduler
+ 
+    /** Wait for the other workers, counting the time as waiting */
+    void barrier_wait(size_t cpuid) {
+      if(!stats.timing_enabled()) {
+        iterationbarrier.wait();
+        return;
       }
+      const uint64_t time_start = worker_stats_array::now_ns();
       iterationbarrier.wait();
+      stats[cpuid].wait_ns += worker_stats_array::now_ns() - time_start;
+    }
+
+    bool iteration(int cpuid) {
+      if (cpuid == 0) {
+        ++niterations;
+      }
+      barrier_wait(cpuid);
+      if(use_frontier && active->is_sparse()) {
+        // Only visit the scheduled vertices
+        for(size_t i = cpuid; i < active->size(); i += ncpus) {
+          run_update(cpuid, active->sparse_vertex(i));
+        }
+      } else {
+        for(vertex_id_t vertex = cpuid; vertex < src.num_vertices(); 
+            vertex += ncpus) {
+          if(use_frontier && !active->contains(vertex)) continue;
+          run_update(cpuid, vertex);
+        }
+      }
+      barrier_wait(cpuid);
+      if(use_frontier) sync_retired_vertices(cpuid);
       // abortion check
       if (cpuid == 0) {
-        logger(LOG_INFO, "Iteration %d complete.", niterations);
+        if(use_frontier) {
+          logger(LOG_INFO, "Iteration %lu complete. %lu of %lu vertices "
+                 "active (%s), %lu scheduled. Peak RSS %lu KB.",
+                 (unsigned long)niterations, (unsigned long)active->size(),
+                 (unsigned long)src.num_vertices(),
+                 active->is_sparse() ? "sparse" : "dense",
+                 (unsigned long)next->size(),
+                 (unsigned long)peak_memory_kb());
+        } else {
+          logger(LOG_INFO, "Iteration %lu complete. Peak RSS %lu KB.",
+                 (unsigned long)niterations,
+                 (unsigned long)peak_memory_kb());
+        }
       }/*
       if (cpuid == 0 && 
           ((fixediterations == 0 && callback.add_task_called == false) ||
@@ -242,7 +344,7 @@ namespace graphlab {
 		}
 		*/
 		//logger(LOG_INFO, "fixediterations=%d",fixediterations);
-      iterationbarrier.wait();
+      barrier_wait(cpuid);
 		/*
 		if(cpuid ==0 && fixediterations > 0)
 		assert(callback.add_task_called);
@@ -252,6 +354,12 @@ namespace graphlab {
         scope_manager.swap_graphs();
 		//logger(LOG_INFO, "aborted=%d", aborted);
         callback.reset();
+        if(use_frontier) {
+          // The scheduled vertices become the next active set
+          active->clear();
+          std::swap(active, next);
+          callback.set_frontier(next);
+        }
       }
 		//logger(LOG_INFO, "aborted=%d", aborted);
       return !aborted;
@@ -298,23 +406,40 @@ namespace graphlab {
       assert(updatefunc != NULL);
       //! Finalize the graph (this could take a while so you should do
       //! it before calling start for timing purposes)
-      src.finalize();
+      src.finalize(ncpus);
 
       // Ensure that the data manager has the correct scope_factory
       if(data_manager != NULL) {
         data_manager->set_scope_factory(&scope_manager);
       }
 
-      dest = src;
+      // Allocate the write buffers. The graph itself is never copied.
+      scope_manager.init();
+      logger(LOG_INFO, "Synchronous engine buffers: %lu bytes",
+             (unsigned long)scope_manager.buffer_memory_usage());
 
 	  aborted = false;
       niterations = 0;
+      stats.reset();
       fixediterations = 0;
       if (numiterations>0) fixediterations= numiterations;
       /* Timing */
       _timer.start();
       lasttermcheck = lowres_time_seconds();
       callback.reset();
+      if(use_frontier) {
+        // The first iteration runs every vertex
+        const size_t nverts = src.num_vertices();
+        const size_t sparse_capacity = size_t(sparse_fraction * nverts);
+        frontiers[0].resize(nverts, sparse_capacity);
+        frontiers[1].resize(nverts, sparse_capacity);
+        active = &frontiers[0];
+        next = &frontiers[1];
+        active->fill();
+        callback.set_frontier(next);
+      } else {
+        callback.set_frontier(NULL);
+      }
       /* Enable scheduler to clean up in restarts */
       
       /* Initialize a pool of threads */
@@ -334,30 +459,21 @@ namespace graphlab {
       logger(LOG_INFO, "Wait until finished...");
       threads.join();
       //double running_time = _timer.current_time();
-      // ok. Now we need to know which is the right "final" graph
-      // The src graph in the scope manager is the right graph
-      if (scope_manager.get_src_graph() != &src) {
-        src = *scope_manager.get_src_graph();
-      }
-      // now I need to clone the vertex data over (if necessary)
-      if (scope_manager.get_vertex_data_graph() != &src) {             
-        Graph* vdatagraph = scope_manager.get_vertex_data_graph();
-        for(size_t i = 0; i < src.num_vertices(); ++i) {
-          src.vertex_data(i) = vdatagraph->vertex_data(i);
-        }
-      }
+      // The last swap left the newest vertex data in src. Bring the
+      // edge data up to date and release the buffers.
+      scope_manager.finish();
       /**
        * Log task counts. It is useful to see worke-specific task
        * counts to see if work was distributed evenly
        */
       size_t total_counts = 0;
-      for(size_t wid = 0; wid < task_counts.size(); ++wid) {
-        total_counts += task_counts[wid];
+      for(size_t wid = 0; wid < stats.size(); ++wid) {
+        total_counts += stats[wid].updates;
         logger(LOG_INFO,
-               "Worker %d finished: task count = %d",
-               wid, task_counts[wid]);
+               "Worker %lu finished: task count = %lu",
+               (unsigned long)wid, (unsigned long)stats[wid].updates);
       } // end of loop over task_counts
-      logger(LOG_INFO, "=== Total task count: %d", total_counts);
+      logger(LOG_INFO, "=== Total task count: %lu", (unsigned long)total_counts);
       
       
       
@@ -378,13 +494,12 @@ namespace graphlab {
      * Get the total number of updates executed by this engine.
      */
     size_t last_update_count() const { 
-      size_t total_updates = 0;
-      foreach(size_t tc, task_counts) {
-        total_updates += tc;
-      }
-      return total_updates;
+      return stats.total_updates();
     } // end of get profiling info
 
+    /** The per worker counters of the current (or last) run */
+    worker_stats_array* worker_statistics() { return &stats; }
+
   }; // end of synchronous_engine
 
   
@@ -10,10 +10,12 @@
 #include <graphlab/graph/graph.hpp>
 #include <graphlab/scope/iscope.hpp>
 #include <graphlab/engine/iengine.hpp>
+#include <graphlab/engine/worker_stats.hpp>
 #include <graphlab/tasks/update_task.hpp>
 #include <graphlab/logger/logger.hpp>
 #include <graphlab/parallel/pthread_tools.hpp>
 #include <graphlab/parallel/atomic.hpp>
+#include <graphlab/parallel/numa.hpp>
 #include <graphlab/util/timer.hpp>
 #include <graphlab/monitoring/imonitor.hpp>
 
@@ -74,7 +76,7 @@ namespace graphlab {
         if (engine->listener != NULL)
           engine->listener->
             engine_worker_dies(workerid, 
-                               engine->task_counts[workerid]);
+                               engine->stats[workerid].updates);
         logger(LOG_INFO, "Worker %d died\n", workerid);
       }      
     }; // end of task worker
@@ -89,8 +91,8 @@ namespace graphlab {
     size_t ncpus;
 
     /* Worker bookkeeping */
-    std::vector<size_t> task_counts;
-    std::vector<size_t> worker_works;
+    /** Per worker update counts, work and times */
+    worker_stats_array stats;
 
     
     /* Listener */
@@ -111,6 +113,10 @@ namespace graphlab {
     
     std::vector<termination_function_type> term_functions;
     size_t lasttermcheck;
+
+    /** Pin workers and place the graph by NUMA node */
+    bool use_numa;
+    numa_topology numa;
     
   public:
     /** Initialize the multi threaded engine */
@@ -119,11 +125,10 @@ namespace graphlab {
       scope_manager(g, num_cpus),
       scheduler(g, num_cpus),
       ncpus(num_cpus),
-      task_counts(num_cpus,0),
-      worker_works(num_cpus,0),
+      stats(num_cpus),
       listener(NULL),
       data_manager(NULL),
-      _graph(g), taskcount(0) {
+      _graph(g), taskcount(0), use_numa(false) {
       scheduler.register_monitor(NULL);
     
       timeout = 0;
@@ -164,6 +169,14 @@ namespace graphlab {
       taskbudget = max_tasks;
     }
 
+    /**
+     * Pin the workers by NUMA node and place the graph data on the
+     * node of its vertices.
+     */
+    void set_numa(bool enable) {
+      use_numa = enable;
+    }
+
     bool check_all_terminators() {
       if(data_manager != NULL) {        
         for (size_t i = 0;i < term_functions.size();++i) {
@@ -226,13 +239,21 @@ namespace graphlab {
           // Lock the vertex to ensure that no other processor tries
           // to take it
           // build a scope
+          const bool timing = stats.timing_enabled();
+          uint64_t time_start = 0, time_scope = 0, time_update = 0;
+          if(timing) {
+            time_start = worker_stats_array::now_ns();
+            stats[cpuid].wait_ns += time_start - stats[cpuid].wait_start_ns;
+          }
           iscope_type* scope = scope_manager.get_scope(cpuid, vertex);
           
           assert(scope != NULL);
+          if(timing) time_scope = worker_stats_array::now_ns();
           
           // Update task counts and "work". Work is indegree+outdegree          
-          task_counts[cpuid] = task_counts[cpuid]++;
-          worker_works[cpuid] += scope->in_edge_ids().size() +
+          worker_stats& wstats = stats[cpuid];
+          wstats.updates++;
+          wstats.work += scope->in_edge_ids().size() +
             scope->out_edge_ids().size();
           
           // get the callback for this cpu
@@ -247,12 +268,19 @@ namespace graphlab {
           // task.execute(*scope, scallback, data_manager);
           assert(task.function() != NULL);
           task.function()(*scope, scallback, data_manager);
+          if(timing) time_update = worker_stats_array::now_ns();
 
           if (listener != NULL)
             listener->engine_task_execute_finished(task, scope, cpuid);      
             
           scope->commit();
           scope_manager.release_scope(scope);
+          if(timing) {
+            const uint64_t time_end = worker_stats_array::now_ns();
+            wstats.scope_ns += (time_scope - time_start) + (time_end - time_update);
+            wstats.update_ns += time_update - time_scope;
+            wstats.wait_start_ns = time_end;
+          }
 
 
           scheduler.completed_task(cpuid, task);
@@ -297,7 +325,8 @@ namespace graphlab {
     exec_status start() {
       //! Finalize the graph (this could take a while so you should do
       //! it before calling start for timing purposes)
-      _graph.finalize();
+      _graph.finalize(ncpus);
+      if(use_numa) _graph.place_numa(numa);
 
       // Ensure that the data manager has the correct scope_factory
       if(data_manager != NULL) {
@@ -310,8 +339,7 @@ namespace graphlab {
       lasttermcheck = lowres_time_millis();
 
       // Reset the update counts and work counts
-      //       foreach(size_t& tc, task_counts) tc = 0;
-      //       foreach(size_t& works, worker_works) works =0;
+      stats.reset();
 
 
       /* Enable scheduler to clean up in restarts */
@@ -325,8 +353,8 @@ namespace graphlab {
         // Start the worker thread using the thread group with cpu
         // affinity attached (CPU affinity currently only supported in
         // linux) since Mac affinity is set through the NX frameworks
-        threads.launch(&(workers[i]));
-        //  threads.launch(&(workers[i]), i);
+        if(use_numa) threads.launch(&(workers[i]), numa.worker_cpu(i, ncpus));
+        else threads.launch(&(workers[i]));
         if (listener != NULL)
           listener->engine_worker_starts(i);
       }
@@ -343,15 +371,16 @@ namespace graphlab {
        */
       size_t total_counts = 0;
       size_t total_work = 0;
-      for(size_t wid = 0; wid < task_counts.size(); ++wid) {
-        total_counts += task_counts[wid];
-        total_work += worker_works[wid];
+      for(size_t wid = 0; wid < stats.size(); ++wid) {
+        total_counts += stats[wid].updates;
+        total_work += stats[wid].work;
         logger(LOG_INFO,
-               "Worker %d finished: task count = %d, work = %ld",
-               wid, task_counts[wid], worker_works[wid]);
+               "Worker %lu finished: task count = %lu, work = %lu",
+               (unsigned long)wid, (unsigned long)stats[wid].updates,
+               (unsigned long)stats[wid].work);
       } // end of loop over task_counts
-      logger(LOG_INFO, "=== Total task count: %d,   work=%ld", total_counts, 
-             total_work);
+      logger(LOG_INFO, "=== Total task count: %lu,   work=%lu",
+             (unsigned long)total_counts, (unsigned long)total_work);
       
       if (!aborted) {
         return EXEC_COMPLETED;
@@ -373,12 +402,11 @@ namespace graphlab {
      * last run.
      */
     size_t last_update_count() {
-      size_t total_updates = 0;
-      foreach(size_t tc, task_counts) {
-        total_updates += tc;
-      }
-      return total_updates;
-    } // end of get update count
+      return stats.total_updates();
+    }
+
+    /** The per worker counters of the current (or last) run */
+    worker_stats_array* worker_statistics() { return &stats; } // end of get update count
 
 
 
@@ -0,0 +1,136 @@
+#ifndef GRAPHLAB_WORKER_STATS_HPP
+#define GRAPHLAB_WORKER_STATS_HPP
+
+#include <cassert>
+#include <cstdlib>
+#include <new>
+#include <vector>
+#include <stdint.h>
+#include <time.h>
+#include <sys/time.h>
+
+namespace graphlab {
+
+  /**
+   * The counters of one engine worker.  Only the worker itself
+   * writes them.  Times are in nanoseconds and are only collected
+   * while timing is enabled (see worker_stats_array::set_timing()).
+   */
+  struct worker_stats {
+    /** Number of updates executed */
+    size_t updates;
+    /** Number of edges in the scopes of the updates.  Engines which
+        only count it while timing do so to keep the default path
+        cheap */
+    size_t work;
+    /** Time spent acquiring and releasing scopes */
+    uint64_t scope_ns;
+    /** Time spent in update functions */
+    uint64_t update_ns;
+    /** Time between finishing an update and getting the next task */
+    uint64_t wait_ns;
+    /** When the worker last started waiting for a task */
+    uint64_t wait_start_ns;
+
+    worker_stats() { clear(); }
+
+    void clear() {
+      updates = 0;
+      work = 0;
+      scope_ns = 0;
+      update_ns = 0;
+      wait_ns = 0;
+      wait_start_ns = 0;
+    }
+  };
+
+
+  /**
+   * One worker_stats block per worker, each in its own cache line so
+   * that workers counting their updates do not invalidate each
+   * other's lines.  Other threads may read the blocks while the
+   * workers run (see snapshot()).  Such reads are not synchronized
+   * and may be slightly stale, which is fine for monitoring.
+   */
+  class worker_stats_array {
+    /** The stats of one worker, padded to a cache line */
+    struct slot {
+      worker_stats stats;
+      char padding[64 - sizeof(worker_stats) % 64];
+    };
+
+    slot* slots;
+    size_t nslots;
+    bool timing;
+
+    // Not copyable
+    worker_stats_array(const worker_stats_array&);
+    worker_stats_array& operator=(const worker_stats_array&);
+
+  public:
+    worker_stats_array(size_t nworkers) : timing(false) {
+      nslots = nworkers > 0 ? nworkers : 1;
+      void* ptr = NULL;
+      int error = posix_memalign(&ptr, 64, sizeof(slot) * nslots);
+      assert(error == 0 && ptr != NULL);
+      slots = reinterpret_cast<slot*>(ptr);
+      for(size_t i = 0; i < nslots; ++i) new (&slots[i].stats) worker_stats();
+    }
+
+    ~worker_stats_array() { free(slots); }
+
+    size_t size() const { return nslots; }
+
+    worker_stats& operator[](size_t worker) {
+      assert(worker < nslots);
+      return slots[worker].stats;
+    }
+
+    const worker_stats& operator[](size_t worker) const {
+      assert(worker < nslots);
+      return slots[worker].stats;
+    }
+
+    /** Collect the scope, update and wait times. Off by default. */
+    void set_timing(bool enable) { timing = enable; }
+    bool timing_enabled() const { return timing; }
+
+    /** Clear all counters and start every worker waiting now */
+    void reset() {
+      const uint64_t now = now_ns();
+      for(size_t i = 0; i < nslots; ++i) {
+        slots[i].stats.clear();
+        slots[i].stats.wait_start_ns = now;
+      }
+    }
+
+    /** Copy the current stats of all workers into ret */
+    void snapshot(std::vector<worker_stats>& ret) const {
+      ret.resize(nslots);
+      for(size_t i = 0; i < nslots; ++i) ret[i] = slots[i].stats;
+    }
+
+    /** The number of updates of all workers */
+    size_t total_updates() const {
+      size_t sum = 0;
+      for(size_t i = 0; i < nslots; ++i) sum += slots[i].stats.updates;
+      return sum;
+    }
+
+    /** A monotonic time stamp in nanoseconds */
+    static uint64_t now_ns() {
+#if defined(CLOCK_MONOTONIC)
+      struct timespec ts;
+      clock_gettime(CLOCK_MONOTONIC, &ts);
+      return uint64_t(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+#else
+      struct timeval tv;
+      gettimeofday(&tv, NULL);
+      return uint64_t(tv.tv_sec) * 1000000000ULL + uint64_t(tv.tv_usec) * 1000;
+#endif
+    }
+  }; // end of worker_stats_array
+
+} // end of namespace graphlab
+
+#endif
@@ -0,0 +1,379 @@
+#ifndef GRAPHLAB_LOG_SPACE_KERNELS_HPP
+#define GRAPHLAB_LOG_SPACE_KERNELS_HPP
+
+/**
+ * Kernels over contiguous arrays of log values used by table_factor.
+ *
+ * exp() and log() are evaluated two (SSE2) or four (AVX2) values at a
+ * time when the compiler targets those instruction sets (-msse2 is
+ * the default on x86-64, -mavx2 or -march=native enables AVX2) and
+ * with std::exp and std::log otherwise.  The vector versions agree
+ * with the C library to within a few ulps.
+ *
+ * Zero probabilities are represented by -MAX_DOUBLE as in
+ * table_factor: log() maps zero (and denormals) to -MAX_DOUBLE and
+ * exp() maps anything below the smallest normal double to zero.
+ */
+
+#include <cmath>
+#include <cassert>
+#include <cstring>
+#include <limits>
+#include <vector>
+#include <stdint.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define GRAPHLAB_LOG_SPACE_AVX2
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define GRAPHLAB_LOG_SPACE_SSE2
+#endif
+
+
+namespace graphlab {
+  namespace log_space {
+
+    /**
+     * Scratch storage which lives on the stack for small factors
+     * and on the heap for large ones.
+     */
+    template<typename T, size_t N = 256>
+    class scratch_array {
+    public:
+      scratch_array(size_t n) {
+        if(n <= N) { ptr = local; }
+        else { heap.resize(n); ptr = &heap[0]; }
+      }
+      T* get() { return ptr; }
+      T& operator[](size_t i) { return ptr[i]; }
+      const T& operator[](size_t i) const { return ptr[i]; }
+    private:
+      T local[N];
+      std::vector<T> heap;
+      T* ptr;
+      // Not copyable
+      scratch_array(const scratch_array&);
+      scratch_array& operator=(const scratch_array&);
+    }; // end of scratch_array
+
+
+    namespace detail {
+      const double max_double = std::numeric_limits<double>::max();
+      // exp(x) underflows below this
+      const double min_exp_arg = -708.39;
+      const double max_exp_arg = 709.78;
+      const double log2e = 1.4426950408889634074;
+      const double ln2_hi = 6.93145751953125e-1;
+      const double ln2_lo = 1.42860682030941723212e-6;
+      const double ln2 = 0.69314718055994530942;
+      const double sqrt2 = 1.41421356237309504880;
+      // 1.5 * 2^52: adding it rounds to the nearest integer and
+      // leaves the integer in the low mantissa bits
+      const double round_magic = 6755399441055744.0;
+      // 2^52: or-ing small integers into its mantissa converts them
+      // to doubles
+      const double two52 = 4503599627370496.0;
+    } // end of namespace detail
+
+
+#if defined(GRAPHLAB_LOG_SPACE_AVX2) || defined(GRAPHLAB_LOG_SPACE_SSE2)
+    namespace detail {
+#if defined(GRAPHLAB_LOG_SPACE_AVX2)
+      typedef __m256d vd;
+      typedef __m256i vi;
+      const size_t width = 4;
+      inline vd load(const double* p) { return _mm256_loadu_pd(p); }
+      inline void store(double* p, vd a) { _mm256_storeu_pd(p, a); }
+      inline vd set1(double x) { return _mm256_set1_pd(x); }
+      inline vd add(vd a, vd b) { return _mm256_add_pd(a, b); }
+      inline vd sub(vd a, vd b) { return _mm256_sub_pd(a, b); }
+      inline vd mul(vd a, vd b) { return _mm256_mul_pd(a, b); }
+      inline vd div(vd a, vd b) { return _mm256_div_pd(a, b); }
+      inline vd max(vd a, vd b) { return _mm256_max_pd(a, b); }
+      inline vd min(vd a, vd b) { return _mm256_min_pd(a, b); }
+      inline vd abs(vd a) { return _mm256_andnot_pd(_mm256_set1_pd(-0.0), a); }
+      inline vd less(vd a, vd b) { return _mm256_cmp_pd(a, b, _CMP_LT_OQ); }
+      inline vd greater(vd a, vd b) { return _mm256_cmp_pd(a, b, _CMP_GT_OQ); }
+      inline vd bit_and(vd a, vd b) { return _mm256_and_pd(a, b); }
+      inline vd bit_or(vd a, vd b) { return _mm256_or_pd(a, b); }
+      inline vd bit_andnot(vd a, vd b) { return _mm256_andnot_pd(a, b); }
+      inline vi as_int(vd a) { return _mm256_castpd_si256(a); }
+      inline vd as_double(vi a) { return _mm256_castsi256_pd(a); }
+      inline vi add64(vi a, vi b) { return _mm256_add_epi64(a, b); }
+      inline vi set1_64(int64_t x) { return _mm256_set1_epi64x(x); }
+      inline vi shl64(vi a, int n) { return _mm256_slli_epi64(a, n); }
+      inline vi shr64(vi a, int n) { return _mm256_srli_epi64(a, n); }
+      inline vi and64(vi a, vi b) { return _mm256_and_si256(a, b); }
+      inline vi or64(vi a, vi b) { return _mm256_or_si256(a, b); }
+      inline double hsum(vd a) {
+        double tmp[4]; store(tmp, a);
+        return (tmp[0] + tmp[1]) + (tmp[2] + tmp[3]);
+      }
+      inline double hmax(vd a) {
+        double tmp[4]; store(tmp, a);
+        return std::max(std::max(tmp[0], tmp[1]), std::max(tmp[2], tmp[3]));
+      }
+#if defined(__FMA__)
+      inline vd madd(vd a, vd b, vd c) { return _mm256_fmadd_pd(a, b, c); }
+#else
+      inline vd madd(vd a, vd b, vd c) { return add(mul(a, b), c); }
+#endif
+#else
+      typedef __m128d vd;
+      typedef __m128i vi;
+      const size_t width = 2;
+      inline vd load(const double* p) { return _mm_loadu_pd(p); }
+      inline void store(double* p, vd a) { _mm_storeu_pd(p, a); }
+      inline vd set1(double x) { return _mm_set1_pd(x); }
+      inline vd add(vd a, vd b) { return _mm_add_pd(a, b); }
+      inline vd sub(vd a, vd b) { return _mm_sub_pd(a, b); }
+      inline vd mul(vd a, vd b) { return _mm_mul_pd(a, b); }
+      inline vd div(vd a, vd b) { return _mm_div_pd(a, b); }
+      inline vd max(vd a, vd b) { return _mm_max_pd(a, b); }
+      inline vd min(vd a, vd b) { return _mm_min_pd(a, b); }
+      inline vd abs(vd a) { return _mm_andnot_pd(_mm_set1_pd(-0.0), a); }
+      inline vd less(vd a, vd b) { return _mm_cmplt_pd(a, b); }
+      inline vd greater(vd a, vd b) { return _mm_cmpgt_pd(a, b); }
+      inline vd bit_and(vd a, vd b) { return _mm_and_pd(a, b); }
+      inline vd bit_or(vd a, vd b) { return _mm_or_pd(a, b); }
+      inline vd bit_andnot(vd a, vd b) { return _mm_andnot_pd(a, b); }
+      inline vi as_int(vd a) { return _mm_castpd_si128(a); }
+      inline vd as_double(vi a) { return _mm_castsi128_pd(a); }
+      inline vi add64(vi a, vi b) { return _mm_add_epi64(a, b); }
+      inline vi set1_64(int64_t x) { return _mm_set1_epi64x(x); }
+      inline vi shl64(vi a, int n) { return _mm_slli_epi64(a, n); }
+      inline vi shr64(vi a, int n) { return _mm_srli_epi64(a, n); }
+      inline vi and64(vi a, vi b) { return _mm_and_si128(a, b); }
+      inline vi or64(vi a, vi b) { return _mm_or_si128(a, b); }
+      inline double hsum(vd a) {
+        double tmp[2]; store(tmp, a);
+        return tmp[0] + tmp[1];
+      }
+      inline double hmax(vd a) {
+        double tmp[2]; store(tmp, a);
+        return std::max(tmp[0], tmp[1]);
+      }
+      inline vd madd(vd a, vd b, vd c) { return add(mul(a, b), c); }
+#endif
+
+      /** select(mask, a, b) = mask ? a : b */
+      inline vd select(vd mask, vd a, vd b) {
+        return bit_or(bit_and(mask, a), bit_andnot(mask, b));
+      }
+
+      /**
+       * exp(x) by reduction to r = x - n ln2 with |r| <= ln2 / 2, a
+       * degree 13 Taylor polynomial for exp(r) and scaling by 2^n
+       * built directly in the exponent bits.
+       */
+      inline vd vexp(vd x) {
+        const vd underflow = less(x, set1(min_exp_arg));
+        x = min(max(x, set1(min_exp_arg)), set1(max_exp_arg));
+        // n = round(x / ln2) with the integer kept in the low bits of t
+        const vd t = madd(x, set1(log2e), set1(round_magic));
+        const vd n = sub(t, set1(round_magic));
+        vd r = sub(x, mul(n, set1(ln2_hi)));
+        r = sub(r, mul(n, set1(ln2_lo)));
+        vd p = set1(1.0 / 6227020800.0);
+        p = madd(p, r, set1(1.0 / 479001600.0));
+        p = madd(p, r, set1(1.0 / 39916800.0));
+        p = madd(p, r, set1(1.0 / 3628800.0));
+        p = madd(p, r, set1(1.0 / 362880.0));
+        p = madd(p, r, set1(1.0 / 40320.0));
+        p = madd(p, r, set1(1.0 / 5040.0));
+        p = madd(p, r, set1(1.0 / 720.0));
+        p = madd(p, r, set1(1.0 / 120.0));
+        p = madd(p, r, set1(1.0 / 24.0));
+        p = madd(p, r, set1(1.0 / 6.0));
+        p = madd(p, r, set1(0.5));
+        p = madd(p, r, set1(1.0));
+        p = madd(p, r, set1(1.0));
+        // 2^(n-1) times 2 keeps n + 1023 inside the exponent range
+        // at both ends of the clamped input
+        const vi bits = shl64(add64(as_int(t), set1_64(1022)), 52);
+        const vd result = mul(mul(p, as_double(bits)), set1(2.0));
+        return bit_andnot(underflow, result);
+      } // end of vexp
+
+      /**
+       * log(x) by splitting x = m 2^e with m in [sqrt(2)/2, sqrt(2))
+       * and log(m) = 2 atanh((m - 1) / (m + 1)) from its series.
+       * Zero and denormal inputs give -max_double.
+       */
+      inline vd vlog(vd x) {
+        const vd tiny = less(x, set1(std::numeric_limits<double>::min()));
+        const vi bits = as_int(x);
+        // the biased exponent as a double
+        const vd ebias =
+          sub(as_double(or64(shr64(bits, 52), as_int(set1(two52)))), set1(two52));
+        vd m = as_double(or64(and64(bits, set1_64(0x000FFFFFFFFFFFFFLL)),
+                              set1_64(0x3FF0000000000000LL)));
+        const vd big = greater(m, set1(sqrt2));
+        m = select(big, mul(m, set1(0.5)), m);
+        const vd e = add(sub(ebias, set1(1023.0)), bit_and(big, set1(1.0)));
+        const vd f = div(sub(m, set1(1.0)), add(m, set1(1.0)));
+        const vd s = mul(f, f);
+        vd p = set1(1.0 / 19.0);
+        p = madd(p, s, set1(1.0 / 17.0));
+        p = madd(p, s, set1(1.0 / 15.0));
+        p = madd(p, s, set1(1.0 / 13.0));
+        p = madd(p, s, set1(1.0 / 11.0));
+        p = madd(p, s, set1(1.0 / 9.0));
+        p = madd(p, s, set1(1.0 / 7.0));
+        p = madd(p, s, set1(1.0 / 5.0));
+        p = madd(p, s, set1(1.0 / 3.0));
+        p = madd(p, s, set1(1.0));
+        const vd logm = mul(add(f, f), p);
+        const vd result = madd(e, set1(ln2), logm);
+        return select(tiny, set1(-max_double), result);
+      } // end of vlog
+    } // end of namespace detail
+#endif
+
+
+    /** out[i] = exp(in[i]). in and out may be the same array */
+    inline void exp(const double* in, double* out, size_t n) {
+      size_t i = 0;
+#if defined(GRAPHLAB_LOG_SPACE_AVX2) || defined(GRAPHLAB_LOG_SPACE_SSE2)
+      for(; i + detail::width <= n; i += detail::width)
+        detail::store(out + i, detail::vexp(detail::load(in + i)));
+#endif
+      for(; i < n; ++i)
+        out[i] = in[i] < detail::min_exp_arg ? 0.0 : std::exp(in[i]);
+    } // end of exp
+
+    /** out[i] = log(in[i]) or -MAX_DOUBLE if in[i] is zero */
+    inline void log(const double* in, double* out, size_t n) {
+      size_t i = 0;
+#if defined(GRAPHLAB_LOG_SPACE_AVX2) || defined(GRAPHLAB_LOG_SPACE_SSE2)
+      for(; i + detail::width <= n; i += detail::width)
+        detail::store(out + i, detail::vlog(detail::load(in + i)));
+#endif
+      for(; i < n; ++i) {
+        out[i] = in[i] < std::numeric_limits<double>::min() ?
+          -detail::max_double : std::log(in[i]);
+      }
+    } // end of log
+
+    /** The largest of the n values */
+    inline double max(const double* a, size_t n) {
+      assert(n > 0);
+      double result = a[0];
+      size_t i = 0;
+#if defined(GRAPHLAB_LOG_SPACE_AVX2) || defined(GRAPHLAB_LOG_SPACE_SSE2)
+      if(n >= detail::width) {
+        detail::vd m = detail::load(a);
+        for(i = detail::width; i + detail::width <= n; i += detail::width)
+          m = detail::max(m, detail::load(a + i));
+        result = detail::hmax(m);
+      }
+#endif
+      for(; i < n; ++i) result = std::max(result, a[i]);
+      return result;
+    } // end of max
+
+    /** The sum of exp(a[i] - offset) */
+    inline double sum_exp(const double* a, double offset, size_t n) {
+      double result = 0;
+      size_t i = 0;
+#if defined(GRAPHLAB_LOG_SPACE_AVX2) || defined(GRAPHLAB_LOG_SPACE_SSE2)
+      detail::vd sum = detail::set1(0);
+      const detail::vd voffset = detail::set1(offset);
+      for(; i + detail::width <= n; i += detail::width) {
+        sum = detail::add(sum, detail::vexp(detail::sub(detail::load(a + i),
+                                                        voffset)));
+      }
+      result = detail::hsum(sum);
+#endif
+      for(; i < n; ++i) {
+        const double x = a[i] - offset;
+        if(x >= detail::min_exp_arg) result += std::exp(x);
+      }
+      return result;
+    } // end of sum_exp
+
+    /** a[i] += b[i] */
+    inline void add(double* a, const double* b, size_t n) {
+      for(size_t i = 0; i < n; ++i) a[i] += b[i];
+    }
+
+    /** a[i] -= b[i] */
+    inline void sub(double* a, const double* b, size_t n) {
+      for(size_t i = 0; i < n; ++i) a[i] -= b[i];
+    }
+
+    /** a[i] += value */
+    inline void add(double* a, double value, size_t n) {
+      for(size_t i = 0; i < n; ++i) a[i] += value;
+    }
+
+    /**
+     * a[i] = log(exp(a[i]) + exp(b[i])) computed as
+     * max + log(1 + exp(min - max)) which neither overflows nor loses
+     * the smaller term when both are large.
+     */
+    inline void log_add(double* a, const double* b, size_t n) {
+      size_t i = 0;
+#if defined(GRAPHLAB_LOG_SPACE_AVX2) || defined(GRAPHLAB_LOG_SPACE_SSE2)
+      using namespace detail;
+      for(; i + width <= n; i += width) {
+        const vd x = load(a + i), y = load(b + i);
+        const vd hi = detail::max(x, y), lo = detail::min(x, y);
+        const vd t = vexp(sub(lo, hi));
+        store(a + i, add(hi, vlog(add(set1(1.0), t))));
+      }
+#endif
+      for(; i < n; ++i) {
+        const double hi = std::max(a[i], b[i]), lo = std::min(a[i], b[i]);
+        const double d = lo - hi;
+        a[i] = hi + (d < detail::min_exp_arg ? 0.0 : std::log(1.0 + std::exp(d)));
+      }
+    } // end of log_add
+
+    /**
+     * a[i] = log(damping exp(b[i]) + (1 - damping) exp(a[i])) relative
+     * to the larger of the two values
+     */
+    inline void log_damp(double* a, const double* b, double damping,
+                         size_t n) {
+      size_t i = 0;
+#if defined(GRAPHLAB_LOG_SPACE_AVX2) || defined(GRAPHLAB_LOG_SPACE_SSE2)
+      using namespace detail;
+      const vd vdamp = set1(damping), vkeep = set1(1 - damping);
+      for(; i + width <= n; i += width) {
+        const vd x = load(a + i), y = load(b + i);
+        const vd hi = detail::max(x, y);
+        const vd val = madd(vdamp, vexp(sub(y, hi)),
+                            mul(vkeep, vexp(sub(x, hi))));
+        store(a + i, add(hi, vlog(val)));
+      }
+#endif
+      for(; i < n; ++i) {
+        const double hi = std::max(a[i], b[i]);
+        const double val = damping * std::exp(b[i] - hi) +
+          (1 - damping) * std::exp(a[i] - hi);
+        a[i] = val == 0 ? -detail::max_double : hi + std::log(val);
+      }
+    } // end of log_damp
+
+    /** sum_i |exp(a[i]) - exp(b[i])| */
+    inline double l1_exp_distance(const double* a, const double* b, size_t n) {
+      double result = 0;
+      size_t i = 0;
+#if defined(GRAPHLAB_LOG_SPACE_AVX2) || defined(GRAPHLAB_LOG_SPACE_SSE2)
+      using namespace detail;
+      vd sum = set1(0);
+      for(; i + width <= n; i += width) {
+        sum = add(sum, detail::abs(sub(vexp(load(a + i)), vexp(load(b + i)))));
+      }
+      result = hsum(sum);
+#endif
+      for(; i < n; ++i) result += std::abs(std::exp(a[i]) - std::exp(b[i]));
+      return result;
+    } // end of l1_exp_distance
+
+  } // end of namespace log_space
+} // end of namespace graphlab
+
+#endif
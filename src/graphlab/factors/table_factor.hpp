@@ -30,6 +30,9 @@
 #include <graphlab/serialization/iarchive.hpp>
 #include <graphlab/serialization/oarchive.hpp>
 
+// Vectorized exp, log and log-sum-exp
+#include <graphlab/factors/log_space_kernels.hpp>
+
 
 
 // Include the macro for the for each operation
@@ -697,13 +700,13 @@ namespace graphlab {
 
     size_t num_vars() const { return _args.num_vars(); }
 
-    double* begin() { return _data.begin(); }
-    const double* begin() const { return _data.begin(); }
+    double* begin() { return &_data[0]; }
+    const double* begin() const { return &_data[0]; }
     
 
     
-    double* end() { return _data.end(); }
-    const double* end() const { return _data.end(); }
+    double* end() { return &_data[0] + _data.size(); }
+    const double* end() const { return &_data[0] + _data.size(); }
     
     void zero() { std::fill(_data.begin(), _data.end(), 0); }
         
@@ -720,18 +723,14 @@ namespace graphlab {
     
     //! ensure that sum_x this(x) = 1 
     void normalize() {
+      assert(size() > 0);
+      double* data = &_data[0];
       // Compute the max value
-      double max_value = logP(0);
-      for(size_t asg = 0; asg < size(); ++asg) 
-        max_value = std::max(max_value, logP(asg));
+      const double max_value = log_space::max(data, size());
       assert( !std::isinf(max_value) );
       assert( !std::isnan(max_value) );
-      // scale and compute normalizing constant
-      double Z = 0.0;
-      for(size_t asg = 0; asg < size(); ++asg) {
-        logP(asg) -= max_value;
-        Z += std::exp(logP(asg));
-      }
+      // compute the normalizing constant of the scaled values
+      const double Z = log_space::sum_exp(data, max_value, size());
       assert( !std::isinf(Z) );
       assert( !std::isnan(Z) );
       assert( Z > 0.0);
@@ -739,21 +738,26 @@ namespace graphlab {
       assert( !std::isinf(logZ) );
       assert( !std::isnan(logZ) );
       // Normalize
+      log_space::add(data, -(max_value + logZ), size());
       for(size_t asg = 0; asg < size(); ++asg) {
-        logP(asg) -= logZ;
-        if(logP(asg) < LOG_EPSILON) logP(asg) = -MAX_DOUBLE;
+        if(data[asg] < LOG_EPSILON) data[asg] = -MAX_DOUBLE;
       }
     } // End of normalize
     
 
     //! this(x) += other(x);
     inline table_factor& operator+=(const table_factor& other) {
-      for(assignment_type asg = args().begin(); asg < args().end(); ++asg) {
-        logP(asg.linear_index()) =
-          log( exp(logP(asg.linear_index())) + exp(other.logP(asg)) );
-        assert(logP(asg.linear_index()) <= LOG_MAX_DOUBLE);
-        //  assert( !std::isinf( logP(asg.linear_index()) ) );
-        //  assert( !std::isnan( logP(asg.linear_index()) ) );
+      if(size() == 0) return *this;
+      if(args() == other.args()) {
+        log_space::log_add(&_data[0], &other._data[0], size());
+      } else {
+        // Spread other over this domain first
+        log_space::scratch_array<double> tmp(size());
+        other.expand(args(), tmp.get());
+        log_space::log_add(&_data[0], tmp.get(), size());
+      }
+      for(size_t i = 0; i < size(); ++i) {
+        assert(_data[i] <= LOG_MAX_DOUBLE);
       }
       return *this;
     }
@@ -762,11 +766,18 @@ namespace graphlab {
 
     //! this(x) *= other(x);
     inline table_factor& operator*=(const table_factor& other) {
-      for(assignment_type asg = args().begin(); asg < args().end(); ++asg) {
-        logP(asg.linear_index()) += other.logP(asg);
-        assert(logP(asg.linear_index()) <= LOG_MAX_DOUBLE);
-        assert( !std::isinf( logP(asg.linear_index()) ) );
-        assert( !std::isnan( logP(asg.linear_index()) ) );
+      if(size() == 0) return *this;
+      if(args() == other.args()) {
+        log_space::add(&_data[0], &other._data[0], size());
+      } else {
+        log_space::scratch_array<size_t> index(size());
+        restrict_indices(args(), other.args(), index.get());
+        for(size_t i = 0; i < size(); ++i) _data[i] += other._data[index[i]];
+      }
+      for(size_t i = 0; i < size(); ++i) {
+        assert(_data[i] <= LOG_MAX_DOUBLE);
+        assert( !std::isinf( _data[i] ) );
+        assert( !std::isnan( _data[i] ) );
       }
       return *this;
     }
@@ -779,10 +790,17 @@ namespace graphlab {
 
     //! this(x) /= other(x);
     inline table_factor& operator/=(const table_factor& other) {
-      for(assignment_type asg = args().begin(); asg < args().end(); ++asg) {
-        logP(asg.linear_index()) -= other.logP(asg);
-        assert( !std::isinf( logP(asg.linear_index()) ) );
-        assert( !std::isnan( logP(asg.linear_index()) ) );
+      if(size() == 0) return *this;
+      if(args() == other.args()) {
+        log_space::sub(&_data[0], &other._data[0], size());
+      } else {
+        log_space::scratch_array<size_t> index(size());
+        restrict_indices(args(), other.args(), index.get());
+        for(size_t i = 0; i < size(); ++i) _data[i] -= other._data[index[i]];
+      }
+      for(size_t i = 0; i < size(); ++i) {
+        assert( !std::isinf( _data[i] ) );
+        assert( !std::isnan( _data[i] ) );
       }
       return *this;
     }
@@ -800,42 +818,16 @@ namespace graphlab {
                          const table_factor& other) {
       // ensure that both factors have the same domain
       assert(args() + other.args() == joint.args());
-      // Initialize the factor to zero so we can use it as an
-      // accumulator
-      uniform(0);
-      for(assignment_type asg = joint.args().begin();
-          asg < joint.args().end(); ++asg) {
-        const double value =
-          std::exp(joint.logP(asg.linear_index()) + other.logP(asg));
-        assert( !std::isinf(value) );
-        assert( !std::isnan(value) );
-        logP(asg) += value;
-      }
-
-      for(size_t i = 0; i < _data.size(); ++i) {
-        double& sum = _data[i];
-        assert(sum >= 0.0);
-        if(sum == 0) sum = -MAX_DOUBLE;
-        else sum = std::log(sum);
-      }
-      
-      // // ensure that both factors have the same domain
-      // assert(args() + other.args() == joint.args());
-      // for(assignment_type xasg = args().begin(); 
-      //     xasg < args().end(); ++xasg) {
-      //   double sum = 0;
-      //   for(assignment_type yasg = other.args().begin(); 
-      //       yasg < other.args().end(); ++yasg) {
-      //     assignment_type joint_asg = xasg & yasg;
-      //     sum += std::exp(joint.logP(joint_asg.linear_index()) + 
-      //                     other.logP(yasg.linear_index()));
-      //   }
-      //   assert( !std::isinf(sum) );
-      //   assert( !std::isnan(sum) );
-      //   assert(sum >= 0.0);
-      //   if(sum == 0) logP(xasg.linear_index()) = -MAX_DOUBLE;
-      //   else logP(xasg.linear_index()) = std::log(sum);
-      // }
+      const size_t n = joint.size();
+      log_space::scratch_array<size_t> yindex(n);
+      restrict_indices(joint.args(), other.args(), yindex.get());
+      // log joint(x,y) other(y)
+      log_space::scratch_array<double> values(n);
+      for(size_t i = 0; i < n; ++i)
+        values[i] = joint._data[i] + other._data[yindex[i]];
+      log_space::scratch_array<size_t> xindex(n);
+      restrict_indices(joint.args(), args(), xindex.get());
+      log_sum(values.get(), xindex.get(), n);
     }
     
 
@@ -877,25 +869,14 @@ namespace graphlab {
         *this = joint;
         return;
       }
-      // Compute the domain to remove
-      domain_type ydom = joint.args() - args();
-      assert(ydom.num_vars() > 0);
-      
-      // Loop over x
-      for(assignment_type xasg = args().begin(); 
-          xasg < args().end(); ++xasg) {
-        double sum = 0;
-        for(assignment_type yasg = ydom.begin(); 
-            yasg < ydom.end(); ++yasg) {
-          assignment_type joint_asg = xasg & yasg;
-          sum += std::exp(joint.logP(joint_asg.linear_index()));
-        }
-        assert( !std::isinf(sum) );
-        assert( !std::isnan(sum) );
-        assert(sum >= 0.0);
-        if(sum == 0) logP(xasg.linear_index()) = -MAX_DOUBLE;
-        else logP(xasg.linear_index()) = std::log(sum);
-      }
+      assert((joint.args() - args()).num_vars() > 0);
+      assert(args() + joint.args() == joint.args());
+      const size_t n = joint.size();
+      log_space::scratch_array<size_t> xindex(n);
+      restrict_indices(joint.args(), args(), xindex.get());
+      log_space::scratch_array<double> values(n);
+      std::copy(joint._data.begin(), joint._data.end(), values.get());
+      log_sum(values.get(), xindex.get(), n);
     }
 
     //! This = other * damping + this * (1-damping) 
@@ -906,12 +887,9 @@ namespace graphlab {
       if(damping == 0) return;
       assert(damping >= 0.0);
       assert(damping < 1.0);
-      for(size_t i = 0; i < args().size(); ++i) {
-        double val = damping * std::exp(other.logP(i)) + 
-          (1-damping) * std::exp(logP(i));
-        assert(val >= 0);
-        if(val == 0) logP(i) = -MAX_DOUBLE;
-        else logP(i) = std::log(val);
+      if(size() == 0) return;
+      log_space::log_damp(&_data[0], &other._data[0], damping, size());
+      for(size_t i = 0; i < size(); ++i) {
         assert( !std::isinf(logP(i)) );
         assert( !std::isnan(logP(i)) );
       }
@@ -923,10 +901,9 @@ namespace graphlab {
       // This factor must be over the same dimensions as the other
       // factor
       assert(args() == other.args());  
-      double sum = 0;
-      for(size_t i = 0; i < args().size(); ++i) {
-        sum += std::abs(std::exp(other.logP(i)) - std::exp(logP(i)));
-      }
+      if(size() == 0) return 0;
+      const double sum =
+        log_space::l1_exp_distance(&_data[0], &other._data[0], size());
       return sum / args().size();
     }
 
@@ -1014,6 +991,80 @@ namespace graphlab {
     }
     
   private:
+
+    /**
+     * Fill index[i] with the linear index in sub of the i-th
+     * assignment of dom. sub must be a subset of dom.  The assignments
+     * of dom are visited in order by a counter over the variables of
+     * dom which adds the stride of each variable in sub instead of
+     * recomputing the index of every assignment.
+     */
+    static void restrict_indices(const domain_type& dom,
+                                 const domain_type& sub,
+                                 size_t* index) {
+      const size_t nvars = dom.num_vars();
+      if(nvars == 0) return;
+      size_t strides[MAX_DIM];
+      size_t arity[MAX_DIM];
+      size_t counter[MAX_DIM];
+      size_t stride = 1;
+      size_t j = 0;
+      for(size_t i = 0; i < nvars; ++i) {
+        arity[i] = dom.var(i).arity;
+        counter[i] = 0;
+        if(j < sub.num_vars() && sub.var(j) == dom.var(i)) {
+          strides[i] = stride;
+          stride *= arity[i];
+          ++j;
+        } else {
+          strides[i] = 0;
+        }
+      }
+      assert(j == sub.num_vars());
+      size_t base = 0;
+      for(size_t k = 0; k < dom.size(); ) {
+        // The first variable changes fastest
+        for(size_t a = 0; a < arity[0]; ++a) index[k++] = base + a * strides[0];
+        for(size_t i = 1; i < nvars; ++i) {
+          base += strides[i];
+          if(++counter[i] < arity[i]) break;
+          base -= strides[i] * arity[i];
+          counter[i] = 0;
+        }
+      }
+    } // end of restrict_indices
+
+    /** ret[i] = this(x_i) for the i-th assignment of dom */
+    void expand(const domain_type& dom, double* ret) const {
+      log_space::scratch_array<size_t> index(dom.size());
+      restrict_indices(dom, args(), index.get());
+      for(size_t i = 0; i < dom.size(); ++i) ret[i] = _data[index[i]];
+    }
+
+    /**
+     * this(x) = log sum_{i : xindex[i] = x} exp(values[i]).  The sums
+     * are taken relative to the largest value of each x so that they
+     * neither overflow nor vanish. Overwrites values.
+     */
+    void log_sum(double* values, const size_t* xindex, size_t n) {
+      const size_t m = size();
+      log_space::scratch_array<double> maxes(m);
+      std::fill(maxes.get(), maxes.get() + m, -MAX_DOUBLE);
+      for(size_t i = 0; i < n; ++i)
+        maxes[xindex[i]] = std::max(maxes[xindex[i]], values[i]);
+      for(size_t i = 0; i < n; ++i) values[i] -= maxes[xindex[i]];
+      log_space::exp(values, values, n);
+      zero();
+      for(size_t i = 0; i < n; ++i) _data[xindex[i]] += values[i];
+      for(size_t x = 0; x < m; ++x) {
+        assert( !std::isinf(_data[x]) );
+        assert( !std::isnan(_data[x]) );
+        assert(_data[x] > 0.0);
+      }
+      log_space::log(&_data[0], &_data[0], m);
+      log_space::add(&_data[0], maxes.get(), m);
+    } // end of log_sum
+  
     domain_type _args;
     std::vector<double> _data;
   };  // End of unary factor
@@ -0,0 +1,201 @@
+#ifndef GRAPHLAB_BINARY_GRAPH_FORMAT_HPP
+#define GRAPHLAB_BINARY_GRAPH_FORMAT_HPP
+
+#include <cstring>
+#include <cstdio>
+#include <string>
+#include <algorithm>
+#include <stdint.h>
+
+namespace graphlab {
+
+  /**
+   * The arrays of a graph in the binary graph format, in file order.
+   */
+  struct binary_graph_section {
+    enum section_enum {
+      IN_OFFSETS,   ///< num_vertices + 1 edge ids
+      IN_NBRS,      ///< the source of each in edge, grouped by target
+      IN_EIDS,      ///< the id of each in edge, grouped by target
+      OUT_OFFSETS,  ///< num_vertices + 1 edge ids
+      OUT_NBRS,     ///< the target of each out edge, grouped by source
+      OUT_EIDS,     ///< the id of each out edge, grouped by source
+      SOURCES,      ///< the source of each edge
+      TARGETS,      ///< the target of each edge
+      COLORS,       ///< the color of each vertex
+      VERTEX_DATA,  ///< the data of each vertex
+      EDGE_DATA,    ///< the data of each edge
+      NUM_SECTIONS
+    };
+  };
+
+
+  /**
+   * The header of the binary graph format written by
+   * graph::save_binary().
+   *
+   * The header is followed by the CSR adjacency of a finalized graph
+   * and the packed vertex and edge data, each array starting at a
+   * multiple of 64 bytes.  The file is the memory image of these
+   * arrays, in the byte order of the machine which wrote it, so it
+   * can be used in place once mapped (see mapped_graph) or copied
+   * into a graph without parsing (see graph::load_binary()).  The
+   * vertex and edge data must therefore be trivially copyable.
+   *
+   * The sizes of the ids, colors and data are recorded and checked
+   * when the file is opened.
+   */
+  struct binary_graph_header {
+    enum {
+      VERSION = 1,
+      ALIGNMENT = 64,
+      BYTE_ORDER_MARK = 0x01020304
+    };
+
+    /** "GLGRAPH" */
+    char magic[8];
+    uint32_t version;
+    /** BYTE_ORDER_MARK as written by the machine which saved the file */
+    uint32_t byte_order;
+    uint32_t vertex_id_bytes;
+    uint32_t edge_id_bytes;
+    uint32_t color_bytes;
+    uint32_t vertex_data_bytes;
+    uint32_t edge_data_bytes;
+    uint32_t reserved;
+    uint64_t num_vertices;
+    uint64_t num_edges;
+    /** The position of each section in the file */
+    uint64_t section_offset[binary_graph_section::NUM_SECTIONS];
+    /** The size of the file */
+    uint64_t file_bytes;
+
+    /**
+     * Describe a graph of nverts vertices and nedges edges with
+     * vertex_data_bytes and edge_data_bytes of data each.
+     */
+    void init(size_t nverts, size_t nedges,
+              size_t vertex_data_size, size_t edge_data_size,
+              size_t vertex_id_size, size_t edge_id_size,
+              size_t color_size) {
+      memset(this, 0, sizeof(binary_graph_header));
+      strncpy(magic, "GLGRAPH", sizeof(magic));
+      version = VERSION;
+      byte_order = BYTE_ORDER_MARK;
+      vertex_id_bytes = vertex_id_size;
+      edge_id_bytes = edge_id_size;
+      color_bytes = color_size;
+      vertex_data_bytes = vertex_data_size;
+      edge_data_bytes = edge_data_size;
+      num_vertices = nverts;
+      num_edges = nedges;
+      uint64_t offset = align(sizeof(binary_graph_header));
+      for(size_t s = 0; s < binary_graph_section::NUM_SECTIONS; ++s) {
+        section_offset[s] = offset;
+        offset = align(offset + section_bytes(s));
+      }
+      file_bytes = offset;
+    } // end of init
+
+    /** The number of bytes of section s */
+    uint64_t section_bytes(size_t s) const {
+      switch(s) {
+      case binary_graph_section::IN_OFFSETS:
+      case binary_graph_section::OUT_OFFSETS:
+        return (num_vertices + 1) * edge_id_bytes;
+      case binary_graph_section::IN_EIDS:
+      case binary_graph_section::OUT_EIDS:
+        return num_edges * edge_id_bytes;
+      case binary_graph_section::IN_NBRS:
+      case binary_graph_section::OUT_NBRS:
+      case binary_graph_section::SOURCES:
+      case binary_graph_section::TARGETS:
+        return num_edges * vertex_id_bytes;
+      case binary_graph_section::COLORS:
+        return num_vertices * color_bytes;
+      case binary_graph_section::VERTEX_DATA:
+        return num_vertices * vertex_data_bytes;
+      case binary_graph_section::EDGE_DATA:
+        return num_edges * edge_data_bytes;
+      default:
+        return 0;
+      }
+    } // end of section bytes
+
+    /** The array of section s in a file image starting at data */
+    template<typename T>
+    const T* section(const char* data, size_t s) const {
+      return reinterpret_cast<const T*>(data + section_offset[s]);
+    }
+
+    template<typename T>
+    T* section(char* data, size_t s) const {
+      return reinterpret_cast<T*>(data + section_offset[s]);
+    }
+
+    /**
+     * Check that the file image of size bytes starting at data holds
+     * a graph with the given sizes.  Returns an empty string if it
+     * does and the reason otherwise.
+     */
+    static std::string validate(const char* data, size_t size,
+                                size_t vertex_data_size, size_t edge_data_size,
+                                size_t vertex_id_size, size_t edge_id_size,
+                                size_t color_size) {
+      if(size < sizeof(binary_graph_header))
+        return "the file is too small for a header";
+      const binary_graph_header& header =
+        *reinterpret_cast<const binary_graph_header*>(data);
+      if(strncmp(header.magic, "GLGRAPH", sizeof(header.magic)) != 0)
+        return "not a binary graph file";
+      if(header.version != VERSION) return "unsupported format version";
+      if(header.byte_order != BYTE_ORDER_MARK)
+        return "the file was written with a different byte order";
+      if(header.vertex_id_bytes != vertex_id_size ||
+         header.edge_id_bytes != edge_id_size)
+        return "the vertex or edge id type differs";
+      if(header.color_bytes != color_size)
+        return "the vertex color type differs (GRAPHLAB_VERTEX_COLOR_BITS)";
+      if(header.vertex_data_bytes != vertex_data_size ||
+         header.edge_data_bytes != edge_data_size)
+        return "the vertex or edge data type differs";
+      if(header.file_bytes > size) return "the file is truncated";
+      // The sections must be where this version puts them
+      binary_graph_header expected;
+      expected.init(header.num_vertices, header.num_edges,
+                    vertex_data_size, edge_data_size,
+                    vertex_id_size, edge_id_size, color_size);
+      if(memcmp(expected.section_offset, header.section_offset,
+                sizeof(header.section_offset)) != 0 ||
+         expected.file_bytes != header.file_bytes)
+        return "the section layout is inconsistent";
+      return std::string();
+    } // end of validate
+
+    /** Round offset up to the next multiple of ALIGNMENT */
+    static uint64_t align(uint64_t offset) {
+      return (offset + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+    }
+
+    /**
+     * Write bytes of data at offset of a file written sequentially,
+     * padding with zeros from the current position.
+     */
+    static bool write_at(FILE* out, uint64_t offset,
+                         const void* data, size_t bytes) {
+      const long pos = ftell(out);
+      if(pos < 0 || uint64_t(pos) > offset) return false;
+      static const char zeros[ALIGNMENT] = { 0 };
+      size_t padding = offset - pos;
+      while(padding > 0) {
+        const size_t n = std::min(padding, size_t(ALIGNMENT));
+        if(fwrite(zeros, 1, n, out) != n) return false;
+        padding -= n;
+      }
+      return bytes == 0 || fwrite(data, 1, bytes, out) == bytes;
+    } // end of write at
+  }; // end of binary_graph_header
+
+} // end of namespace graphlab
+
+#endif
@@ -25,13 +25,22 @@
 #include <atomic>
 
 #include <boost/bind.hpp>
+#include <boost/static_assert.hpp>
+#include <boost/type_traits/has_trivial_copy.hpp>
 
 
 
 #include <graphlab/logger/logger.hpp>
+#include <graphlab/parallel/pthread_tools.hpp>
+#include <graphlab/parallel/atomic.hpp>
+#include <graphlab/parallel/numa.hpp>
+#include <graphlab/util/timer.hpp>
+#include <graphlab/util/mapped_file.hpp>
+#include <graphlab/graph/binary_graph_format.hpp>
 
 #include <graphlab/serialization/iarchive.hpp>
 #include <graphlab/serialization/oarchive.hpp>
+#include <graphlab/serialization/vector.hpp>
 
 #include <graphlab/extern/metis/metis.hpp>
 
@@ -81,8 +90,75 @@ namespace graphlab {
   /** The type of an edge id */
   typedef uint32_t edge_id_t;
 
+  /**
+   * The number of bits of a vertex color: 8, 16 (the default) or 32.
+   * A coloring uses at most the maximum degree + 1 colors, which must
+   * fit.  Saved graphs are compatible between 16 and 32 bit colors,
+   * which are serialized as 64 bit integers, but not with 8 bit colors.
+   */
+#ifndef GRAPHLAB_VERTEX_COLOR_BITS
+#define GRAPHLAB_VERTEX_COLOR_BITS 16
+#endif
+
   /** Type for vertex colors **/
+#if GRAPHLAB_VERTEX_COLOR_BITS == 8
   typedef uint8_t vertex_color_type;
+#elif GRAPHLAB_VERTEX_COLOR_BITS == 16
+  typedef uint16_t vertex_color_type;
+#elif GRAPHLAB_VERTEX_COLOR_BITS == 32
+  typedef uint32_t vertex_color_type;
+#else
+#error "GRAPHLAB_VERTEX_COLOR_BITS must be 8, 16 or 32"
+#endif
+
+
+  /**
+   * \brief A read-only view over a contiguous array of ids.
+   *
+   * The graph returns adjacency information as id lists rather than
+   * references to std::vectors so that the same interface can be
+   * served either by the per-vertex vectors used while the graph is
+   * being built or by the compressed sparse row arrays built by
+   * graph::finalize().  An id list does not own its memory and is
+   * only valid until the graph structure is modified.
+   */
+  template<typename IdType>
+  class id_list {
+  public:
+    typedef IdType        value_type;
+    typedef const IdType* iterator;
+    typedef const IdType* const_iterator;
+    typedef size_t        size_type;
+
+    id_list() : begin_ptr(NULL), end_ptr(NULL) { }
+
+    id_list(const IdType* begin_ptr, const IdType* end_ptr) :
+      begin_ptr(begin_ptr), end_ptr(end_ptr) { }
+
+    /** Wrap an existing vector (the vector must outlive the list) */
+    id_list(const std::vector<IdType>& vec) :
+      begin_ptr(vec.empty()? NULL : &(vec[0])),
+      end_ptr(vec.empty()? NULL : &(vec[0]) + vec.size()) { }
+
+    size_t size() const { return end_ptr - begin_ptr; }
+    bool empty() const { return begin_ptr == end_ptr; }
+    const IdType& operator[](size_t i) const {
+      assert(i < size());
+      return begin_ptr[i];
+    }
+    const_iterator begin() const { return begin_ptr; }
+    const_iterator end() const { return end_ptr; }
+
+  private:
+    const IdType* begin_ptr;
+    const IdType* end_ptr;
+  }; // end of id_list
+
+  /** A list of edge ids as returned by in_edge_ids()/out_edge_ids() */
+  typedef id_list<edge_id_t> edge_list;
+
+  /** A list of vertex ids as returned by in/out_neighbor_ids() */
+  typedef id_list<vertex_id_t> vertex_list;
 
   
   template<typename VertexData, typename EdgeData> class graph;
@@ -112,7 +188,7 @@ namespace graphlab {
     /**
      * Build a basic graph
      */
-    graph() : finalized(true) {  }
+    graph() : finalized(true), use_csr(true), csr_built(false) {  }
 
     /**
      * BUG: Should not reserve but instead directly create vertices.
@@ -122,7 +198,7 @@ namespace graphlab {
     graph(size_t nverts) : 
       vertices(nverts),
       in_edges(nverts), out_edges(nverts), vcolors(nverts),
-      finalized(true) { }
+      finalized(true), use_csr(true), csr_built(false) { }
 
     graph(const graph<VertexData, EdgeData> &g) { (*this) = g; }
 
@@ -137,53 +213,118 @@ namespace graphlab {
       in_edges.clear();
       out_edges.clear();
       vcolors.clear();
+      clear_csr();
       finalized = true;
     }
     
     /**
      * Finalize a graph by sorting its edges to maximize the
      * efficiency of graphlab.  This is invoked by the engine at
-     * start.
+     * start.  Unless CSR storage was disabled (see
+     * set_csr_storage()) the sorted adjacency lists are then packed
+     * into read-only compressed sparse row arrays and the per-vertex
+     * vectors are released.
+     *
+     * Vertices are processed in parallel by nthreads threads (0 uses
+     * one thread per cpu).  Each adjacency list is sorted on
+     * precomputed (neighbor, edge id) keys held in a per-thread
+     * buffer which is reused across vertices.
      */
-    void finalize() {
-		std::cout<<"finalize graph (sort)"<<std::endl;   
+    void finalize(size_t nthreads = 0) {
       // check to see if the graph is already finalized
-      if(finalized) return;
-      // Assert that the graph is not finalized 
-      typedef std::vector< edge_id_t > edge_set;
-
-      edge_id_less_functor less_functor(this);
+      if(finalized && (csr_built || !use_csr)) return;
+      const bool sort = !finalized;
+      const bool pack = use_csr && !csr_built;
+      timer ti;
+      ti.start();
       
-      // Sort all in edges sets
-      foreach(edge_set& eset, in_edges) {
-        std::sort(eset.begin(),
-                  eset.end(),
-                  less_functor);
-        //                  boost::bind(&graph::edge_id_less, this, _1, _2) );
-        // Test for duplicate edges
-        if (eset.size() > 1) {
-          for(size_t i = 0; i < eset.size()-1; ++i) {
-            // Duplicate edge test
-            assert(edge_id_less(eset[i], eset[i+1]));
-          }
-        }        
+      // Lay out the CSR arrays so that every vertex knows where to
+      // write its sorted lists
+      if(pack) {
+        csr_layout(in_edges, in_offsets, in_nbrs, in_eids);
+        csr_layout(out_edges, out_offsets, out_nbrs, out_eids);
       }
-      // Sort all out edges sets
-      foreach(edge_set& eset, out_edges) {
-        std::sort(eset.begin(),
-                  eset.end(),
-                  less_functor);
-        //                 boost::bind(&graph::edge_id_less, this, _1, _2) );
-        // Test for dupliate edges
-        if (eset.size() > 1) {
-          for(size_t i = 0; i < eset.size()-1; ++i) {
-            // Duplicate edge test
-            assert(edge_id_less(eset[i], eset[i+1]));
-          }
-        }
+      const double layout_time = ti.current_time();
+
+      // Sort (and pack) the adjacency lists of each vertex
+      const size_t chunk_size = 1024;
+      const size_t nchunks = (vertices.size() + chunk_size - 1) / chunk_size;
+      if(nthreads == 0) nthreads = thread::cpu_count();
+      nthreads = std::max(size_t(1), std::min(nthreads, nchunks));
+      atomic<size_t> next_vertex;
+      std::vector<finalize_worker> workers(nthreads,
+        finalize_worker(this, &next_vertex, chunk_size, sort, pack));
+      if(nthreads == 1) {
+        workers[0].run();
+      } else {
+        thread_group threads;
+        for(size_t i = 0; i < workers.size(); ++i) threads.launch(&workers[i]);
+        threads.join();
+      }
+      const double sort_time = ti.current_time() - layout_time;
+
+      // Release the per-vertex vectors
+      if(pack) {
+        // swap with an empty vector to actually free the memory
+        std::vector< std::vector<edge_id_t> >().swap(in_edges);
+        std::vector< std::vector<edge_id_t> >().swap(out_edges);
+        csr_built = true;
       }
       finalized = true;
+      logger(LOG_INFO,
+             "Finalized graph with %lu vertices and %lu edges using %lu threads: "
+             "layout %lf s, sort %lf s, release %lf s",
+             (unsigned long)vertices.size(), (unsigned long)edges.size(),
+             (unsigned long)nthreads, layout_time, sort_time,
+             ti.current_time() - layout_time - sort_time);
     } // End of finalize
+
+
+    /**
+     * Enable or disable the compressed sparse row layout.  When
+     * enabled (the default) finalize() replaces the per-vertex edge
+     * vectors with contiguous offset, neighbor and edge id arrays.
+     * Disabling it converts the graph back to per-vertex vectors.
+     */
+    void set_csr_storage(bool enable) {
+      use_csr = enable;
+      if(!use_csr) release_csr();
+    }
+
+    /** Returns true if the adjacency is currently held in CSR form */
+    bool csr_storage() const { return csr_built; }
+
+
+    /**
+     * Place the graph arrays for NUMA execution.  The data and CSR
+     * adjacency of each block of vertices (see
+     * numa_topology::vertex_node()) are moved to the node owning the
+     * block and the edge array is interleaved over all nodes.  Does
+     * nothing on a single node machine.  Call after finalize().
+     */
+    void place_numa(const numa_topology& numa) {
+      const size_t nnodes = numa.num_nodes();
+      if(nnodes < 2 || vertices.empty()) return;
+      const size_t nverts = vertices.size();
+      bool placed = true;
+      for(size_t node = 0; node < nnodes; ++node) {
+        const size_t begin = numa.node_vertex_begin(node, nverts);
+        const size_t end = numa.node_vertex_begin(node + 1, nverts);
+        if(begin >= end) continue;
+        placed &= numa.bind_memory(&vertices[begin],
+                                   (end - begin) * sizeof(VertexData), node);
+        if(csr_built) {
+          placed &= bind_csr(numa, node, begin, end,
+                             in_offsets, in_nbrs, in_eids);
+          placed &= bind_csr(numa, node, begin, end,
+                             out_offsets, out_nbrs, out_eids);
+        }
+      }
+      if(!edges.empty())
+        placed &= numa.interleave_memory(&edges[0], edges.size() * sizeof(edge));
+      if(!placed) 
+        logger(LOG_WARNING, "Could not place all graph memory on its NUMA node");
+    } // end of place_numa
             
     /** Get the number of vetices */
     size_t num_vertices() const {
@@ -199,20 +340,23 @@ namespace graphlab {
     /** Get the number of in edges */
     size_t num_in_neighbors(vertex_id_t v) const {
       assert(v < vertices.size());
+      if(csr_built) return in_offsets[v+1] - in_offsets[v];
       return in_edges[v].size();
     } // end of num vertices
     
     /** get the number of out edges */
     size_t num_out_neighbors(vertex_id_t v) const  {
       assert(v < vertices.size());
+      if(csr_built) return out_offsets[v+1] - out_offsets[v];
       return out_edges[v].size();
     } // end of num vertices
 
     /** Find an edge */
     std::pair<bool, edge_id_t>
     find(vertex_id_t source, vertex_id_t target) const {
-      assert(source < in_edges.size());
-      assert(target < out_edges.size());
+      assert(source < vertices.size());
+      assert(target < vertices.size());
+      if(csr_built) return csr_find(source, target);
       // Check the base case that the souce or target have no edges
       if (in_edges[target].size() == 0 ||
           out_edges[source].size() == 0) {
@@ -288,6 +432,7 @@ namespace graphlab {
      * of the new vertex id.
      */
     vertex_id_t add_vertex(const VertexData& vdata = VertexData() ) {
+      release_csr();
       vertices.push_back(vdata);
       // Resize edge maps
       out_edges.resize(vertices.size());
@@ -303,6 +448,7 @@ namespace graphlab {
      */
     void resize(size_t num_vertices ) {
       assert(num_vertices >= vertices.size());
+      release_csr();
       vertices.resize(num_vertices);
       // Resize edge maps
       out_edges.resize(vertices.size());
@@ -325,6 +471,8 @@ namespace graphlab {
         assert(source < vertices.size());
         assert(target < vertices.size());
       }
+      // The CSR arrays are read-only so fall back to the vectors
+      release_csr();
       // Add the edge to the set of edge data (this copies the edata)
       edges.push_back( edge( source, target, edata ) );
 
@@ -361,6 +509,16 @@ namespace graphlab {
       return vertices[v];
     } // end of data(v)
 
+    /**
+     * Exchange the data of all vertices with the contents of other,
+     * which must hold one entry per vertex.  This takes constant time
+     * and is used to double buffer vertex data.
+     */
+    void swap_vertex_data(std::vector<VertexData>& other) {
+      assert(other.size() == vertices.size());
+      vertices.swap(other);
+    } // end of swap_vertex_data
+
     /** Get the edge_data */
     EdgeData& edge_data(vertex_id_t source, vertex_id_t target) {
       assert(source < vertices.size());
@@ -428,46 +586,39 @@ namespace graphlab {
     }
 
 
-    /** This function constructs a coloring for the graph and returns
-        the number of colors */
-    size_t compute_coloring() {
-      // Reset the colors
-      for(vertex_id_t v = 0; v < num_vertices(); ++v) color(v) = 0;
-      // construct a permuation of the vertices to use in the greedy
-      // coloring. \todo Should probably sort by degree instead when
-      // constructing greedy coloring.
-      std::vector<vertex_id_t> permutation(num_vertices());
-      for(vertex_id_t v = 0; v < num_vertices(); ++v) 
-        permutation[v] = v;
-      std::random_shuffle(permutation.begin(), permutation.end());
-      // Recolor
-      size_t max_color = 0;
-      std::set<vertex_color_type> neighbor_colors;
-      for(size_t i = 0; i < permutation.size(); ++i) {
-        neighbor_colors.clear();
-        const vertex_id_t& vid = permutation[i];
-        const std::vector<edge_id_t>& in_edges = in_edge_ids(vid);
-        // Get the neighbor colors
-        foreach(edge_id_t eid, in_edges){
-          const vertex_id_t& neighbor_vid = source(eid);
-          const vertex_color_type& neighbor_color = color(neighbor_vid);
-          neighbor_colors.insert(neighbor_color);
-        }
-        // Find the lowest free color
-        vertex_color_type& vertex_color = color(vid);
-        foreach(vertex_color_type neighbor_color, neighbor_colors) {
-          if(vertex_color != neighbor_color) break;
-          else vertex_color++;
-          // Ensure no wrap around
-          assert(vertex_color != 0);                
-        }
-        max_color = std::max(max_color, size_t(vertex_color) );
-      }
-      // Return the NUMBER of colors
-      return max_color + 1;           
+    /**
+     * Constructs a coloring of the graph in which no two vertices
+     * joined by an edge, in either direction, share a color, and
+     * returns the number of colors.
+     *
+     * This is the Jones-Plassmann algorithm: vertices are ordered by
+     * degree, highest first, with ties broken by a hash of the vertex
+     * id, and a vertex takes the lowest color not used by its
+     * neighbors once every neighbor before it has a color.  The
+     * vertices which become ready together are colored in parallel by
+     * nthreads threads (0 uses one thread per cpu) and the coloring
+     * does not depend on the number of threads.  At most the maximum
+     * degree + 1 colors are used.
+     */
+    size_t compute_coloring(size_t nthreads = 0) {
+      return jones_plassmann(nthreads, false);
     } // end of compute coloring
 
 
+    /**
+     * Constructs a coloring of the graph in which no two vertices
+     * joined by a path of one or two edges share a color, and returns
+     * the number of colors.  The neighborhoods of two vertices of the
+     * same color are then disjoint, which is what full consistency
+     * needs.  The algorithm is that of compute_coloring() run over the
+     * paths of up to two edges.
+     */
+    size_t compute_distance2_coloring(size_t nthreads = 0) {
+      return jones_plassmann(nthreads, true);
+    } // end of compute distance2 coloring
+
+
+
     /**
      * Check that the colors satisfy a valid coloring of the graph.
      * return true is coloring is valid;
@@ -475,9 +626,8 @@ namespace graphlab {
     bool valid_coloring() {
       for(vertex_id_t vid = 0; vid < num_vertices(); ++vid) {
         const vertex_color_type& vertex_color = color(vid);
-        const std::vector<edge_id_t>& in_edges = in_edge_ids(vid);
         // Get the neighbor colors
-        foreach(edge_id_t eid, in_edges){
+        foreach(edge_id_t eid, in_edge_ids(vid)){
           const vertex_id_t& neighbor_vid = source(eid);
           const vertex_color_type& neighbor_color = color(neighbor_vid);
           if(vertex_color == neighbor_color) return false;
@@ -485,20 +635,93 @@ namespace graphlab {
       }
       return true;
     }
+
+
+    /**
+     * Check that no two vertices joined by a path of one or two
+     * edges share a color, that is that every vertex and its
+     * neighbors all have different colors.
+     */
+    bool valid_distance2_coloring() {
+      std::vector<vertex_id_t> nbrs;
+      std::vector<vertex_color_type> colors;
+      for(vertex_id_t vid = 0; vid < num_vertices(); ++vid) {
+        nbrs.clear();
+        nbrs.push_back(vid);
+        foreach(edge_id_t eid, in_edge_ids(vid)) nbrs.push_back(source(eid));
+        foreach(edge_id_t eid, out_edge_ids(vid)) nbrs.push_back(target(eid));
+        std::sort(nbrs.begin(), nbrs.end());
+        nbrs.erase(std::unique(nbrs.begin(), nbrs.end()), nbrs.end());
+        colors.clear();
+        foreach(vertex_id_t u, nbrs) colors.push_back(color(u));
+        std::sort(colors.begin(), colors.end());
+        if(std::adjacent_find(colors.begin(), colors.end()) != colors.end())
+          return false;
+      }
+      return true;
+    }
     
     
     /** Get the ids of the in edges */
-    const std::vector<edge_id_t>& in_edge_ids(vertex_id_t v) const {
-      assert(v < in_edges.size());
-      return in_edges[v];
+    edge_list in_edge_ids(vertex_id_t v) const {
+      assert(v < vertices.size());
+      if(csr_built) return csr_range(in_offsets, in_eids, v);
+      return edge_list(in_edges[v]);
     } // end of in edges    
 
     /** Get the ids of the out edges */
-    const std::vector<edge_id_t>& out_edge_ids(vertex_id_t v) const {
-      assert(v < out_edges.size());
-      return out_edges[v];
+    edge_list out_edge_ids(vertex_id_t v) const {
+      assert(v < vertices.size());
+      if(csr_built) return csr_range(out_offsets, out_eids, v);
+      return edge_list(out_edges[v]);
     } // end of out edges
 
+    /**
+     * Get the sources of the in edges in the same order as
+     * in_edge_ids(v).  Only available in CSR storage.
+     */
+    vertex_list in_neighbor_ids(vertex_id_t v) const {
+      assert(v < vertices.size());
+      assert(csr_built);
+      return csr_range(in_offsets, in_nbrs, v);
+    } // end of in neighbors
+
+    /**
+     * Get the targets of the out edges in the same order as
+     * out_edge_ids(v).  Only available in CSR storage.
+     */
+    vertex_list out_neighbor_ids(vertex_id_t v) const {
+      assert(v < vertices.size());
+      assert(csr_built);
+      return csr_range(out_offsets, out_nbrs, v);
+    } // end of out neighbors
+
+
+    /**
+     * Estimate the number of bytes used to store the adjacency
+     * structure (not counting vertex and edge data).  For the vector
+     * layout this includes a per-allocation malloc overhead.
+     */
+    size_t adjacency_memory_usage() const {
+      const size_t malloc_overhead = 2 * sizeof(size_t);
+      size_t bytes = 0;
+      if(csr_built) {
+        bytes += (in_offsets.capacity() + out_offsets.capacity() +
+                  in_eids.capacity() + out_eids.capacity()) * sizeof(edge_id_t);
+        bytes += (in_nbrs.capacity() + out_nbrs.capacity()) * sizeof(vertex_id_t);
+      } else {
+        bytes += (in_edges.capacity() + out_edges.capacity()) *
+          sizeof(std::vector<edge_id_t>);
+        for(size_t i = 0; i < in_edges.size(); ++i) {
+          if(in_edges[i].capacity() > 0) 
+            bytes += in_edges[i].capacity() * sizeof(edge_id_t) + malloc_overhead;
+          if(out_edges[i].capacity() > 0) 
+            bytes += out_edges[i].capacity() * sizeof(edge_id_t) + malloc_overhead;
+        }
+      }
+      return bytes;
+    } // end of adjacency memory usage
+
 
     /** Load the graph from an archive */
     void load(iarchive& arc) {
@@ -516,10 +739,17 @@ namespace graphlab {
     void save(oarchive& arc) const {
       // Write the number of edges and vertices
       arc << vertices
-          << edges
-          << in_edges
-          << out_edges
-          << vcolors
+          << edges;
+      // The CSR arrays are written in the same format as the
+      // per-vertex vectors so that either layout can be loaded
+      if(csr_built) {
+        save_csr_lists(arc, in_offsets, in_eids);
+        save_csr_lists(arc, out_offsets, out_eids);
+      } else {
+        arc << in_edges
+            << out_edges;
+      }
+      arc << vcolors
           << finalized;
     } // end of save
     
@@ -544,6 +774,147 @@ namespace graphlab {
       fout.close();
     } // end of save
 
+
+    /**
+     * \brief save the graph in the binary graph format.
+     *
+     * Writes the CSR adjacency, colors and packed vertex and edge
+     * data of a finalized graph as described in binary_graph_header.
+     * The file can be read back with load_binary() or used in place
+     * with mapped_graph.  VertexData and EdgeData must be trivially
+     * copyable.  Returns false if the graph is not finalized or the
+     * file could not be written.
+     */
+    bool save_binary(const std::string& filename) const {
+      BOOST_STATIC_ASSERT(boost::has_trivial_copy<VertexData>::value);
+      BOOST_STATIC_ASSERT(boost::has_trivial_copy<EdgeData>::value);
+      typedef binary_graph_section section;
+      if(!finalized) {
+        logger(LOG_ERROR, "Cannot save %s: the graph must be finalized",
+               filename.c_str());
+        return false;
+      }
+      timer ti;
+      ti.start();
+      // A graph kept in the vector layout is packed for the file
+      std::vector<edge_id_t> tmp_in_offsets, tmp_in_eids,
+        tmp_out_offsets, tmp_out_eids;
+      std::vector<vertex_id_t> tmp_in_nbrs, tmp_out_nbrs;
+      if(!csr_built) {
+        pack_lists(in_edges, true, tmp_in_offsets, tmp_in_nbrs, tmp_in_eids);
+        pack_lists(out_edges, false, tmp_out_offsets, tmp_out_nbrs,
+                   tmp_out_eids);
+      }
+      const void* arrays[section::NUM_SECTIONS] = {
+        vector_data(csr_built ? in_offsets : tmp_in_offsets),
+        vector_data(csr_built ? in_nbrs : tmp_in_nbrs),
+        vector_data(csr_built ? in_eids : tmp_in_eids),
+        vector_data(csr_built ? out_offsets : tmp_out_offsets),
+        vector_data(csr_built ? out_nbrs : tmp_out_nbrs),
+        vector_data(csr_built ? out_eids : tmp_out_eids),
+        NULL, NULL,  // the edge sources and targets are gathered below
+        vector_data(vcolors),
+        vector_data(vertices),
+        NULL
+      };
+      binary_graph_header header;
+      header.init(vertices.size(), edges.size(),
+                  sizeof(VertexData), sizeof(EdgeData),
+                  sizeof(vertex_id_t), sizeof(edge_id_t),
+                  sizeof(vertex_color_type));
+
+      FILE* out = fopen(filename.c_str(), "wb");
+      if(out == NULL) {
+        logger(LOG_ERROR, "Cannot open %s for writing", filename.c_str());
+        return false;
+      }
+      bool success = fwrite(&header, sizeof(header), 1, out) == 1;
+      for(size_t s = 0; success && s < section::NUM_SECTIONS; ++s) {
+        if(s == section::SOURCES || s == section::TARGETS ||
+           s == section::EDGE_DATA) {
+          success = save_edge_section(out, header, s);
+        } else {
+          success = binary_graph_header::write_at(out, header.section_offset[s],
+                                                  arrays[s],
+                                                  header.section_bytes(s));
+        }
+      }
+      // pad the file to its full size
+      success = success &&
+        binary_graph_header::write_at(out, header.file_bytes, NULL, 0);
+      success = (fclose(out) == 0) && success;
+      if(!success) {
+        logger(LOG_ERROR, "Error writing %s", filename.c_str());
+        return false;
+      }
+      logger(LOG_INFO, "Saved binary graph %s (%lu bytes) in %lf s",
+             filename.c_str(), (unsigned long)header.file_bytes,
+             ti.current_time());
+      return true;
+    } // end of save binary
+
+
+    /**
+     * \brief load a graph saved with save_binary().
+     *
+     * The file is mapped and its arrays copied straight into the
+     * graph, which is then finalized and in CSR storage (or in the
+     * vector layout if CSR storage was disabled).  Returns false and
+     * leaves the graph unchanged if the file is not a binary graph of
+     * this VertexData and EdgeData.
+     */
+    bool load_binary(const std::string& filename) {
+      BOOST_STATIC_ASSERT(boost::has_trivial_copy<VertexData>::value);
+      BOOST_STATIC_ASSERT(boost::has_trivial_copy<EdgeData>::value);
+      typedef binary_graph_section section;
+      timer ti;
+      ti.start();
+      mapped_file file;
+      if(!file.open(filename)) return false;
+      const std::string error =
+        binary_graph_header::validate(file.data(), file.size(),
+                                      sizeof(VertexData), sizeof(EdgeData),
+                                      sizeof(vertex_id_t), sizeof(edge_id_t),
+                                      sizeof(vertex_color_type));
+      if(!error.empty()) {
+        logger(LOG_ERROR, "Cannot load %s: %s", filename.c_str(),
+               error.c_str());
+        return false;
+      }
+      file.prefetch();
+      const binary_graph_header& header =
+        *reinterpret_cast<const binary_graph_header*>(file.data());
+      const size_t nverts = header.num_vertices;
+      const size_t nedges = header.num_edges;
+      const char* data = file.data();
+      clear();
+      load_section(header, data, section::IN_OFFSETS, nverts + 1, in_offsets);
+      load_section(header, data, section::IN_NBRS, nedges, in_nbrs);
+      load_section(header, data, section::IN_EIDS, nedges, in_eids);
+      load_section(header, data, section::OUT_OFFSETS, nverts + 1, out_offsets);
+      load_section(header, data, section::OUT_NBRS, nedges, out_nbrs);
+      load_section(header, data, section::OUT_EIDS, nedges, out_eids);
+      load_section(header, data, section::COLORS, nverts, vcolors);
+      load_section(header, data, section::VERTEX_DATA, nverts, vertices);
+      const vertex_id_t* sources =
+        header.section<vertex_id_t>(data, section::SOURCES);
+      const vertex_id_t* targets =
+        header.section<vertex_id_t>(data, section::TARGETS);
+      const EdgeData* edata =
+        header.section<EdgeData>(data, section::EDGE_DATA);
+      edges.reserve(nedges);
+      for(size_t i = 0; i < nedges; ++i)
+        edges.push_back(edge(sources[i], targets[i], edata[i]));
+      csr_built = true;
+      finalized = true;
+      if(!use_csr) release_csr();
+      logger(LOG_INFO,
+             "Loaded binary graph %s with %lu vertices and %lu edges in %lf s",
+             filename.c_str(), (unsigned long)nverts, (unsigned long)nedges,
+             ti.current_time());
+      return true;
+    } // end of load binary
+
     /**
      * \brief save the adjacency structure to a text file.
      *
@@ -1055,15 +1426,6 @@ namespace graphlab {
 
 
     
-    struct edge_id_less_functor {
-      graph* g_ptr;
-      edge_id_less_functor(graph* g_ptr) : g_ptr(g_ptr) { }
-      bool operator()(edge_id_t a, edge_id_t b) {
-        return g_ptr->edge_id_less(a,b);
-      }
-    };
-    
-
     
     /**
      * Used to order edge ids in the in and out edges vectors based on
@@ -1099,6 +1461,32 @@ namespace graphlab {
         costly procedure but it can also dramatically improve
         performance. */
     bool finalized;
+
+    /** Whether finalize() should build the CSR arrays */
+    bool use_csr;
+
+    /** True when the adjacency is held in the CSR arrays below and
+        the in_edges/out_edges vectors are empty */
+    bool csr_built;
+
+    /** CSR offsets: the in edges of v are at [in_offsets[v],
+        in_offsets[v+1]) in in_nbrs and in_eids */
+    std::vector<edge_id_t> in_offsets;
+
+    /** The source of each in edge, grouped by target */
+    std::vector<vertex_id_t> in_nbrs;
+
+    /** The id of each in edge, grouped by target */
+    std::vector<edge_id_t> in_eids;
+
+    /** CSR offsets for the out edges */
+    std::vector<edge_id_t> out_offsets;
+
+    /** The target of each out edge, grouped by source */
+    std::vector<vertex_id_t> out_nbrs;
+
+    /** The id of each out edge, grouped by source */
+    std::vector<edge_id_t> out_eids;
     
     
     // PRIVATE HELPERS =========================================================>
@@ -1120,7 +1508,8 @@ namespace graphlab {
           return mid;
         } else if(std::make_pair(source, target) <
                   std::make_pair(mid_source, mid_target) ) {
-          // Search left
+          // Search left (stop before last underflows)
+          if(mid == 0) break;
           last = mid - 1;
         } else {
           // Search right
@@ -1130,7 +1519,498 @@ namespace graphlab {
       // We failed to find
       return -1;
     } // end of binary search 
-    
+
+
+    /** Get the slice of a CSR array belonging to vertex v */
+    static id_list<edge_id_t> csr_range(const std::vector<edge_id_t>& offsets,
+                                        const std::vector<edge_id_t>& ids,
+                                        vertex_id_t v) {
+      if(ids.empty()) return id_list<edge_id_t>();
+      const edge_id_t* base = &(ids[0]);
+      return id_list<edge_id_t>(base + offsets[v], base + offsets[v+1]);
+    } // end of csr range
+
+
+    /**
+     * Binary search the neighbor array of whichever endpoint has the
+     * smaller degree.
+     */
+    std::pair<bool, edge_id_t> csr_find(vertex_id_t source,
+                                        vertex_id_t target) const {
+      const bool use_in = num_in_neighbors(target) < num_out_neighbors(source);
+      const vertex_list nbrs = use_in ?
+        in_neighbor_ids(target) : out_neighbor_ids(source);
+      const vertex_id_t key = use_in ? source : target;
+      const vertex_id_t* pos = std::lower_bound(nbrs.begin(), nbrs.end(), key);
+      if(pos == nbrs.end() || *pos != key) return std::make_pair(false, -1);
+      const edge_list eids = use_in ? in_edge_ids(target) : out_edge_ids(source);
+      return std::make_pair(true, eids[pos - nbrs.begin()]);
+    } // end of csr find
+
+
+    /** Bind the CSR arrays of the vertices [begin, end) to node */
+    static bool bind_csr(const numa_topology& numa, size_t node,
+                         size_t begin, size_t end,
+                         const std::vector<edge_id_t>& offsets,
+                         const std::vector<vertex_id_t>& nbrs,
+                         const std::vector<edge_id_t>& eids) {
+      bool placed = numa.bind_memory(&offsets[begin],
+                                     (end - begin) * sizeof(edge_id_t), node);
+      const size_t first = offsets[begin];
+      const size_t last = offsets[end];
+      if(last > first) {
+        placed &= numa.bind_memory(&nbrs[first],
+                                   (last - first) * sizeof(vertex_id_t), node);
+        placed &= numa.bind_memory(&eids[first],
+                                   (last - first) * sizeof(edge_id_t), node);
+      }
+      return placed;
+    } // end of bind_csr
+
+    /**
+     * Compute the CSR offsets of one direction from the per-vertex
+     * edge vectors and size the neighbor and edge id arrays.
+     */
+    void csr_layout(const std::vector< std::vector<edge_id_t> >& adj,
+                    std::vector<edge_id_t>& offsets,
+                    std::vector<vertex_id_t>& nbrs,
+                    std::vector<edge_id_t>& eids) const {
+      offsets.resize(vertices.size() + 1);
+      offsets[0] = 0;
+      for(size_t v = 0; v < vertices.size(); ++v) 
+        offsets[v+1] = offsets[v] + adj[v].size();
+      nbrs.resize(offsets[vertices.size()]);
+      eids.resize(offsets[vertices.size()]);
+    } // end of csr layout
+
+
+    /**
+     * Sort one adjacency list on (neighbor, edge id) keys.  The keys
+     * are built once per list so the sort does not dereference the
+     * edges.  If nbrs and eids are given the sorted list is written
+     * there (CSR), otherwise it is written back to eset.
+     */
+    void finalize_adjacency(std::vector<edge_id_t>& eset, bool incoming,
+                            std::vector<uint64_t>& keys, bool sort,
+                            vertex_id_t* nbrs, edge_id_t* eids) const {
+      keys.resize(eset.size());
+      for(size_t i = 0; i < eset.size(); ++i) {
+        const edge& e = edges[eset[i]];
+        const uint64_t nbr = incoming? e.source() : e.target();
+        keys[i] = (nbr << 32) | eset[i];
+      }
+      if(sort) {
+        std::sort(keys.begin(), keys.end());
+        // Duplicate edge test
+        for(size_t i = 1; i < keys.size(); ++i) {
+          assert((keys[i-1] >> 32) != (keys[i] >> 32));
+        }
+      }
+      for(size_t i = 0; i < keys.size(); ++i) {
+        if(nbrs != NULL) {
+          nbrs[i] = vertex_id_t(keys[i] >> 32);
+          eids[i] = edge_id_t(keys[i]);
+        } else {
+          eset[i] = edge_id_t(keys[i]);
+        }
+      }
+    } // end of finalize adjacency
+
+
+    /** Sort and pack the in and out edges of a single vertex */
+    void finalize_vertex(vertex_id_t v, std::vector<uint64_t>& keys,
+                         bool sort, bool pack) {
+      finalize_adjacency(in_edges[v], true, keys, sort,
+                         pack? csr_begin(in_nbrs, in_offsets[v]) : NULL,
+                         pack? csr_begin(in_eids, in_offsets[v]) : NULL);
+      finalize_adjacency(out_edges[v], false, keys, sort,
+                         pack? csr_begin(out_nbrs, out_offsets[v]) : NULL,
+                         pack? csr_begin(out_eids, out_offsets[v]) : NULL);
+    } // end of finalize vertex
+
+
+    /** Pointer to position pos of a CSR array (NULL if empty) */
+    static uint32_t* csr_begin(std::vector<uint32_t>& vec, size_t pos) {
+      return vec.empty()? NULL : &(vec[0]) + pos;
+    }
+
+
+    /**
+     * Worker used by finalize().  Each worker repeatedly claims the
+     * next chunk of vertices so that high degree vertices do not
+     * leave threads idle.
+     */
+    class finalize_worker : public runnable {
+    public:
+      finalize_worker(graph* g, atomic<size_t>* next_vertex,
+                      size_t chunk_size, bool sort, bool pack) :
+        g(g), next_vertex(next_vertex), chunk_size(chunk_size),
+        sort(sort), pack(pack) { }
+      void run() {
+        // The key buffer grows to the largest degree seen and is
+        // then reused for every vertex of this worker
+        std::vector<uint64_t> keys;
+        const size_t nverts = g->vertices.size();
+        while(true) {
+          const size_t begin = next_vertex->inc(chunk_size) - chunk_size;
+          if(begin >= nverts) break;
+          const size_t end = std::min(begin + chunk_size, nverts);
+          for(size_t v = begin; v < end; ++v) {
+            g->finalize_vertex(v, keys, sort, pack);
+          }
+        }
+      }
+    private:
+      graph* g;
+      atomic<size_t>* next_vertex;
+      size_t chunk_size;
+      bool sort;
+      bool pack;
+    }; // end of finalize worker
+
+
+    /** The shared state of the workers of jones_plassmann() */
+    struct coloring_state {
+      /** The order of the vertices: (degree, hash), highest first */
+      std::vector<uint64_t> rank;
+      /** The number of uncolored neighbors before each vertex */
+      std::vector<uint32_t> waiting;
+      /** The vertices to color in this round */
+      std::vector<vertex_id_t> frontier;
+      /** The next vertex (or frontier entry) to claim */
+      atomic<size_t> next_item;
+      /** True in the first round, which counts the waiting neighbors */
+      bool counting;
+      /** True for a distance-2 coloring */
+      bool distance2;
+    };
+
+    /** The number of vertices a coloring worker claims at a time */
+    enum { coloring_chunk_size = 256 };
+
+    /** A hash of a vertex id used to break ties between degrees */
+    static uint32_t coloring_hash(vertex_id_t v) {
+      uint64_t x = uint64_t(v) * 0x9E3779B97F4A7C15ULL;
+      return uint32_t(x >> 32);
+    }
+
+    /** True if vertex u is colored before vertex v */
+    static bool colored_before(const coloring_state& state,
+                               vertex_id_t u, vertex_id_t v) {
+      return state.rank[u] > state.rank[v] ||
+        (state.rank[u] == state.rank[v] && u < v);
+    }
+
+
+    /**
+     * Worker used by jones_plassmann().  In the first round a worker
+     * counts the neighbors colored before each vertex of the chunks it
+     * claims.  In the later rounds it colors the vertices of the
+     * frontier chunks it claims and releases their neighbors.  The
+     * vertices found ready are kept in ready for the next round.
+     *
+     * For a distance-2 coloring the neighbors of a vertex are the
+     * ends of its paths of one and two edges, counted once per path.
+     * There are as many paths from u to v as from v to u so the counts
+     * and the releases agree.
+     */
+    class coloring_worker : public runnable {
+    public:
+      coloring_worker(graph* g, coloring_state* state, size_t chunk_size) :
+        g(g), state(state), chunk_size(chunk_size) { }
+
+      void run() {
+        const size_t nitems = state->counting ?
+          g->vertices.size() : state->frontier.size();
+        while(true) {
+          const size_t begin =
+            state->next_item.inc(chunk_size) - chunk_size;
+          if(begin >= nitems) break;
+          const size_t end = std::min(begin + chunk_size, nitems);
+          for(size_t i = begin; i < end; ++i) {
+            if(state->counting) count_waiting(vertex_id_t(i));
+            else color_vertex(state->frontier[i]);
+          }
+        }
+      }
+
+      /** The vertices which became ready in the last round */
+      std::vector<vertex_id_t> ready;
+
+    private:
+      void count_waiting(vertex_id_t v) {
+        gather_neighbors(v);
+        uint32_t count = 0;
+        foreach(vertex_id_t u, nbrs) {
+          if(colored_before(*state, u, v)) ++count;
+        }
+        state->waiting[v] = count;
+        if(count == 0) ready.push_back(v);
+      }
+
+      void color_vertex(vertex_id_t v) {
+        gather_neighbors(v);
+        // Mark the colors of the neighbors, which are all colored if
+        // they come before v. Only the first nbrs.size() + 1 colors
+        // matter.
+        used.assign(nbrs.size() + 1, false);
+        foreach(vertex_id_t u, nbrs) {
+          if(colored_before(*state, u, v) && g->vcolors[u] < used.size()) {
+            used[g->vcolors[u]] = true;
+          }
+        }
+        size_t c = 0;
+        while(used[c]) ++c;
+        ASSERT_MSG(c <= size_t(vertex_color_type(-1)),
+                   "Vertex %lu needs more colors than "
+                   "GRAPHLAB_VERTEX_COLOR_BITS allows", (unsigned long)v);
+        g->vcolors[v] = vertex_color_type(c);
+        // Release the neighbors waiting on v
+        foreach(vertex_id_t u, nbrs) {
+          if(colored_before(*state, v, u) &&
+             __sync_sub_and_fetch(&state->waiting[u], 1) == 0) {
+            ready.push_back(u);
+          }
+        }
+      }
+
+      /** Fill nbrs with the neighbors of v */
+      void gather_neighbors(vertex_id_t v) {
+        nbrs.clear();
+        add_adjacent(v, v);
+        if(state->distance2) {
+          const size_t nadjacent = nbrs.size();
+          for(size_t i = 0; i < nadjacent; ++i) add_adjacent(nbrs[i], v);
+        }
+      }
+
+      /** Add the vertices adjacent to u other than v to nbrs */
+      void add_adjacent(vertex_id_t u, vertex_id_t v) {
+        foreach(edge_id_t eid, g->in_edge_ids(u)) {
+          if(g->source(eid) != v) nbrs.push_back(g->source(eid));
+        }
+        foreach(edge_id_t eid, g->out_edge_ids(u)) {
+          if(g->target(eid) != v) nbrs.push_back(g->target(eid));
+        }
+      }
+
+      graph* g;
+      coloring_state* state;
+      size_t chunk_size;
+      /** The neighbors of the current vertex */
+      std::vector<vertex_id_t> nbrs;
+      /** The colors used by the neighbors of the current vertex */
+      std::vector<bool> used;
+    }; // end of coloring worker
+
+
+    /** Runs one round of jones_plassmann() over nitems items */
+    void run_coloring_workers(std::vector<coloring_worker>& workers,
+                              size_t nitems) {
+      const size_t nchunks = (nitems + coloring_chunk_size - 1) /
+        coloring_chunk_size;
+      const size_t nthreads = std::max(size_t(1),
+                                       std::min(workers.size(), nchunks));
+      if(nthreads == 1) {
+        workers[0].run();
+      } else {
+        thread_group threads;
+        for(size_t i = 0; i < nthreads; ++i) threads.launch(&workers[i]);
+        threads.join();
+      }
+    } // end of run coloring workers
+
+
+    /**
+     * The Jones-Plassmann coloring behind compute_coloring() and
+     * compute_distance2_coloring().  Returns the number of colors.
+     */
+    size_t jones_plassmann(size_t nthreads, bool distance2) {
+      timer ti;
+      ti.start();
+      const size_t nverts = vertices.size();
+      coloring_state state;
+      state.distance2 = distance2;
+      state.rank.resize(nverts);
+      state.waiting.resize(nverts);
+      size_t maxdegree = 0;
+      for(vertex_id_t v = 0; v < nverts; ++v) {
+        const size_t degree =
+          in_edge_ids(v).size() + out_edge_ids(v).size();
+        maxdegree = std::max(maxdegree, degree);
+        state.rank[v] = (uint64_t(degree) << 32) | coloring_hash(v);
+      }
+
+      if(nthreads == 0) nthreads = thread::cpu_count();
+      nthreads = std::max(size_t(1), nthreads);
+      std::vector<coloring_worker> workers(nthreads,
+                                           coloring_worker(this, &state,
+                                                           coloring_chunk_size));
+      // The first round counts the neighbors before each vertex and
+      // finds the vertices with none, which can be colored at once
+      state.counting = true;
+      size_t nrounds = 0;
+      do {
+        state.next_item.value = 0;
+        run_coloring_workers(workers, state.counting ?
+                             nverts : state.frontier.size());
+        state.counting = false;
+        // Gather the vertices which became ready in this round
+        state.frontier.clear();
+        for(size_t i = 0; i < workers.size(); ++i) {
+          state.frontier.insert(state.frontier.end(),
+                                workers[i].ready.begin(),
+                                workers[i].ready.end());
+          workers[i].ready.clear();
+        }
+        ++nrounds;
+      } while(!state.frontier.empty());
+
+      // Report the number and balance of the color classes
+      std::vector<size_t> class_sizes;
+      for(vertex_id_t v = 0; v < nverts; ++v) {
+        if(color(v) >= class_sizes.size()) class_sizes.resize(color(v) + 1, 0);
+        ++class_sizes[color(v)];
+      }
+      const size_t ncolors = class_sizes.size();
+      const size_t minclass = ncolors == 0 ? 0 :
+        *std::min_element(class_sizes.begin(), class_sizes.end());
+      const size_t maxclass = ncolors == 0 ? 0 :
+        *std::max_element(class_sizes.begin(), class_sizes.end());
+      logger(LOG_INFO,
+             "Colored %lu vertices with %lu colors (distance %d, max degree %lu) "
+             "in %lf s "
+             "using %lu threads and %lu rounds: color classes of %lu to %lu "
+             "vertices, mean %lf",
+             (unsigned long)nverts, (unsigned long)ncolors,
+             distance2 ? 2 : 1, (unsigned long)maxdegree, ti.current_time(),
+             (unsigned long)nthreads, (unsigned long)nrounds,
+             (unsigned long)minclass, (unsigned long)maxclass,
+             ncolors == 0 ? 0.0 : double(nverts) / double(ncolors));
+      return ncolors;
+    } // end of jones plassmann
+
+
+
+    /** Unpack one direction of the CSR arrays into per-vertex vectors */
+    void unpack_csr(std::vector< std::vector<edge_id_t> >& adj,
+                    const std::vector<edge_id_t>& offsets,
+                    const std::vector<edge_id_t>& eids) const {
+      adj.resize(vertices.size());
+      for(size_t v = 0; v < vertices.size(); ++v) {
+        adj[v].assign(eids.begin() + offsets[v], eids.begin() + offsets[v+1]);
+      }
+    } // end of unpack csr
+
+
+    /**
+     * Return to the mutable vector layout.  This is needed before
+     * the structure of a finalized graph can be changed.
+     */
+    void release_csr() {
+      if(!csr_built) return;
+      unpack_csr(in_edges, in_offsets, in_eids);
+      unpack_csr(out_edges, out_offsets, out_eids);
+      clear_csr();
+    } // end of release csr
+
+
+    /** Free the CSR arrays */
+    void clear_csr() {
+      std::vector<edge_id_t>().swap(in_offsets);
+      std::vector<vertex_id_t>().swap(in_nbrs);
+      std::vector<edge_id_t>().swap(in_eids);
+      std::vector<edge_id_t>().swap(out_offsets);
+      std::vector<vertex_id_t>().swap(out_nbrs);
+      std::vector<edge_id_t>().swap(out_eids);
+      csr_built = false;
+    } // end of clear csr
+
+
+    /**
+     * Write CSR adjacency in the same archive format as a
+     * std::vector< std::vector<edge_id_t> >
+     */
+    void save_csr_lists(oarchive& arc,
+                        const std::vector<edge_id_t>& offsets,
+                        const std::vector<edge_id_t>& eids) const {
+      arc << size_t(vertices.size());
+      for(size_t v = 0; v < vertices.size(); ++v) {
+        serialize_iterator(arc, eids.begin() + offsets[v],
+                           eids.begin() + offsets[v+1]);
+      }
+    } // end of save csr lists
+
+
+    /**
+     * Pack sorted per-vertex edge lists into CSR arrays.  The
+     * neighbor of an in edge is its source and of an out edge its
+     * target.
+     */
+    void pack_lists(const std::vector< std::vector<edge_id_t> >& adj,
+                    bool in, std::vector<edge_id_t>& offsets,
+                    std::vector<vertex_id_t>& nbrs,
+                    std::vector<edge_id_t>& eids) const {
+      csr_layout(adj, offsets, nbrs, eids);
+      for(size_t v = 0; v < adj.size(); ++v) {
+        for(size_t i = 0; i < adj[v].size(); ++i) {
+          const edge_id_t eid = adj[v][i];
+          nbrs[offsets[v] + i] = in ? edges[eid].source() : edges[eid].target();
+          eids[offsets[v] + i] = eid;
+        }
+      }
+    } // end of pack lists
+
+
+    /**
+     * Write the sources, targets or data of the edges, gathered from
+     * the edge array a block at a time.
+     */
+    bool save_edge_section(FILE* out, const binary_graph_header& header,
+                           size_t s) const {
+      typedef binary_graph_section section;
+      if(!binary_graph_header::write_at(out, header.section_offset[s], NULL, 0))
+        return false;
+      const size_t block_size = 1 << 16;
+      std::vector<vertex_id_t> ids;
+      std::vector<EdgeData> data;
+      for(size_t begin = 0; begin < edges.size(); begin += block_size) {
+        const size_t end = std::min(edges.size(), begin + block_size);
+        size_t written = 0;
+        if(s == section::EDGE_DATA) {
+          data.clear();
+          for(size_t i = begin; i < end; ++i) data.push_back(edges[i].data());
+          written = fwrite(&(data[0]), sizeof(EdgeData), data.size(), out);
+        } else {
+          ids.clear();
+          for(size_t i = begin; i < end; ++i) {
+            ids.push_back(s == section::SOURCES ?
+                          edges[i].source() : edges[i].target());
+          }
+          written = fwrite(&(ids[0]), sizeof(vertex_id_t), ids.size(), out);
+        }
+        if(written != end - begin) return false;
+      }
+      return true;
+    } // end of save edge section
+
+
+    /** Copy n elements of section s of a binary graph file into vec */
+    template<typename T>
+    static void load_section(const binary_graph_header& header,
+                             const char* data, size_t s, size_t n,
+                             std::vector<T>& vec) {
+      const T* begin = header.section<T>(data, s);
+      vec.assign(begin, begin + n);
+    } // end of load section
+
+
+    /** The contents of vec or NULL if it is empty */
+    template<typename T>
+    static const void* vector_data(const std::vector<T>& vec) {
+      return vec.empty() ? NULL : &(vec[0]);
+    }
+
   }; // End of graph
 
   template<typename VertexData, typename EdgeData>
@@ -1,6 +1,7 @@
 
 
 #include <graphlab/graph/graph.hpp>
+#include <graphlab/graph/mapped_graph.hpp>
 
 
 
@@ -0,0 +1,236 @@
+#ifndef GRAPHLAB_MAPPED_GRAPH_HPP
+#define GRAPHLAB_MAPPED_GRAPH_HPP
+
+#include <cassert>
+#include <string>
+#include <algorithm>
+
+#include <boost/static_assert.hpp>
+#include <boost/type_traits/has_trivial_copy.hpp>
+
+#include <graphlab/logger/logger.hpp>
+#include <graphlab/util/mapped_file.hpp>
+#include <graphlab/graph/graph.hpp>
+#include <graphlab/graph/binary_graph_format.hpp>
+
+namespace graphlab {
+
+  /**
+   * \brief A read only graph used in place from a binary graph file.
+   *
+   * A mapped graph maps a file written by graph::save_binary() and
+   * serves the adjacency and data straight from the mapping, so
+   * opening takes constant time whatever the size of the graph and
+   * only the pages which are used are ever read.  The structure
+   * cannot be changed.  The data can be changed, with
+   * mutable_vertex_data() and mutable_edge_data(), if the graph was
+   * opened writable, in which case the changes stay private to the
+   * process and are never written to the file.
+   *
+   * The interface follows the read only part of graph.
+   */
+  template<typename VertexData, typename EdgeData>
+  class mapped_graph {
+  public:
+    typedef VertexData vertex_data_type;
+    typedef EdgeData   edge_data_type;
+
+    mapped_graph() : nverts(0), nedges(0) { clear_arrays(); }
+
+    /** Open filename, see open() */
+    explicit mapped_graph(const std::string& filename, bool writable = false) :
+      nverts(0), nedges(0) {
+      clear_arrays();
+      open(filename, writable);
+    }
+
+    /**
+     * Map a binary graph file.  If writable the vertex and edge data
+     * can be changed, copy on write.  Returns false and logs the
+     * reason if the file is not a binary graph of this VertexData
+     * and EdgeData.
+     */
+    bool open(const std::string& filename, bool writable = false) {
+      BOOST_STATIC_ASSERT(boost::has_trivial_copy<VertexData>::value);
+      BOOST_STATIC_ASSERT(boost::has_trivial_copy<EdgeData>::value);
+      typedef binary_graph_section section;
+      close();
+      if(!file.open(filename, writable)) return false;
+      const std::string error =
+        binary_graph_header::validate(file.data(), file.size(),
+                                      sizeof(VertexData), sizeof(EdgeData),
+                                      sizeof(vertex_id_t), sizeof(edge_id_t),
+                                      sizeof(vertex_color_type));
+      if(!error.empty()) {
+        logger(LOG_ERROR, "Cannot open %s: %s", filename.c_str(),
+               error.c_str());
+        file.close();
+        return false;
+      }
+      const char* data = file.data();
+      const binary_graph_header& header =
+        *reinterpret_cast<const binary_graph_header*>(data);
+      nverts = header.num_vertices;
+      nedges = header.num_edges;
+      in_offsets = header.section<edge_id_t>(data, section::IN_OFFSETS);
+      in_nbrs = header.section<vertex_id_t>(data, section::IN_NBRS);
+      in_eids = header.section<edge_id_t>(data, section::IN_EIDS);
+      out_offsets = header.section<edge_id_t>(data, section::OUT_OFFSETS);
+      out_nbrs = header.section<vertex_id_t>(data, section::OUT_NBRS);
+      out_eids = header.section<edge_id_t>(data, section::OUT_EIDS);
+      sources = header.section<vertex_id_t>(data, section::SOURCES);
+      targets = header.section<vertex_id_t>(data, section::TARGETS);
+      vcolors = header.section<vertex_color_type>(data, section::COLORS);
+      // The data sections may be written through a writable mapping
+      char* mutable_data = const_cast<char*>(data);
+      vdata = header.section<VertexData>(mutable_data, section::VERTEX_DATA);
+      edata = header.section<EdgeData>(mutable_data, section::EDGE_DATA);
+      return true;
+    } // end of open
+
+    /** Unmap the file */
+    void close() {
+      file.close();
+      nverts = nedges = 0;
+      clear_arrays();
+    }
+
+    bool is_open() const { return file.is_open(); }
+
+    /** Ask the kernel to read the whole file ahead of use */
+    void prefetch() const { file.prefetch(); }
+
+    size_t num_vertices() const { return nverts; }
+
+    size_t num_edges() const { return nedges; }
+
+    size_t num_in_neighbors(vertex_id_t v) const {
+      assert(v < nverts);
+      return in_offsets[v+1] - in_offsets[v];
+    }
+
+    size_t num_out_neighbors(vertex_id_t v) const {
+      assert(v < nverts);
+      return out_offsets[v+1] - out_offsets[v];
+    }
+
+    /** Find the edge source -> target if it exists */
+    std::pair<bool, edge_id_t> find(vertex_id_t source,
+                                    vertex_id_t target) const {
+      assert(source < nverts);
+      assert(target < nverts);
+      const bool use_in = num_in_neighbors(target) < num_out_neighbors(source);
+      const vertex_list nbrs = use_in ?
+        in_neighbor_ids(target) : out_neighbor_ids(source);
+      const vertex_id_t key = use_in ? source : target;
+      const vertex_id_t* pos = std::lower_bound(nbrs.begin(), nbrs.end(), key);
+      if(pos == nbrs.end() || *pos != key) return std::make_pair(false, -1);
+      const edge_list eids = use_in ? in_edge_ids(target) : out_edge_ids(source);
+      return std::make_pair(true, eids[pos - nbrs.begin()]);
+    } // end of find
+
+    /** The edge id of source -> target, which must exist */
+    edge_id_t edge_id(vertex_id_t source, vertex_id_t target) const {
+      const std::pair<bool, edge_id_t> res = find(source, target);
+      assert(res.first);
+      return res.second;
+    }
+
+    vertex_id_t source(edge_id_t eid) const {
+      assert(eid < nedges);
+      return sources[eid];
+    }
+
+    vertex_id_t target(edge_id_t eid) const {
+      assert(eid < nedges);
+      return targets[eid];
+    }
+
+    /** The ids of the in edges, sorted by source */
+    edge_list in_edge_ids(vertex_id_t v) const {
+      assert(v < nverts);
+      return edge_list(in_eids + in_offsets[v], in_eids + in_offsets[v+1]);
+    }
+
+    /** The ids of the out edges, sorted by target */
+    edge_list out_edge_ids(vertex_id_t v) const {
+      assert(v < nverts);
+      return edge_list(out_eids + out_offsets[v], out_eids + out_offsets[v+1]);
+    }
+
+    /** The sources of the in edges in the order of in_edge_ids(v) */
+    vertex_list in_neighbor_ids(vertex_id_t v) const {
+      assert(v < nverts);
+      return vertex_list(in_nbrs + in_offsets[v], in_nbrs + in_offsets[v+1]);
+    }
+
+    /** The targets of the out edges in the order of out_edge_ids(v) */
+    vertex_list out_neighbor_ids(vertex_id_t v) const {
+      assert(v < nverts);
+      return vertex_list(out_nbrs + out_offsets[v],
+                         out_nbrs + out_offsets[v+1]);
+    }
+
+    vertex_color_type color(vertex_id_t v) const {
+      assert(v < nverts);
+      return vcolors[v];
+    }
+
+    const VertexData& vertex_data(vertex_id_t v) const {
+      assert(v < nverts);
+      return vdata[v];
+    }
+
+    /** The data of vertex v to change.  Only for a writable graph. */
+    VertexData& mutable_vertex_data(vertex_id_t v) {
+      assert(v < nverts);
+      assert(file.writable());
+      return vdata[v];
+    }
+
+    const EdgeData& edge_data(edge_id_t eid) const {
+      assert(eid < nedges);
+      return edata[eid];
+    }
+
+    /** The data of edge eid to change.  Only for a writable graph. */
+    EdgeData& mutable_edge_data(edge_id_t eid) {
+      assert(eid < nedges);
+      assert(file.writable());
+      return edata[eid];
+    }
+
+  private:
+    void clear_arrays() {
+      in_offsets = out_offsets = in_eids = out_eids = NULL;
+      in_nbrs = out_nbrs = sources = targets = NULL;
+      vcolors = NULL;
+      vdata = NULL;
+      edata = NULL;
+    }
+
+    mapped_file file;
+    size_t nverts;
+    size_t nedges;
+
+    /** The sections of the file, see binary_graph_section */
+    const edge_id_t* in_offsets;
+    const vertex_id_t* in_nbrs;
+    const edge_id_t* in_eids;
+    const edge_id_t* out_offsets;
+    const vertex_id_t* out_nbrs;
+    const edge_id_t* out_eids;
+    const vertex_id_t* sources;
+    const vertex_id_t* targets;
+    const vertex_color_type* vcolors;
+    VertexData* vdata;
+    EdgeData* edata;
+
+    // Not copyable
+    mapped_graph(const mapped_graph&);
+    mapped_graph& operator=(const mapped_graph&);
+  }; // end of mapped_graph
+
+} // end of namespace graphlab
+
+#endif
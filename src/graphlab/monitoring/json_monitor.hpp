@@ -0,0 +1,165 @@
+#ifndef GRAPHLAB_JSON_MONITOR_HPP
+#define GRAPHLAB_JSON_MONITOR_HPP
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <graphlab/monitoring/imonitor.hpp>
+#include <graphlab/engine/iengine.hpp>
+#include <graphlab/engine/worker_stats.hpp>
+#include <graphlab/parallel/pthread_tools.hpp>
+#include <graphlab/logger/logger.hpp>
+
+namespace graphlab {
+
+  /**
+   * A monitor which periodically appends a snapshot of the per
+   * worker stats of the engine (see iengine::worker_statistics()) to
+   * a file.  Every snapshot is one line holding a JSON object:
+   *
+   * \verbatim
+   {"time": 2.001, "updates": 1523000, "updates_per_sec": 761000.0,
+    "workers": [{"updates": 762000, "work": 4380000, "scope_time": 0.41,
+                 "update_time": 1.22, "wait_time": 0.02}, ...]}
+   \endverbatim
+   *
+   * Times are in seconds.  "time" counts from the registration of the
+   * monitor and "updates_per_sec" is the rate since the previous
+   * snapshot, so a long run can be watched with tail -f.
+   *
+   * Registering the monitor enables timing in the engine.  The
+   * snapshots are written by a background thread which is started
+   * by init() and stopped (after writing a last snapshot) by stop()
+   * or the destructor.  The monitor must be stopped before the
+   * engine is destroyed.
+   */
+  template<typename Graph>
+  class json_monitor :
+    public imonitor<Graph> {
+
+  public:
+    typedef typename imonitor<Graph>::iengine_type iengine_type;
+
+  private:
+    /** The background thread */
+    class writer : public runnable {
+      json_monitor* monitor;
+    public:
+      writer(json_monitor* monitor = NULL) : monitor(monitor) { }
+      void run() { monitor->write_loop(); }
+    };
+
+  public:
+    /**
+     * Write a snapshot to filename every interval_seconds.  The file
+     * is truncated when the monitor is registered with an engine.
+     */
+    json_monitor(const std::string& filename, double interval_seconds = 1.0) :
+      filename(filename),
+      interval_millis(size_t(interval_seconds * 1000)),
+      out(NULL), stats(NULL), running(false), stopping(false),
+      start_ns(0), last_ns(0), last_updates(0) {
+      if(interval_millis == 0) interval_millis = 1;
+    }
+
+    ~json_monitor() { stop(); }
+
+    /** Start writing snapshots of the stats of engine */
+    void init(iengine_type* engine) {
+      stop();
+      stats = engine == NULL ? NULL : engine->worker_statistics();
+      if(stats == NULL) {
+        logger(LOG_WARNING, "The engine does not provide worker stats");
+        return;
+      }
+      stats->set_timing(true);
+      out = fopen(filename.c_str(), "w");
+      if(out == NULL) {
+        logger(LOG_WARNING, "Could not open %s", filename.c_str());
+        return;
+      }
+      start_ns = last_ns = worker_stats_array::now_ns();
+      last_updates = 0;
+      stopping = false;
+      running = true;
+      thread_writer = writer(this);
+      threads.launch(&thread_writer);
+    } // end of init
+
+    /** Write a last snapshot and stop the background thread */
+    void stop() {
+      if(!running) return;
+      lock.lock();
+      stopping = true;
+      cond.signal();
+      lock.unlock();
+      threads.join();
+      write_snapshot();
+      fclose(out);
+      out = NULL;
+      running = false;
+    } // end of stop
+
+  private:
+    void write_loop() {
+      lock.lock();
+      while(!stopping) {
+        cond.timedwait_ms(lock, interval_millis);
+        if(stopping) break;
+        lock.unlock();
+        write_snapshot();
+        lock.lock();
+      }
+      lock.unlock();
+    } // end of write_loop
+
+    void write_snapshot() {
+      stats->snapshot(snapshot);
+      const uint64_t now = worker_stats_array::now_ns();
+      size_t updates = 0;
+      for(size_t i = 0; i < snapshot.size(); ++i) updates += snapshot[i].updates;
+      const double elapsed = (now - last_ns) / 1e9;
+      // The counters are reset when the engine is (re)started
+      const size_t new_updates =
+        updates >= last_updates ? updates - last_updates : updates;
+      fprintf(out, "{\"time\": %.3f, \"updates\": %lu, "
+              "\"updates_per_sec\": %.1f, \"workers\": [",
+              (now - start_ns) / 1e9, (unsigned long)updates,
+              elapsed > 0 ? new_updates / elapsed : 0.0);
+      for(size_t i = 0; i < snapshot.size(); ++i) {
+        const worker_stats& ws = snapshot[i];
+        fprintf(out, "%s{\"updates\": %lu, \"work\": %lu, "
+                "\"scope_time\": %.6f, \"update_time\": %.6f, "
+                "\"wait_time\": %.6f}",
+                i == 0 ? "" : ", ",
+                (unsigned long)ws.updates, (unsigned long)ws.work,
+                ws.scope_ns / 1e9, ws.update_ns / 1e9, ws.wait_ns / 1e9);
+      }
+      fprintf(out, "]}\n");
+      fflush(out);
+      last_ns = now;
+      last_updates = updates;
+    } // end of write_snapshot
+
+    std::string filename;
+    size_t interval_millis;
+    FILE* out;
+    worker_stats_array* stats;
+    std::vector<worker_stats> snapshot;
+
+    bool running;
+    bool stopping;
+    mutex lock;
+    conditional cond;
+    writer thread_writer;
+    thread_group threads;
+
+    uint64_t start_ns;
+    uint64_t last_ns;
+    size_t last_updates;
+  }; // end of json_monitor
+
+} // end of namespace graphlab
+
+#endif
@@ -2,3 +2,4 @@
 #include <graphlab/monitoring/imonitor.hpp>
 #include <graphlab/monitoring/monitor_multiplexer.hpp>
 #include <graphlab/monitoring/console_monitor.hpp>
+#include <graphlab/monitoring/json_monitor.hpp>
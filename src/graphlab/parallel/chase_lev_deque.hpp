@@ -0,0 +1,148 @@
+#ifndef GRAPHLAB_CHASE_LEV_DEQUE_HPP
+#define GRAPHLAB_CHASE_LEV_DEQUE_HPP
+
+#include <cstddef>
+#include <cassert>
+#include <vector>
+#include <atomic>
+#include <stdint.h>
+
+namespace graphlab {
+
+  /**
+   * \brief Lock-free work stealing deque.
+   *
+   * A single owner thread pushes and pops at the bottom of the deque
+   * while any number of other threads steal from the top.  This is
+   * the dynamic circular deque of Chase and Lev ("Dynamic Circular
+   * Work-Stealing Deque", SPAA 2005) with the memory orderings of Le
+   * et al. ("Correct and Efficient Work-Stealing for Weak Memory
+   * Models", PPoPP 2013).
+   *
+   * T should be cheap to copy and have no side effects on copy.  A
+   * thief may read a slot that the owner is concurrently overwriting
+   * but such a read is always discarded because the following
+   * compare and swap on top fails.
+   *
+   * When the ring buffer is full the owner replaces it with one twice
+   * the size.  Old buffers may still be read by thieves so they are
+   * only freed when the deque is destroyed.
+   */
+  template<typename T>
+  class chase_lev_deque {
+  private:
+
+    /** A power of two sized circular buffer */
+    struct ring {
+      int64_t mask;
+      T* items;
+      ring(int64_t capacity) : mask(capacity - 1), items(new T[capacity]) {
+        assert((capacity & mask) == 0);
+      }
+      ~ring() { delete [] items; }
+      int64_t capacity() const { return mask + 1; }
+      const T& get(int64_t i) const { return items[i & mask]; }
+      void put(int64_t i, const T& item) { items[i & mask] = item; }
+    };
+
+    std::atomic<int64_t> top;
+    std::atomic<int64_t> bottom;
+    std::atomic<ring*> array;
+    /** Buffers replaced by grow(). Only touched by the owner */
+    std::vector<ring*> retired;
+
+    // Not copyable
+    chase_lev_deque(const chase_lev_deque&);
+    chase_lev_deque& operator=(const chase_lev_deque&);
+
+    /** Copy the live range [t, b) into a buffer twice the size */
+    ring* grow(ring* old, int64_t t, int64_t b) {
+      ring* bigger = new ring(old->capacity() * 2);
+      for(int64_t i = t; i < b; ++i) bigger->put(i, old->get(i));
+      retired.push_back(old);
+      array.store(bigger, std::memory_order_release);
+      return bigger;
+    }
+
+  public:
+
+    /** The initial capacity must be a power of two */
+    chase_lev_deque(size_t initial_capacity = 1024) :
+      top(0), bottom(0), array(new ring(initial_capacity)) { }
+
+    ~chase_lev_deque() {
+      delete array.load(std::memory_order_relaxed);
+      for(size_t i = 0; i < retired.size(); ++i) delete retired[i];
+    }
+
+    /** Push an element onto the bottom. Owner only. */
+    void push(const T& item) {
+      const int64_t b = bottom.load(std::memory_order_relaxed);
+      const int64_t t = top.load(std::memory_order_acquire);
+      ring* a = array.load(std::memory_order_relaxed);
+      if(b - t > a->capacity() - 1) a = grow(a, t, b);
+      a->put(b, item);
+      std::atomic_thread_fence(std::memory_order_release);
+      bottom.store(b + 1, std::memory_order_relaxed);
+    } // end of push
+
+    /**
+     * Pop an element from the bottom returning false if the deque is
+     * empty. Owner only.
+     */
+    bool pop(T& ret) {
+      const int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+      ring* a = array.load(std::memory_order_relaxed);
+      bottom.store(b, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      int64_t t = top.load(std::memory_order_relaxed);
+      if(t > b) {
+        // The deque was empty
+        bottom.store(b + 1, std::memory_order_relaxed);
+        return false;
+      }
+      ret = a->get(b);
+      if(t == b) {
+        // Last element: race the thieves for it
+        const bool won =
+          top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                      std::memory_order_relaxed);
+        bottom.store(b + 1, std::memory_order_relaxed);
+        return won;
+      }
+      return true;
+    } // end of pop
+
+    /**
+     * Steal an element from the top.  Returns false if the deque was
+     * empty or another thread won the race for the element.  May be
+     * called by any thread.
+     */
+    bool steal(T& ret) {
+      int64_t t = top.load(std::memory_order_acquire);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      const int64_t b = bottom.load(std::memory_order_acquire);
+      if(t >= b) return false;
+      ring* a = array.load(std::memory_order_acquire);
+      T item = a->get(t);
+      if(!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                      std::memory_order_relaxed)) {
+        return false;
+      }
+      ret = item;
+      return true;
+    } // end of steal
+
+    /** Approximate number of elements (exact for the owner) */
+    size_t size() const {
+      const int64_t b = bottom.load(std::memory_order_relaxed);
+      const int64_t t = top.load(std::memory_order_relaxed);
+      return b > t ? size_t(b - t) : 0;
+    }
+
+    bool empty() const { return size() == 0; }
+  }; // end of chase_lev_deque
+
+} // end of namespace graphlab
+
+#endif
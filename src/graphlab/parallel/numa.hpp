@@ -0,0 +1,228 @@
+#ifndef GRAPHLAB_NUMA_HPP
+#define GRAPHLAB_NUMA_HPP
+
+#include <cstdio>
+#include <cstdlib>
+#include <cassert>
+#include <stdint.h>
+#include <vector>
+#include <algorithm>
+#include <unistd.h>
+#include <dirent.h>
+
+#if defined __linux__
+#include <sys/syscall.h>
+#endif
+
+#include <graphlab/parallel/pthread_tools.hpp>
+#include <graphlab/logger/logger.hpp>
+
+#include <graphlab/macros_def.hpp>
+
+namespace graphlab {
+
+  /**
+   * \class numa_topology Describes which cpus belong to which NUMA
+   * node (socket) and assigns workers and vertices to nodes.
+   *
+   * The topology is read from /sys/devices/system/node on linux.  On
+   * other systems, or when the information is missing, the machine
+   * is treated as a single node holding every cpu.
+   *
+   * Workers and vertices are split into one contiguous block per
+   * node: worker w of n runs on node floor(w * nodes / n) and vertex
+   * v of nv belongs to node floor(v * nodes / nv).  The engine pins
+   * each worker to a cpu of its node and the graph places the data
+   * of each vertex block on its node (see graph::place_numa()) so
+   * that workers mostly touch local memory when the schedulers
+   * prefer tasks on vertices of their own node.
+   *
+   * Memory placement uses the mbind system call directly so no
+   * libnuma is required.  Pages which have already been touched are
+   * migrated.
+   */
+  class numa_topology {
+  public:
+
+    numa_topology() { detect(); }
+
+    /** Number of NUMA nodes */
+    size_t num_nodes() const { return cpus.size(); }
+
+    /** The cpus of node */
+    const std::vector<size_t>& node_cpus(size_t node) const {
+      assert(node < cpus.size());
+      return cpus[node];
+    }
+
+    /** The node of cpu or 0 if the cpu is unknown */
+    size_t cpu_node(size_t cpu) const {
+      for(size_t node = 0; node < cpus.size(); ++node) {
+        if(std::find(cpus[node].begin(), cpus[node].end(), cpu) !=
+           cpus[node].end()) return node;
+      }
+      return 0;
+    }
+
+    /** The node which runs worker out of nworkers */
+    size_t worker_node(size_t worker, size_t nworkers) const {
+      assert(worker < nworkers);
+      return block_of(worker, nworkers);
+    }
+
+    /**
+     * The cpu worker should be pinned to.  The workers of a node are
+     * spread over its cpus and wrap around if there are more workers
+     * than cpus.
+     */
+    size_t worker_cpu(size_t worker, size_t nworkers) const {
+      const size_t node = worker_node(worker, nworkers);
+      const size_t first = block_begin(node, nworkers);
+      const std::vector<size_t>& nodecpus = cpus[node];
+      return nodecpus[(worker - first) % nodecpus.size()];
+    }
+
+    /** The first worker on node. Node num_nodes() gives nworkers */
+    size_t node_worker_begin(size_t node, size_t nworkers) const {
+      return block_begin(node, nworkers);
+    }
+
+    /** The node owning vertex out of nvertices */
+    size_t vertex_node(size_t vertex, size_t nvertices) const {
+      assert(vertex < nvertices);
+      return block_of(vertex, nvertices);
+    }
+
+    /** The first vertex owned by node. Node num_nodes() gives nvertices */
+    size_t node_vertex_begin(size_t node, size_t nvertices) const {
+      return block_begin(node, nvertices);
+    }
+
+    /**
+     * Move the pages in [ptr, ptr + bytes) to node.  Pages which are
+     * only partly inside the range are left alone.  Returns false if
+     * the placement is not supported.
+     */
+    bool bind_memory(const void* ptr, size_t bytes, size_t node) const {
+      assert(node < node_ids.size());
+      return mbind_range(ptr, bytes, MPOL_BIND_MODE,
+                         std::vector<size_t>(1, node_ids[node]));
+    }
+
+    /**
+     * Spread the pages in [ptr, ptr + bytes) round robin over all
+     * nodes.  Returns false if the placement is not supported.
+     */
+    bool interleave_memory(const void* ptr, size_t bytes) const {
+      return mbind_range(ptr, bytes, MPOL_INTERLEAVE_MODE, node_ids);
+    }
+
+    /** Print the topology to the log */
+    void print() const {
+      for(size_t node = 0; node < cpus.size(); ++node) {
+        logger(LOG_INFO, "NUMA node %lu: %lu cpus",
+               (unsigned long)node_ids[node],
+               (unsigned long)cpus[node].size());
+      }
+    }
+
+  private:
+    // The memory policies of linux/mempolicy.h
+    enum { MPOL_BIND_MODE = 2, MPOL_INTERLEAVE_MODE = 3 };
+    enum { MPOL_MF_MOVE_FLAG = 1 << 1 };
+
+    size_t block_of(size_t i, size_t n) const {
+      return size_t((uint64_t(i) * cpus.size()) / n);
+    }
+
+    /** The smallest i with block_of(i, n) == block */
+    size_t block_begin(size_t block, size_t n) const {
+      const size_t nblocks = cpus.size();
+      return size_t((uint64_t(block) * n + nblocks - 1) / nblocks);
+    }
+
+    void detect() {
+#if defined __linux__
+      DIR* dir = opendir("/sys/devices/system/node");
+      if(dir != NULL) {
+        std::vector<size_t> ids;
+        struct dirent* entry;
+        while((entry = readdir(dir)) != NULL) {
+          unsigned int id;
+          char tail;
+          if(sscanf(entry->d_name, "node%u%c", &id, &tail) == 1)
+            ids.push_back(id);
+        }
+        closedir(dir);
+        std::sort(ids.begin(), ids.end());
+        foreach(size_t id, ids) {
+          std::vector<size_t> nodecpus;
+          if(read_cpulist(id, nodecpus) && !nodecpus.empty()) {
+            node_ids.push_back(id);
+            cpus.push_back(nodecpus);
+          }
+        }
+      }
+#endif
+      if(cpus.empty()) {
+        // a single node with every cpu
+        node_ids.assign(1, 0);
+        cpus.resize(1);
+        const size_t ncpus = std::max(thread::cpu_count(), size_t(1));
+        for(size_t i = 0; i < ncpus; ++i) cpus[0].push_back(i);
+      }
+    } // end of detect
+
+    /** Parse a cpu list such as "0-3,8-11" */
+    static bool read_cpulist(size_t id, std::vector<size_t>& ret) {
+      char path[128];
+      snprintf(path, sizeof(path),
+               "/sys/devices/system/node/node%lu/cpulist", (unsigned long)id);
+      FILE* f = fopen(path, "r");
+      if(f == NULL) return false;
+      unsigned long first, last;
+      while(fscanf(f, "%lu", &first) == 1) {
+        last = first;
+        int c = fgetc(f);
+        if(c == '-') {
+          if(fscanf(f, "%lu", &last) != 1) break;
+          c = fgetc(f);
+        }
+        for(unsigned long cpu = first; cpu <= last; ++cpu) ret.push_back(cpu);
+        if(c != ',') break;
+      }
+      fclose(f);
+      return true;
+    } // end of read_cpulist
+
+    bool mbind_range(const void* ptr, size_t bytes, int mode,
+                     const std::vector<size_t>& nodes) const {
+#if defined __linux__ && defined SYS_mbind
+      if(cpus.size() < 2 || bytes == 0) return false;
+      const size_t pagesize = sysconf(_SC_PAGESIZE);
+      const size_t begin =
+        (size_t(ptr) + pagesize - 1) / pagesize * pagesize;
+      const size_t end = (size_t(ptr) + bytes) / pagesize * pagesize;
+      if(end <= begin) return true;
+      const size_t bits = 8 * sizeof(unsigned long);
+      const size_t maxid = *std::max_element(node_ids.begin(), node_ids.end());
+      std::vector<unsigned long> mask(maxid / bits + 1, 0);
+      foreach(size_t id, nodes) mask[id / bits] |= 1UL << (id % bits);
+      // the kernel reads maxnode - 1 bits
+      return syscall(SYS_mbind, begin, end - begin, mode, &mask[0],
+                     mask.size() * bits + 1, int(MPOL_MF_MOVE_FLAG)) == 0;
+#else
+      return false;
+#endif
+    } // end of mbind_range
+
+    /** The operating system id of each node */
+    std::vector<size_t> node_ids;
+    /** The cpus of each node */
+    std::vector< std::vector<size_t> > cpus;
+  }; // end of numa_topology
+
+} // end of namespace graphlab
+
+#include <graphlab/macros_undef.hpp>
+#endif
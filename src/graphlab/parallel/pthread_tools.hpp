@@ -487,6 +487,24 @@ namespace graphlab {
       timeout.tv_sec = tv.tv_sec + sec;
       return pthread_cond_timedwait(&m_cond, &mut.m_mut, &timeout);
     }
+    inline int timedwait_ms(const mutex& mut, size_t ms) const {
+      struct timespec timeout;
+      struct timeval tv;
+      gettimeofday(&tv, NULL);
+      size_t nsec = size_t(tv.tv_usec) * 1000 + (ms % 1000) * 1000000;
+      timeout.tv_sec = tv.tv_sec + ms / 1000 + nsec / 1000000000;
+      timeout.tv_nsec = nsec % 1000000000;
+      return pthread_cond_timedwait(&m_cond, &mut.m_mut, &timeout);
+    }
+    inline int timedwait_us(const mutex& mut, size_t us) const {
+      struct timespec timeout;
+      struct timeval tv;
+      gettimeofday(&tv, NULL);
+      size_t nsec = (size_t(tv.tv_usec) + us % 1000000) * 1000;
+      timeout.tv_sec = tv.tv_sec + us / 1000000 + nsec / 1000000000;
+      timeout.tv_nsec = nsec % 1000000000;
+      return pthread_cond_timedwait(&m_cond, &mut.m_mut, &timeout);
+    }
     inline void signal() const {
       int error = pthread_cond_signal(&m_cond);
       assert(!error);
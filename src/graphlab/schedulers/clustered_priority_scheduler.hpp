@@ -11,7 +11,7 @@
 
 #include <graphlab/graph/graph.hpp>
 #include <graphlab/scope/iscope.hpp>
-#include <graphlab/util/mutable_queue.hpp>
+#include <graphlab/util/indexed_dary_heap.hpp>
 #include <graphlab/tasks/update_task.hpp>
 #include <graphlab/schedulers/ischeduler.hpp>
 #include <graphlab/parallel/pthread_tools.hpp>
@@ -51,7 +51,7 @@ namespace graphlab {
     size_t num_vertices;  
     
     /** The queue over vertices */
-    mutable_queue<size_t, double> task_queue;
+    indexed_dary_heap<double> task_queue;
 
     /** The lock on the priority queue */
     spinlock queuelock; 
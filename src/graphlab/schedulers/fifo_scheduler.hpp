@@ -16,7 +16,7 @@
 #include <graphlab/schedulers/support/vertex_task_set.hpp>
 #include <graphlab/schedulers/support/direct_callback.hpp>
 //#include <util/shared_termination.hpp>
-#include <graphlab/util/task_count_termination.hpp>
+#include <graphlab/util/sharded_termination.hpp>
 
 // #include <bitmagic/bm.h>
 
@@ -43,6 +43,7 @@ namespace graphlab {
     
   private:
     using base::monitor;
+    using base::wake_idle_worker;
 
   public:
 
@@ -50,7 +51,8 @@ namespace graphlab {
                    Graph& g, 
                    size_t ncpus)  : 
       callbacks(ncpus, direct_callback<Graph>(this, engine)), 
-      vertex_tasks(g.num_vertices()) {
+      vertex_tasks(g.num_vertices()),
+      terminator(ncpus) {
       numvertices = g.num_vertices();
     }
 
@@ -61,7 +63,7 @@ namespace graphlab {
 
     /** Get the next element in the queue */
     sched_status::status_enum get_next_task(size_t cpuid, update_task_type &ret_task) {    
-      if (terminator.finish()) return sched_status::COMPLETE;
+      if (terminator.is_aborted()) return sched_status::COMPLETE;
       
       bool success(false);
       queue_lock.lock();
@@ -81,6 +83,8 @@ namespace graphlab {
         vertex_tasks.remove(ret_task);
         return sched_status::NEWTASK;
       } else {
+        // Only sweep the termination counters when there is no work
+        if (terminator.finish()) return sched_status::COMPLETE;
         return sched_status::WAITING;
       }
     } // end of get_next_task
@@ -92,6 +96,7 @@ namespace graphlab {
         queue_lock.lock();
         task_queue.push(task);
         queue_lock.unlock();
+        wake_idle_worker();
 		//std::cout<<"======================fifo scheduler add vertex="<<task.vertex()<<" to schedule priority"<<priority<<std::endl;
         if (monitor != NULL) 
           monitor->scheduler_task_added(task, priority);
@@ -126,7 +131,7 @@ namespace graphlab {
                               const std::vector<edge_id_t>& updatededges){}
 
     void completed_task(size_t cpuid, const update_task_type &task) {
-      terminator.completed_job();
+      terminator.completed_job(cpuid);
     }
 
     void abort() { terminator.abort(); }
@@ -145,7 +150,7 @@ namespace graphlab {
     // Task set for task pruning
     vertex_task_set<Graph> vertex_tasks;
   
-    task_count_termination terminator;
+    sharded_termination terminator;
   }; 
 
 
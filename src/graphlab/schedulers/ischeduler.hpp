@@ -4,6 +4,8 @@
 #include <vector>
 
 #include <graphlab/engine/iengine.hpp>
+#include <graphlab/engine/idle_policy.hpp>
+#include <graphlab/parallel/numa.hpp>
 #include <graphlab/tasks/update_task.hpp>
 #include <graphlab/monitoring/imonitor.hpp>
 #include <graphlab/schedulers/icallback.hpp>
@@ -35,7 +37,9 @@ namespace graphlab {
       START_VERTEX,
       SCHEDULING_FUNCTION,
       BARRIER,
-      DISTRIBUTED_CONTROL
+      DISTRIBUTED_CONTROL,
+      QUEUES_PER_CPU,
+      STICKINESS
     };
   };
 
@@ -71,7 +75,7 @@ namespace graphlab {
      *     constructors to look like this
      */
     //    ischeduler(iengine_type* engine, Graph& g, size_t ncpus) : monitor(NULL) { }
-    ischeduler() : monitor(NULL) {}
+    ischeduler() : monitor(NULL), idle(NULL), numa(NULL) {}
     
     /// destructor
     virtual ~ischeduler() {};
@@ -136,11 +140,36 @@ namespace graphlab {
       monitor = monitor_;
     }        
 
+    /**
+     * Installs the idle policy whose parked workers should be woken
+     * when a task is added (done by the engine)
+     */
+    virtual void register_idle_policy(idle_policy* idle_) {
+      idle = idle_;
+    }
+
+    /**
+     * Installs the NUMA topology the engine places its workers and
+     * the graph with, or NULL outside of NUMA mode (done by the
+     * engine).  Schedulers which support it then prefer handing a
+     * worker tasks on vertices of its own node.
+     */
+    virtual void register_numa_topology(const numa_topology* numa_) {
+      numa = numa_;
+    }
+
     virtual void set_option(scheduler_options::options_enum opt, void* value) { };
 
 
   protected:
+    /** Wake a parked engine worker. Call after queuing a new task. */
+    void wake_idle_worker() {
+      if(idle != NULL) idle->wake_one();
+    }
+
     monitor_type* monitor;
+    idle_policy* idle;
+    const numa_topology* numa;
 
   };
 
@@ -19,7 +19,7 @@
 #include <graphlab/schedulers/support/direct_callback.hpp>
 #include <graphlab/schedulers/support/binary_vertex_task_set.hpp>
 //#include <graphlab/util/shared_termination.hpp>
-#include <graphlab/util/task_count_termination.hpp>
+#include <graphlab/util/sharded_termination.hpp>
 
 
 #include <graphlab/macros_def.hpp>
@@ -46,6 +46,8 @@ namespace graphlab {
 
   private:
     using base::monitor;
+    using base::wake_idle_worker;
+    using base::numa;
 
   public:
 
@@ -53,8 +55,10 @@ namespace graphlab {
                               Graph& g, 
                               size_t ncpus) : 
       callbacks(ncpus, direct_callback<Graph>(this, engine)), 
-      binary_vertex_tasks(g.num_vertices()) {
+      binary_vertex_tasks(g.num_vertices()),
+      terminator(ncpus) {
       numvertices = g.num_vertices();
+      this->ncpus = ncpus;
         
       /* How many queues per cpu. More queues, less contention */
       queues_per_cpu = 2;
@@ -84,7 +88,7 @@ namespace graphlab {
     /** Get the next element in the queue */
     sched_status::status_enum get_next_task(size_t cpuid,
                                             update_task_type &ret_task) {
-      if (terminator.finish()) {
+      if (terminator.is_aborted()) {
         return sched_status::COMPLETE;
       }
       bool found = false;
@@ -106,6 +110,15 @@ namespace graphlab {
         if (found) break;
       }
   
+      /* In NUMA mode try the queues of the other workers on my node
+         next since they hold tasks on vertices in local memory */
+      if (!found && numa != NULL) {
+        size_t qbegin, qcount;
+        node_queues(numa->worker_node(cpuid, ncpus), qbegin, qcount);
+        for(size_t i = 0; i < qcount && !found; ++i) {
+          found = try_pop(qbegin + i, ret_task);
+        }
+      }
       /* Ok, my queues were empty - now check every other queue */
       if (!found) {
         /* First check own queue - if it is empty, check others */
@@ -125,6 +138,8 @@ namespace graphlab {
       }
  
       if(!found) {
+        // Only sweep the termination counters when there is no work
+        if (terminator.finish()) return sched_status::COMPLETE;
         return sched_status::WAITING;
       }
       
@@ -155,9 +170,16 @@ namespace graphlab {
 
 //         size_t r1 = random::rand_int(num_queues - 1);
 //         size_t r2 = random::rand_int(num_queues - 1);
-        size_t prod = size_t(random::rand01() * num_queues * num_queues);
-        size_t r1 = prod / num_queues;
-        size_t r2 = prod % num_queues;
+        /* In NUMA mode only the queues of the workers on the node
+           owning the vertex are considered */
+        size_t qbegin = 0, qcount = num_queues;
+        if (numa != NULL) {
+          node_queues(numa->vertex_node(task.vertex(), numvertices),
+                      qbegin, qcount);
+        }
+        size_t prod = size_t(random::rand01() * qcount * qcount);
+        size_t r1 = qbegin + prod / qcount;
+        size_t r2 = qbegin + prod % qcount;
 
         size_t qidx = 
           (task_queues[r1].size() < task_queues[r2].size()) ? r1 : r2;
@@ -165,7 +187,7 @@ namespace graphlab {
         queue_locks[qidx].lock();
         task_queues[qidx].push(task);
         queue_locks[qidx].unlock();
-    
+        wake_idle_worker();
         if (monitor != NULL) 
           monitor->scheduler_task_added(task, priority);
       } else {
@@ -199,7 +221,7 @@ namespace graphlab {
                               const std::vector<edge_id_t>& updatededges){}
 
     void completed_task(size_t cpuid, const update_task_type &task) {
-      terminator.completed_job();
+      terminator.completed_job(cpuid);
     }
 
 
@@ -225,8 +247,34 @@ namespace graphlab {
     }
 
   private:
+    /** The queues of the workers running on node. All queues if the
+        node has no workers */
+    void node_queues(size_t node, size_t& qbegin, size_t& qcount) const {
+      const size_t wbegin = numa->node_worker_begin(node, ncpus);
+      const size_t wend = numa->node_worker_begin(node + 1, ncpus);
+      if (wend <= wbegin) {
+        qbegin = 0;
+        qcount = num_queues;
+      } else {
+        qbegin = wbegin * queues_per_cpu;
+        qcount = (wend - wbegin) * queues_per_cpu;
+      }
+    } // end of node_queues
+
+    bool try_pop(size_t queueidx, update_task_type& ret_task) {
+      bool found = false;
+      queue_locks[queueidx].lock();
+      if (!task_queues[queueidx].empty()) {
+        ret_task = task_queues[queueidx].front();
+        task_queues[queueidx].pop();
+        found = true;
+      }
+      queue_locks[queueidx].unlock();
+      return found;
+    } // end of try_pop
+
     size_t numvertices; /// Remember the number of vertices in the graph
-  
+    size_t ncpus;
     size_t num_queues;
     size_t queues_per_cpu;
   
@@ -241,7 +289,7 @@ namespace graphlab {
     binary_vertex_task_set<Graph> binary_vertex_tasks;
 
   
-    task_count_termination terminator;
+    sharded_termination terminator;
   }; 
 
 
@@ -18,7 +18,7 @@
 #include <graphlab/schedulers/support/direct_callback.hpp>
 #include <graphlab/schedulers/support/binary_vertex_task_set.hpp>
 
-#include <graphlab/util/task_count_termination.hpp>
+#include <graphlab/util/sharded_termination.hpp>
 
 
 
@@ -44,6 +44,7 @@ namespace graphlab {
 
   private:
     using base::monitor;
+    using base::wake_idle_worker;
 
   public:
 
@@ -51,7 +52,8 @@ namespace graphlab {
                                   Graph& g, 
                                   size_t ncpus) : 
       callbacks(ncpus, direct_callback<Graph>(this, engine)), 
-      binary_vertex_tasks(g.num_vertices()) {
+      binary_vertex_tasks(g.num_vertices()),
+      terminator(ncpus) {
       numvertices = g.num_vertices();
         
       /* How many queues per cpu. More queues, less contention */
@@ -82,7 +84,7 @@ namespace graphlab {
     /** Get the next element in the queue */
     sched_status::status_enum get_next_task(size_t cpuid,
                                             update_task_type &ret_task) {
-      if (terminator.finish()) {
+      if (terminator.is_aborted()) {
         return sched_status::COMPLETE;
       }
       bool found = false;
@@ -121,6 +123,8 @@ namespace graphlab {
       }
  
       if(!found) {
+        // Only sweep the termination counters when there is no work
+        if (terminator.finish()) return sched_status::COMPLETE;
         return sched_status::WAITING;
       }
       
@@ -161,7 +165,7 @@ namespace graphlab {
         queue_locks[qidx].lock();
         task_queues[qidx].push(task, priority);
         queue_locks[qidx].unlock();
-    
+        wake_idle_worker();
         if (monitor != NULL) 
           monitor->scheduler_task_added(task, priority);
       } else {
@@ -195,7 +199,7 @@ namespace graphlab {
                               const std::vector<edge_id_t>& updatededges){}
 
     void completed_task(size_t cpuid, const update_task_type &task) {
-      terminator.completed_job();
+      terminator.completed_job(cpuid);
     }
 
 
@@ -237,7 +241,7 @@ namespace graphlab {
     binary_vertex_task_set<Graph> binary_vertex_tasks;
 
   
-    task_count_termination terminator;
+    sharded_termination terminator;
   }; 
 
 
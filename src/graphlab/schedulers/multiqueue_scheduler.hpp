@@ -46,6 +46,7 @@ namespace graphlab {
 
   private:
     using base::monitor;
+    using base::wake_idle_worker;
   
   public:
 
@@ -92,6 +93,7 @@ namespace graphlab {
         //queue_lock.lock();
         task_queue.push(task);
         //queue_lock.unlock();
+        wake_idle_worker();
         if (monitor != NULL) 
           monitor->scheduler_task_added(task, priority);
       } else {
@@ -10,13 +10,13 @@
 
 #include <graphlab/graph/graph.hpp>
 #include <graphlab/scope/iscope.hpp>
-#include <graphlab/util/mutable_queue.hpp>
+#include <graphlab/util/indexed_dary_heap.hpp>
 #include <graphlab/tasks/update_task.hpp>
 #include <graphlab/schedulers/ischeduler.hpp>
 #include <graphlab/parallel/pthread_tools.hpp>
 #include <graphlab/schedulers/support/direct_callback.hpp>
 #include <graphlab/schedulers/support/vertex_task_set.hpp>
-#include <graphlab/util/task_count_termination.hpp>
+#include <graphlab/util/sharded_termination.hpp>
 
 //#include <bitmagic/bm.h>
 
@@ -39,13 +39,14 @@ namespace graphlab {
 
   private:
     using base::monitor;
+    using base::wake_idle_worker;
 
   private:
     /** Remember the number of vertices in the graph */
     size_t num_vertices;  
     
     /** The queue over vertices */
-    mutable_queue<size_t, double> task_queue;
+    indexed_dary_heap<double> task_queue;
 
     /** The lock on the priority queue */
     spinlock queuelock; 
@@ -58,7 +59,7 @@ namespace graphlab {
     std::vector<direct_callback<Graph> > callbacks;
     
     /** Used to assess termination */
-    task_count_termination terminator;
+    sharded_termination terminator;
     
     
   public:
@@ -67,8 +68,10 @@ namespace graphlab {
                        Graph &g, 
                        size_t ncpus) :
       num_vertices(g.num_vertices()),
+      task_queue(g.num_vertices()),
       task_set(g.num_vertices()),
-      callbacks(ncpus, direct_callback<Graph>(this, engine) ) { }
+      callbacks(ncpus, direct_callback<Graph>(this, engine) ),
+      terminator(ncpus) { }
     
 
     ~priority_scheduler() { }
@@ -122,6 +125,7 @@ namespace graphlab {
       vertex_id_t vertex = task.vertex();
       task_queue.insert_max(vertex, priority);
       queuelock.unlock();
+      if(first_add) wake_idle_worker();
       // Update any listeners
       if(monitor != NULL) {
         if(first_add) {
@@ -157,7 +161,7 @@ namespace graphlab {
                               const std::vector<edge_id_t>& updatededges){}
 
     void completed_task(size_t cpuid, const update_task_type& task) {
-      terminator.completed_job();
+      terminator.completed_job(cpuid);
     }
     
     void abort() { terminator.abort(); }
@@ -0,0 +1,361 @@
+/**
+ * This class defines a relaxed priority scheduler in which the cpus
+ * pop from a few of many priority queues, trading the order of the
+ * updates for throughput.
+ **/
+#ifndef GRAPHLAB_RELAXED_PRIORITY_SCHEDULER_HPP
+#define GRAPHLAB_RELAXED_PRIORITY_SCHEDULER_HPP
+
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <cstring>
+#include <cassert>
+
+#include <graphlab/graph/graph.hpp>
+#include <graphlab/scope/iscope.hpp>
+#include <graphlab/tasks/update_task.hpp>
+#include <graphlab/schedulers/ischeduler.hpp>
+#include <graphlab/parallel/pthread_tools.hpp>
+#include <graphlab/util/random.hpp>
+#include <graphlab/schedulers/support/direct_callback.hpp>
+#include <graphlab/schedulers/support/binary_vertex_task_set.hpp>
+#include <graphlab/util/sharded_termination.hpp>
+
+
+#include <graphlab/macros_def.hpp>
+namespace graphlab {
+
+  /**
+   * A MultiQueue priority scheduler. There are queues_per_cpu
+   * priority queues of vertices per cpu, and a task is added to a
+   * random queue. To get a task, a cpu compares the top priorities of
+   * two queues, which are read without locking, and pops the higher.
+   * A cpu keeps using the same two queues for stickiness pops before
+   * choosing two new ones at random, which keeps the queues it works
+   * on in its cache. The task returned is close to the highest
+   * priority one, but is not guaranteed to be.
+   *
+   * More queues per cpu and more stickiness mean less contention and
+   * more throughput but updates further from priority order. With one
+   * queue per cpu and a stickiness of 1 the order is closest to that
+   * of the priority scheduler.
+   *
+   * A vertex is queued at the highest priority it was given since it
+   * was last run, whatever its update functions. Raising the priority
+   * of a queued vertex adds a second entry for it instead of finding
+   * and updating the first, and entries of vertices which no longer
+   * have a task are skipped.
+   */
+  template<typename Graph>
+  class relaxed_priority_scheduler :
+    public ischeduler<Graph> {
+
+  public:
+    typedef Graph graph_type;
+    typedef ischeduler<Graph> base;
+
+    typedef typename base::iengine_type iengine_type;
+    typedef typename base::update_task_type update_task_type;
+    typedef typename base::update_function_type update_function_type;
+    typedef typename base::callback_type callback_type;
+    typedef typename base::monitor_type monitor_type;
+
+    /// The number of queues per cpu unless set with set_option()
+    static const size_t DEFAULT_QUEUES_PER_CPU = 2;
+    /// The number of pops from the same queues unless set with set_option()
+    static const size_t DEFAULT_STICKINESS = 8;
+
+  private:
+    using base::monitor;
+    using base::wake_idle_worker;
+
+    /// The priority of a vertex which is not queued
+    static double not_queued() { return -std::numeric_limits<double>::max(); }
+
+    /// A queue entry: the priority of a vertex when it was queued
+    typedef std::pair<double, vertex_id_t> queue_entry;
+
+    struct relaxed_queue {
+      /// a binary max heap of the entries
+      std::vector<queue_entry> heap;
+      spinlock lock;
+      /// the priority at the top of the heap, read without the lock
+      volatile double top;
+      char padding[64];
+      relaxed_queue() : top(not_queued()) { }
+    };
+
+    /// The queues a cpu pops from and how many more pops it uses them for
+    struct cpu_state {
+      size_t queues[2];
+      size_t remaining;
+      char padding[64];
+      cpu_state() : remaining(0) { }
+    };
+
+  public:
+
+    relaxed_priority_scheduler(iengine_type* engine,
+                               Graph &g,
+                               size_t ncpus) :
+      num_vertices(g.num_vertices()),
+      ncpus(ncpus),
+      stickiness(DEFAULT_STICKINESS),
+      queues(DEFAULT_QUEUES_PER_CPU * ncpus),
+      cpustate(ncpus),
+      vertex_priority(g.num_vertices(), not_queued()),
+      task_set(g.num_vertices()),
+      callbacks(ncpus, direct_callback<Graph>(this, engine)),
+      terminator(ncpus) { }
+
+
+    ~relaxed_priority_scheduler() { }
+
+    callback_type& get_callback(size_t cpuid) {
+      return callbacks[cpuid];
+    }
+
+    /**
+     * Sets the number of queues per cpu. Must be called before tasks
+     * are added.
+     */
+    void set_queues_per_cpu(size_t queues_per_cpu) {
+      queues.clear();
+      queues.resize(std::max(queues_per_cpu, size_t(1)) * ncpus);
+      for (size_t i = 0; i < cpustate.size(); ++i) cpustate[i].remaining = 0;
+    }
+
+    /// Sets the number of pops a cpu makes before choosing new queues
+    void set_stickiness(size_t pops) {
+      stickiness = std::max(pops, size_t(1));
+    }
+
+    void set_option(scheduler_options::options_enum opt, void* value) {
+      if (opt == scheduler_options::QUEUES_PER_CPU) {
+        set_queues_per_cpu((size_t)(value));
+      }
+      else if (opt == scheduler_options::STICKINESS) {
+        set_stickiness((size_t)(value));
+      }
+      else {
+        logger(LOG_WARNING,
+               "Relaxed Priority Scheduler was passed an invalid option %d", opt);
+      }
+    }
+
+
+    /** Get the next element in the queue */
+    sched_status::status_enum get_next_task(size_t cpuid,
+                                            update_task_type& ret_task) {
+      if (terminator.is_aborted()) return sched_status::COMPLETE;
+      cpu_state& state = cpustate[cpuid];
+      double priority = 0;
+      // Pop from the better of two queues, choosing new ones when the
+      // current ones run out
+      for (size_t attempt = 0; attempt < queues.size(); ++attempt) {
+        if (state.remaining == 0) {
+          choose_queues(state);
+          state.remaining = stickiness;
+        }
+        const size_t q0 = state.queues[0], q1 = state.queues[1];
+        const size_t q = queues[q0].top >= queues[q1].top ? q0 : q1;
+        if (queues[q].top == not_queued()) {
+          state.remaining = 0;
+          continue;
+        }
+        // the entry popped may be stale, which does not make the
+        // queues worse to use
+        if (!pop_task(q, ret_task, priority)) continue;
+        --state.remaining;
+        return scheduled(ret_task, priority);
+      }
+      // The sampled queues are empty. Look through all of them before
+      // concluding there is no work
+      for (size_t i = 0; i < queues.size(); ++i) {
+        const size_t q = (cpuid + i) % queues.size();
+        while (queues[q].top != not_queued()) {
+          if (pop_task(q, ret_task, priority)) return scheduled(ret_task, priority);
+        }
+      }
+      if (terminator.finish()) return sched_status::COMPLETE;
+      return sched_status::WAITING;
+    } // end of get next task
+
+
+    void add_task(update_task_type task, double priority) {
+      const bool first_add = task_set.add(task);
+      if (first_add) terminator.new_job();
+      // Queue the vertex again only if its priority went up
+      const vertex_id_t vertex = task.vertex();
+      if (raise_priority(vertex, priority)) {
+        push(random::rand_int(queues.size() - 1), queue_entry(priority, vertex));
+      }
+      if (first_add) wake_idle_worker();
+      if (monitor != NULL) {
+        if (first_add) monitor->scheduler_task_added(task, priority);
+        else monitor->scheduler_task_pruned(task);
+      }
+    } // end of add_task
+
+
+    void add_tasks(const std::vector<vertex_id_t> &vertices,
+                   update_function_type func,
+                   double priority) {
+      foreach(vertex_id_t vertex, vertices) {
+        add_task(update_task_type(vertex, func), priority);
+      }
+    } // end of add tasks
+
+
+    void add_task_to_all(update_function_type func, double priority) {
+      for (vertex_id_t vertex = 0; vertex < num_vertices; ++vertex){
+        add_task(update_task_type(vertex, func), priority);
+      }
+    } // end of add tasks to all
+
+    void update_state(size_t cpuid,
+                      const std::vector<vertex_id_t> &updated_vertices,
+                      const std::vector<edge_id_t>& updatededges) { }
+
+    void scoped_modifications(size_t cpuid, vertex_id_t rootvertex,
+                              const std::vector<edge_id_t>& updatededges){}
+
+    void completed_task(size_t cpuid, const update_task_type& task) {
+      terminator.completed_job(cpuid);
+    }
+
+    void abort() { terminator.abort(); }
+
+    void restart() { terminator.restart(); }
+
+  private:
+
+    /// Picks two different queues at random
+    void choose_queues(cpu_state& state) {
+      const size_t n = queues.size();
+      state.queues[0] = random::rand_int(n - 1);
+      state.queues[1] = state.queues[0];
+      if (n > 1) {
+        state.queues[1] = random::rand_int(n - 2);
+        if (state.queues[1] >= state.queues[0]) ++state.queues[1];
+      }
+    }
+
+    void push(size_t q, const queue_entry& entry) {
+      relaxed_queue& queue = queues[q];
+      queue.lock.lock();
+      queue.heap.push_back(entry);
+      std::push_heap(queue.heap.begin(), queue.heap.end());
+      queue.top = queue.heap.front().first;
+      queue.lock.unlock();
+    }
+
+    /**
+     * Pops the top entry of queue q and takes one of the tasks of its
+     * vertex. Returns false if the queue was empty or the vertex had
+     * no task left.
+     */
+    bool pop_task(size_t q, update_task_type& ret_task, double& priority) {
+      relaxed_queue& queue = queues[q];
+      queue.lock.lock();
+      if (queue.heap.empty()) {
+        queue.lock.unlock();
+        return false;
+      }
+      std::pop_heap(queue.heap.begin(), queue.heap.end());
+      const queue_entry entry = queue.heap.back();
+      queue.heap.pop_back();
+      queue.top = queue.heap.empty() ? not_queued() : queue.heap.front().first;
+      queue.lock.unlock();
+
+      const vertex_id_t vertex = entry.second;
+      priority = entry.first;
+      // Mark the vertex as not queued before taking the task so that a
+      // task added from now on queues it again
+      __sync_lock_test_and_set(priority_bits(vertex),
+                               double_bits(not_queued()));
+      size_t* bits = &task_set.vertexbits[vertex];
+      size_t oldbits, newbits;
+      do {
+        oldbits = *bits;
+        if (oldbits == 0) return false;
+        newbits = oldbits & (oldbits - 1);
+      } while (!__sync_bool_compare_and_swap(bits, oldbits, newbits));
+      const size_t func = __builtin_ctzl(oldbits);
+      ret_task = update_task_type(vertex, task_set.updatefuncs[func]);
+      // The vertex has other update functions to run
+      if (newbits != 0 && raise_priority(vertex, priority)) {
+        push(q, entry);
+      }
+      return true;
+    }
+
+    sched_status::status_enum scheduled(const update_task_type& task,
+                                        double priority) {
+      if (monitor != NULL)
+        monitor->scheduler_task_scheduled(task, priority);
+      return sched_status::NEWTASK;
+    }
+
+    /**
+     * Sets the priority of the vertex to priority if that is higher.
+     * Returns true if it was raised.
+     */
+    bool raise_priority(vertex_id_t vertex, double priority) {
+      uint64_t* bits = priority_bits(vertex);
+      while (true) {
+        const uint64_t oldbits = *bits;
+        if (bits_double(oldbits) >= priority) return false;
+        if (__sync_bool_compare_and_swap(bits, oldbits, double_bits(priority)))
+          return true;
+      }
+    }
+
+    uint64_t* priority_bits(vertex_id_t vertex) {
+      return reinterpret_cast<uint64_t*>(&vertex_priority[vertex]);
+    }
+
+    static uint64_t double_bits(double d) {
+      uint64_t ret;
+      memcpy(&ret, &d, sizeof(ret));
+      return ret;
+    }
+
+    static double bits_double(uint64_t bits) {
+      double ret;
+      memcpy(&ret, &bits, sizeof(ret));
+      return ret;
+    }
+
+    /** Remember the number of vertices in the graph */
+    size_t num_vertices;
+
+    size_t ncpus;
+
+    /** The number of pops a cpu makes from the same two queues */
+    size_t stickiness;
+
+    std::vector<relaxed_queue> queues;
+
+    std::vector<cpu_state> cpustate;
+
+    /** The priority each vertex is queued at, or not_queued() */
+    std::vector<double> vertex_priority;
+
+    /** The update functions each vertex has a task for */
+    binary_vertex_task_set<Graph> task_set;
+
+    /** The callbacks pre-created for each cpuid */
+    std::vector<direct_callback<Graph> > callbacks;
+
+    /** Used to assess termination */
+    sharded_termination terminator;
+
+  }; // end of relaxed_priority_scheduler
+
+
+} // end of namespace graphlab
+#include <graphlab/macros_undef.hpp>
+
+#endif
@@ -40,6 +40,7 @@ namespace graphlab {
 
   private:
     using base::monitor;
+    using base::wake_idle_worker;
     
     //! Remember the number of vertices in the graph
     size_t num_vertices;
@@ -143,6 +144,7 @@ namespace graphlab {
                       vertex_tasks.top_priority(task.vertex()));
       // Release the lock
       locks[task.vertex()].unlock();
+      if(newadd) wake_idle_worker();
       // Notify the listener
       if(monitor != NULL) {
         if(newadd) {
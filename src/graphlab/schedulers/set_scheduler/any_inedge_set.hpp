@@ -119,7 +119,7 @@ namespace graphlab {
       }
     
       if (reprobeall) {
-        const std::vector<edge_id_t> &inedges = g->in_edge_ids(v);
+        edge_list inedges = g->in_edge_ids(v);
         for(size_t i = 0; i < inedges.size(); ++i) {
           unsync_modify_edge(parent, inedges[i]);
         }
@@ -127,7 +127,7 @@ namespace graphlab {
       else {
         // if update probe says no, we delete the vertex from the set
         // unset all the inedges of v
-        const std::vector<edge_id_t> &inedges = g->in_edge_ids(v);
+        edge_list inedges = g->in_edge_ids(v);
         for(size_t i = 0; i < inedges.size(); ++i) {
           edgeset.clear_bit(inedges[i]);
         }
@@ -297,7 +297,7 @@ namespace graphlab {
       // we don't have the data for this edge, so we have to check it
       // vertex tests take a while. so we acquire the scope
       // to make sure no one else gets here
-      const std::vector<edge_id_t>& inedges = g->in_edge_ids(v);
+      edge_list inedges = g->in_edge_ids(v);
       bool inset = false;
       vset_inedgecount[v] = 0;
       for (size_t i = 0;i < inedges.size(); ++i) {
@@ -13,7 +13,7 @@
 #include <map>
 #include <algorithm>
 
-#include <graphlab/util/mutable_queue.hpp>
+#include <graphlab/util/indexed_dary_heap.hpp>
 
 
 #include <graphlab/graph/graph.hpp>
@@ -59,7 +59,7 @@ namespace graphlab {
     typedef std::vector<vertex_id_t> splash_type;
     
     /** The type of the priority queue */
-    typedef mutable_queue<size_t, double> pqueue_type;
+    typedef indexed_dary_heap<double> pqueue_type;
         
   public:
     
@@ -286,8 +286,9 @@ namespace graphlab {
       
       // Add the roots neighbors to the BFS queue and mark them as
       // visited
-      std::vector<edge_id_t> in_edge_ids =
-        graph.in_edge_ids(root);
+      const edge_list root_in_edges = graph.in_edge_ids(root);
+      std::vector<edge_id_t> in_edge_ids(root_in_edges.begin(),
+                                         root_in_edges.end());
       std::random_shuffle(in_edge_ids.begin(), in_edge_ids.end());
       foreach(edge_id_t ineid, in_edge_ids) {
         vertex_id_t neighbor = graph.source(ineid);
@@ -315,8 +316,9 @@ namespace graphlab {
         splash.push_back(vertex);
         splash_work += vertex_work;
         // Add all the neighbors to the tree
-        std::vector<edge_id_t> in_edge_ids =
-          graph.in_edge_ids(vertex);
+        const edge_list vertex_in_edges = graph.in_edge_ids(vertex);
+        std::vector<edge_id_t> in_edge_ids(vertex_in_edges.begin(),
+                                           vertex_in_edges.end());
         std::random_shuffle(in_edge_ids.begin(), in_edge_ids.end());
         foreach(edge_id_t eid, in_edge_ids) {
           vertex_id_t neighbor = graph.source(eid);
@@ -3,12 +3,14 @@
 
 #include <graphlab/schedulers/ischeduler.hpp>
 #include <graphlab/schedulers/icallback.hpp>
+#include <graphlab/schedulers/support/vertex_frontier.hpp>
 #include <graphlab/logger/logger.hpp>
 
 namespace graphlab {
   /**
      This is a special callback which only records whether or not
-     add_tasks was called
+     add_tasks was called and, if a frontier is set, which vertices
+     were scheduled
   */
   template<typename Graph>
   class binary_scheduler_callback : 
@@ -22,12 +24,13 @@ namespace graphlab {
     typedef typename base::update_function_type update_function_type;
  
   public:
-    binary_scheduler_callback() {add_task_called= false; }
+    binary_scheduler_callback() : frontier(NULL) {add_task_called= false; }
     virtual ~binary_scheduler_callback() {}
   
     void add_task(update_task_type task, double priority) {
 		//logger(LOG_INFO,"task vertexid=%u",task.vertex());
       add_task_called = true;
+      if(frontier != NULL) frontier->add(task.vertex());
     }
     /** Creates a collection of tasks on all the vertices in
         'vertices', and all with the same update function and
@@ -35,6 +38,16 @@ namespace graphlab {
     void add_tasks(const std::vector<vertex_id_t>& vertices, 
                    update_function_type func, double priority) {
       add_task_called = true;
+      if(frontier != NULL) {
+        for(size_t i = 0; i < vertices.size(); ++i)
+          frontier->add(vertices[i]);
+      }
+    }
+
+    /** Record scheduled vertices in the given frontier (NULL to
+        stop recording) */
+    void set_frontier(vertex_frontier* _frontier) {
+      frontier = _frontier;
     }
   
   
@@ -49,6 +62,8 @@ namespace graphlab {
     /// Commits the tasks added
     void commit() { };
     bool add_task_called;
+  private:
+    vertex_frontier* frontier;
   };
 
 }
@@ -0,0 +1,101 @@
+/**
+ * The set of vertices scheduled for the next superstep of a
+ * synchronous computation.
+ **/
+#ifndef VERTEX_FRONTIER_HPP
+#define VERTEX_FRONTIER_HPP
+
+#include <vector>
+#include <cassert>
+#include <algorithm>
+
+#include <graphlab/graph/graph.hpp>
+#include <graphlab/parallel/atomic.hpp>
+#include <graphlab/util/dense_bitset.hpp>
+
+namespace graphlab {
+
+  /**
+   * A set of vertices which is cheap to build concurrently and to
+   * iterate both when it is small and when it is large.
+   *
+   * Membership is kept in a dense_bitset.  The first sparse_capacity
+   * vertices added are also appended to a list.  While the frontier
+   * holds no more than sparse_capacity vertices it is sparse: it can
+   * be iterated and cleared in time proportional to its size through
+   * the list.  Beyond that it is dense and the bitset has to be
+   * scanned.
+   */
+  class vertex_frontier {
+  public:
+    vertex_frontier(size_t nverts = 0, size_t sparse_capacity = 0) {
+      resize(nverts, sparse_capacity);
+    }
+
+    /** Resize to nverts vertices and empty the frontier */
+    void resize(size_t nverts, size_t sparse_capacity) {
+      numvertices = nverts;
+      bits.resize(nverts);
+      bits.clear();
+      list.resize(std::min(sparse_capacity, nverts));
+      count.value = 0;
+    }
+
+    /** Add a vertex returning true if it was not in the frontier.
+        Thread safe. */
+    inline bool add(vertex_id_t v) {
+      assert(v < numvertices);
+      if(bits.get(v) || bits.set_bit(v)) return false;
+      const size_t index = count.inc() - 1;
+      if(index < list.size()) list[index] = v;
+      return true;
+    }
+
+    inline bool contains(vertex_id_t v) const { return bits.get(v); }
+
+    //! Number of vertices in the frontier
+    inline size_t size() const { return count.value; }
+
+    inline bool empty() const { return count.value == 0; }
+
+    //! Total number of vertices
+    inline size_t num_vertices() const { return numvertices; }
+
+    /** True if the frontier can be iterated with sparse_vertex() */
+    inline bool is_sparse() const { return count.value <= list.size(); }
+
+    /** The i'th vertex added. Only valid if the frontier is sparse. */
+    inline vertex_id_t sparse_vertex(size_t i) const {
+      assert(i < count.value && i < list.size());
+      return list[i];
+    }
+
+    /** Add every vertex. The frontier becomes dense. */
+    void fill() {
+      bits.fill();
+      count.value = numvertices;
+    }
+
+    /** Remove every vertex.  Not thread safe. */
+    void clear() {
+      if(is_sparse()) {
+        for(size_t i = 0; i < count.value; ++i) bits.clear_bit(list[i]);
+      } else {
+        bits.clear();
+      }
+      count.value = 0;
+    }
+
+  private:
+    size_t numvertices;
+    dense_bitset bits;
+    std::vector<vertex_id_t> list;
+    atomic<size_t> count;
+
+    // Not copyable
+    vertex_frontier(const vertex_frontier&);
+    vertex_frontier& operator=(const vertex_frontier&);
+  }; // end of vertex_frontier
+
+} // end of namespace graphlab
+#endif
@@ -0,0 +1,310 @@
+/**
+ * This class defines a work stealing scheduler. Each cpu owns a
+ * lock-free deque. Tasks created by an update function go onto the
+ * deque of the cpu running it and idle cpus steal from random
+ * victims, preferring victims on their own NUMA node in NUMA mode.
+ **/
+#ifndef GRAPHLAB_WORK_STEALING_SCHEDULER_HPP
+#define GRAPHLAB_WORK_STEALING_SCHEDULER_HPP
+
+#include <deque>
+#include <vector>
+#include <cassert>
+
+#include <graphlab/graph/graph.hpp>
+#include <graphlab/scope/iscope.hpp>
+#include <graphlab/tasks/update_task.hpp>
+#include <graphlab/schedulers/ischeduler.hpp>
+#include <graphlab/parallel/pthread_tools.hpp>
+#include <graphlab/parallel/atomic.hpp>
+#include <graphlab/parallel/chase_lev_deque.hpp>
+#include <graphlab/schedulers/support/vertex_task_set.hpp>
+#include <graphlab/schedulers/support/direct_callback.hpp>
+#include <graphlab/util/sharded_termination.hpp>
+#include <graphlab/util/random.hpp>
+
+
+#include <graphlab/macros_def.hpp>
+
+namespace graphlab {
+
+  /**
+   * Work stealing scheduler.
+   *
+   * Every cpu has a Chase-Lev deque (see chase_lev_deque).  Tasks
+   * added through the callback of a cpu are pushed on that cpu's
+   * deque and run in FIFO order by the same cpu.  A cpu whose deque is
+   * empty first drains a batch of tasks from the shared injection
+   * queue (tasks added from outside the workers, e.g. by
+   * add_task_to_all()) and then tries to steal from randomly chosen
+   * victims.
+   *
+   * As in the fifo scheduler a task is only queued once while it is
+   * pending (vertex_task_set) and termination is detected with a
+   * sharded_termination.
+   */
+  template<typename Graph>
+  class work_stealing_scheduler : public ischeduler<Graph> {
+  public:
+    typedef Graph graph_type;
+    typedef ischeduler<Graph> base;
+
+    typedef typename base::iengine_type iengine_type;
+    typedef typename base::update_task_type update_task_type;
+    typedef typename base::update_function_type update_function_type;
+    typedef typename base::callback_type callback_type;
+    typedef typename base::monitor_type monitor_type;
+
+    typedef chase_lev_deque<update_task_type> deque_type;
+
+    /**
+     * The callback of a cpu.  Behaves like direct_callback except
+     * that tasks go onto the local deque of the cpu.
+     */
+    class local_callback : public direct_callback<Graph> {
+    public:
+      typedef direct_callback<Graph> callback_base;
+      local_callback(work_stealing_scheduler* ws = NULL,
+                     iengine_type* engine = NULL,
+                     size_t cpuid = 0) :
+        callback_base(ws, engine), ws(ws), cpuid(cpuid) { }
+
+      void add_task(update_task_type task, double priority) {
+        assert(task.function() != NULL);
+        if (!callback_base::buffering_enabled) {
+          ws->add_local_task(cpuid, task, priority);
+        } else {
+          callback_base::tasks.push_back(std::make_pair(task, priority));
+        }
+      }
+
+      void commit() {
+        if(callback_base::buffering_enabled) {
+          for(size_t i = 0; i < callback_base::tasks.size(); ++i) {
+            ws->add_local_task(cpuid, callback_base::tasks[i].first,
+                               callback_base::tasks[i].second);
+          }
+          callback_base::tasks.clear();
+        }
+      }
+    private:
+      work_stealing_scheduler* ws;
+      size_t cpuid;
+    }; // end of local_callback
+
+  private:
+    using base::monitor;
+    using base::wake_idle_worker;
+    using base::numa;
+
+  public:
+
+    work_stealing_scheduler(iengine_type* engine,
+                            Graph& g,
+                            size_t ncpus) :
+      deques(ncpus),
+      vertex_tasks(g.num_vertices()),
+      injection_batch(64),
+      terminator(ncpus) {
+      numvertices = g.num_vertices();
+      callbacks.reserve(ncpus);
+      for(size_t i = 0; i < ncpus; ++i) {
+        deques[i] = new deque_type();
+        callbacks.push_back(local_callback(this, engine, i));
+      }
+    }
+
+    ~work_stealing_scheduler() {
+      for(size_t i = 0; i < deques.size(); ++i) delete deques[i];
+    }
+
+    callback_type& get_callback(size_t cpuid) {
+      return callbacks[cpuid];
+    }
+
+
+    /** Get the next task: local deque, then injection queue, then steal */
+    sched_status::status_enum get_next_task(size_t cpuid,
+                                            update_task_type &ret_task) {
+      if (terminator.is_aborted()) return sched_status::COMPLETE;
+      assert(cpuid < deques.size());
+      // The local deque is consumed from the top (FIFO) like the
+      // thieves do.  Popping the bottom (LIFO) is cheaper but turns
+      // residual style updates such as PageRank into a depth first
+      // sweep that needs many times more updates to converge.
+      bool success = deques[cpuid]->steal(ret_task) ||
+        take_injected(cpuid, ret_task) ||
+        steal(cpuid, ret_task);
+      if(!success) {
+        // Only sweep the termination counters when there is no work
+        return terminator.finish() ? sched_status::COMPLETE :
+          sched_status::WAITING;
+      }
+      if (monitor != NULL) {
+        double priority = vertex_tasks.top_priority(ret_task.vertex());
+        monitor->scheduler_task_scheduled(ret_task, priority);
+      }
+      vertex_tasks.remove(ret_task);
+      return sched_status::NEWTASK;
+    } // end of get_next_task
+
+
+    /**
+     * Add a task from outside the worker threads.  These go through
+     * the locked injection queue since only the owner of a deque may
+     * push onto it.
+     */
+    void add_task(update_task_type task, double priority) {
+      if (vertex_tasks.add(task)) {
+        terminator.new_job();
+        injection_lock.lock();
+        injection_queue.push_back(task);
+        injection_count.inc();
+        injection_lock.unlock();
+        wake_idle_worker();
+        if (monitor != NULL)
+          monitor->scheduler_task_added(task, priority);
+      } else {
+        if (monitor != NULL)
+          monitor->scheduler_task_pruned(task);
+      }
+    } // end of add_task
+
+
+    /** Add a task from the worker cpuid onto its own deque */
+    void add_local_task(size_t cpuid, update_task_type task, double priority) {
+      assert(cpuid < deques.size());
+      if (vertex_tasks.add(task)) {
+        terminator.new_job(cpuid);
+        deques[cpuid]->push(task);
+        wake_idle_worker();
+        if (monitor != NULL)
+          monitor->scheduler_task_added(task, priority);
+      } else {
+        if (monitor != NULL)
+          monitor->scheduler_task_pruned(task);
+      }
+    } // end of add_local_task
+
+    void add_tasks(const std::vector<vertex_id_t> &vertices,
+                   update_function_type func,
+                   double priority) {
+      foreach(vertex_id_t vertex, vertices) {
+        add_task(update_task_type(vertex, func), priority);
+      }
+    } // end of add_tasks
+
+    void add_task_to_all(update_function_type func, double priority) {
+      for (vertex_id_t vertex = 0; vertex < numvertices; ++vertex){
+        add_task(update_task_type(vertex, func), priority);
+      }
+    } // end of add_task_to_all
+
+    void update_state(size_t cpuid,
+                      const std::vector<vertex_id_t> &updated_vertices,
+                      const std::vector<edge_id_t>& updatededges) {};
+
+    void scoped_modifications(size_t cpuid, vertex_id_t rootvertex,
+                              const std::vector<edge_id_t>& updatededges){}
+
+    void completed_task(size_t cpuid, const update_task_type &task) {
+      terminator.completed_job(cpuid);
+    }
+
+    void abort() { terminator.abort(); }
+
+    void restart() { terminator.restart(); }
+
+    bool is_task_scheduled(update_task_type task)  {
+      return vertex_tasks.get(task);
+    }
+
+    void print() {
+      std::cout << "Work stealing deque sizes: " << std::endl;
+      for(size_t i = 0; i < deques.size(); ++i) {
+        std::cout << deques[i]->size() << std::endl;
+      }
+      std::cout << "Injection queue size: " << injection_queue.size()
+                << std::endl;
+    }
+
+  private:
+
+    /**
+     * Move up to injection_batch tasks from the injection queue onto
+     * the local deque and return one of them.
+     */
+    bool take_injected(size_t cpuid, update_task_type& ret_task) {
+      // Cheap unlocked check before taking the lock
+      if(injection_count.value == 0) return false;
+      bool success = false;
+      injection_lock.lock();
+      if(!injection_queue.empty()) {
+        ret_task = injection_queue.front();
+        injection_queue.pop_front();
+        success = true;
+        for(size_t i = 1; i < injection_batch && !injection_queue.empty(); ++i) {
+          deques[cpuid]->push(injection_queue.front());
+          injection_queue.pop_front();
+        }
+        injection_count.value = injection_queue.size();
+      }
+      injection_lock.unlock();
+      return success;
+    } // end of take_injected
+
+    /**
+     * Try each other deque once starting from a random victim.  In
+     * NUMA mode the workers on the same node are tried first.
+     */
+    bool steal(size_t cpuid, update_task_type& ret_task) {
+      const size_t ndeques = deques.size();
+      if(ndeques < 2) return false;
+      if(numa != NULL) {
+        const size_t node = numa->worker_node(cpuid, ndeques);
+        const size_t first = numa->node_worker_begin(node, ndeques);
+        const size_t count = numa->node_worker_begin(node + 1, ndeques) - first;
+        if(count > 1) {
+          const size_t start = random::rand_int(count - 1);
+          for(size_t i = 0; i < count; ++i) {
+            const size_t victim = first + (start + i) % count;
+            if(victim == cpuid) continue;
+            if(deques[victim]->steal(ret_task)) return true;
+          }
+        }
+      }
+      const size_t start = random::rand_int(ndeques - 1);
+      for(size_t i = 0; i < ndeques; ++i) {
+        const size_t victim = (start + i) % ndeques;
+        if(victim == cpuid) continue;
+        if(deques[victim]->steal(ret_task)) return true;
+      }
+      return false;
+    } // end of steal
+
+    size_t numvertices; /// Remember the number of vertices in the graph
+
+    /// One deque per cpu
+    std::vector<deque_type*> deques;
+
+    /// Tasks added from outside the workers
+    std::deque<update_task_type> injection_queue;
+    atomic<size_t> injection_count;
+    spinlock injection_lock;
+
+    /// The callbacks pre-created for each cpuid
+    std::vector<local_callback> callbacks;
+
+    /// The set of pending tasks
+    vertex_task_set<Graph> vertex_tasks;
+
+    /// Number of tasks moved from the injection queue at once
+    size_t injection_batch;
+
+    sharded_termination terminator;
+  }; // end of work_stealing_scheduler
+
+} // end of namespace graphlab
+#include <graphlab/macros_undef.hpp>
+
+#endif
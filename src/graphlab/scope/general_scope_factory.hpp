@@ -22,6 +22,33 @@ namespace graphlab {
     typedef typename base::iscope_type iscope_type;
     typedef general_scope<Graph> general_scope_type;
 
+    /**
+     * The neighbors of a vertex in sorted edge order.  When the graph
+     * is in CSR form the neighbor ids are read directly from the
+     * contiguous neighbor array, otherwise they are looked up through
+     * the edge endpoints.
+     */
+    struct neighbor_list {
+      const Graph* g;
+      edge_list eids;
+      vertex_list nbrs;
+      bool incoming;
+      bool csr;
+      neighbor_list(const Graph& graph, vertex_id_t v, bool incoming) :
+        g(&graph), incoming(incoming), csr(graph.csr_storage()) {
+        if (csr) {
+          nbrs = incoming ? graph.in_neighbor_ids(v) : graph.out_neighbor_ids(v);
+        } else {
+          eids = incoming ? graph.in_edge_ids(v) : graph.out_edge_ids(v);
+        }
+      }
+      size_t size() const { return csr ? nbrs.size() : eids.size(); }
+      vertex_id_t operator[](size_t i) const {
+        if (csr) return nbrs[i];
+        return incoming ? g->source(eids[i]) : g->target(eids[i]);
+      }
+    };
+
     general_scope_factory(Graph& graph,
                           size_t ncpus,
                           scope_range::scope_range_enum default_scope_range = scope_range::NULL_CONSISTENCY) :
@@ -83,8 +110,8 @@ namespace graphlab {
       scope->init(&graph, v);
       scope->stype = scope_range::FULL_CONSISTENCY;
 
-      const std::vector<edge_id_t> &inedges =  graph.in_edge_ids(v);
-      const std::vector<edge_id_t> &outedges = graph.out_edge_ids(v);
+      neighbor_list inedges(graph, v, true);
+      neighbor_list outedges(graph, v, false);
 
       size_t inidx = 0;
       size_t outidx = 0;
@@ -92,8 +119,8 @@ namespace graphlab {
       bool curlocked = false;
       size_t numv = graph.num_vertices();
       vertex_id_t curv = scope->vertex();
-      vertex_id_t inv  = (inedges.size() > 0) ? graph.source(inedges[0]) : numv;
-      vertex_id_t outv  = (outedges.size() > 0) ? graph.target(outedges[0]) : numv;
+      vertex_id_t inv  = (inedges.size() > 0) ? inedges[0] : numv;
+      vertex_id_t outv  = (outedges.size() > 0) ? outedges[0] : numv;
       // iterate both in order and lock
       // include the current vertex in the iteration
       while (inidx < inedges.size() || outidx < outedges.size()) {
@@ -103,15 +130,15 @@ namespace graphlab {
           curv = numv;
         } else if (inv < outv) {
           locks[inv].writelock(); ++inidx;
-          inv = (inedges.size() > inidx) ? graph.source(inedges[inidx]) : numv;
+          inv = (inedges.size() > inidx) ? inedges[inidx] : numv;
         } else if (outv < inv) {
           locks[outv].writelock(); ++outidx;
-          outv= (outedges.size() > outidx) ? graph.target(outedges[outidx]) : numv;
+          outv= (outedges.size() > outidx) ? outedges[outidx] : numv;
         } else if (inv == outv){
           locks[inv].writelock();
           ++inidx; ++outidx;
-          inv = (inedges.size() > inidx) ? graph.source(inedges[inidx]) : numv;
-          outv= (outedges.size() > outidx) ? graph.target(outedges[outidx]) : numv;
+          inv = (inedges.size() > inidx) ? inedges[inidx] : numv;
+          outv= (outedges.size() > outidx) ? outedges[outidx] : numv;
         }
       }
       // just in case we never got around to locking it
@@ -128,8 +155,8 @@ namespace graphlab {
       scope->init(&graph, v);
       scope->stype = scope_range::EDGE_CONSISTENCY;
 
-      const std::vector<edge_id_t> &inedges =  graph.in_edge_ids(v);
-      const std::vector<edge_id_t> &outedges = graph.out_edge_ids(v);
+      neighbor_list inedges(graph, v, true);
+      neighbor_list outedges(graph, v, false);
 
       size_t inidx = 0;
       size_t outidx = 0;
@@ -137,8 +164,8 @@ namespace graphlab {
       bool curlocked = false;
       size_t numv = graph.num_vertices();
       vertex_id_t curv = scope->vertex();
-      vertex_id_t inv  = (inedges.size() > 0) ? graph.source(inedges[0]) : numv;
-      vertex_id_t outv  = (outedges.size() > 0) ? graph.target(outedges[0]) : numv;
+      vertex_id_t inv  = (inedges.size() > 0) ? inedges[0] : numv;
+      vertex_id_t outv  = (outedges.size() > 0) ? outedges[0] : numv;
       // iterate both in order and lock
       // include the current vertex in the iteration
       while (inidx < inedges.size() || outidx < outedges.size()) {
@@ -148,15 +175,15 @@ namespace graphlab {
           curv = numv;
         } else if (inv < outv) {
           locks[inv].readlock(); ++inidx;
-          inv = (inedges.size() > inidx) ? graph.source(inedges[inidx]) : numv;
+          inv = (inedges.size() > inidx) ? inedges[inidx] : numv;
         } else if (outv < inv) {
           locks[outv].readlock(); ++outidx;
-          outv= (outedges.size() > outidx) ? graph.target(outedges[outidx]) : numv;
+          outv= (outedges.size() > outidx) ? outedges[outidx] : numv;
         } else if (inv == outv){
           locks[inv].readlock();
           ++inidx; ++outidx;
-          inv = (inedges.size() > inidx) ? graph.source(inedges[inidx]) : numv;
-          outv= (outedges.size() > outidx) ? graph.target(outedges[outidx]) : numv;
+          inv = (inedges.size() > inidx) ? inedges[inidx] : numv;
+          outv= (outedges.size() > outidx) ? outedges[outidx] : numv;
         }
       }
       // just in case we never got around to locking it
@@ -196,8 +223,8 @@ namespace graphlab {
       scope->init(&graph, v);
       scope->stype = scope_range::READ_CONSISTENCY;
 
-      const std::vector<edge_id_t> &inedges =  graph.in_edge_ids(v);
-      const std::vector<edge_id_t> &outedges = graph.out_edge_ids(v);
+      neighbor_list inedges(graph, v, true);
+      neighbor_list outedges(graph, v, false);
 
       size_t inidx = 0;
       size_t outidx = 0;
@@ -205,8 +232,8 @@ namespace graphlab {
       bool curlocked = false;
       size_t numv = graph.num_vertices();
       vertex_id_t curv = scope->vertex();
-      vertex_id_t inv  = (inedges.size() > 0) ? graph.source(inedges[0]) : numv;
-      vertex_id_t outv  = (outedges.size() > 0) ? graph.target(outedges[0]) : numv;
+      vertex_id_t inv  = (inedges.size() > 0) ? inedges[0] : numv;
+      vertex_id_t outv  = (outedges.size() > 0) ? outedges[0] : numv;
       // iterate both in order and lock
       // include the current vertex in the iteration
       while (inidx < inedges.size() || outidx < outedges.size()) {
@@ -216,15 +243,15 @@ namespace graphlab {
           curv = numv;
         } else if (inv < outv) {
           locks[inv].readlock(); ++inidx;
-          inv = (inedges.size() > inidx) ? graph.source(inedges[inidx]) : numv;
+          inv = (inedges.size() > inidx) ? inedges[inidx] : numv;
         } else if (outv < inv) {
           locks[outv].readlock(); ++outidx;
-          outv= (outedges.size() > outidx) ? graph.target(outedges[outidx]) : numv;
+          outv= (outedges.size() > outidx) ? outedges[outidx] : numv;
         } else if (inv == outv){
           locks[inv].readlock();
           ++inidx; ++outidx;
-          inv = (inedges.size() > inidx) ? graph.source(inedges[inidx]) : numv;
-          outv= (outedges.size() > outidx) ? graph.target(outedges[outidx]) : numv;
+          inv = (inedges.size() > inidx) ? inedges[inidx] : numv;
+          outv= (outedges.size() > outidx) ? outedges[outidx] : numv;
         }
       }
       // just in case we never got around to locking it
@@ -268,8 +295,8 @@ namespace graphlab {
 
     void release_full_edge_scope(general_scope_type* scope) {
       vertex_id_t v = scope->vertex();
-      const std::vector<edge_id_t>& inedges =  graph.in_edge_ids(v);
-      const std::vector<edge_id_t>& outedges = graph.out_edge_ids(v);
+      neighbor_list inedges(graph, v, true);
+      neighbor_list outedges(graph, v, false);
       size_t inidx = inedges.size() - 1;
       size_t outidx = outedges.size() - 1;
 
@@ -277,9 +304,9 @@ namespace graphlab {
 
       vertex_id_t curv = scope->vertex();
       vertex_id_t inv  = (inedges.size() > inidx) ?
-        graph.source(inedges[inidx]) : vertex_id_t(-1);
+        inedges[inidx] : vertex_id_t(-1);
       vertex_id_t outv  = (outedges.size() > outidx) ?
-        graph.target(outedges[outidx]) : vertex_id_t(-1);
+        outedges[outidx] : vertex_id_t(-1);
       // iterate both in order and lock
       // include the current vertex in the iteration
       while (inidx < inedges.size() || outidx < outedges.size()) {
@@ -290,18 +317,18 @@ namespace graphlab {
         } else if ((inv+1) > (outv+1)) {
           locks[inv].unlock(); --inidx;
           inv  = (inedges.size() > inidx) ?
-            graph.source(inedges[inidx]) : vertex_id_t(-1);
+            inedges[inidx] : vertex_id_t(-1);
         } else if ((outv+1) > (inv+1)) {
           locks[outv].unlock(); --outidx;
           outv  = (outedges.size() > outidx) ?
-            graph.target(outedges[outidx]) : vertex_id_t(-1);
+            outedges[outidx] : vertex_id_t(-1);
         } else if (inv == outv){
           locks[inv].unlock();
           --inidx; --outidx;
           inv  = (inedges.size() > inidx) ?
-            graph.source(inedges[inidx]) : vertex_id_t(-1);
+            inedges[inidx] : vertex_id_t(-1);
           outv  = (outedges.size() > outidx) ?
-            graph.target(outedges[outidx]) : vertex_id_t(-1);
+            outedges[outidx] : vertex_id_t(-1);
         }
       }
 
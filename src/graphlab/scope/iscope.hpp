@@ -178,10 +178,10 @@ namespace graphlab {
     /** 
      * \brief get all in edges to the base vertex of this scope. 
      * 
-     * This method returns an immutable vector of edge ids sorted in
+     * This method returns an immutable list of edge ids sorted in
      * order of <source id, dest id> pairs.
      */
-    const std::vector<edge_id_t>& in_edge_ids() const {
+    edge_list in_edge_ids() const {
       assert(_graph_ptr != NULL);
       return _graph_ptr->in_edge_ids(_vertex);
     }
@@ -189,10 +189,10 @@ namespace graphlab {
     /** 
      * \brief get all in edge ids to the vertex argument
      *
-     * This method returns an immutable vector of edge ids sorted in
+     * This method returns an immutable list of edge ids sorted in
      * order of <source id, dest id> pairs.
      */
-    const std::vector<edge_id_t>& in_edge_ids(vertex_id_t v) const {
+    edge_list in_edge_ids(vertex_id_t v) const {
       assert(_graph_ptr != NULL);
       return _graph_ptr->in_edge_ids(v);
     }
@@ -201,10 +201,10 @@ namespace graphlab {
     /** 
      * \brief get all out edge ids to the base vertex of this scope
      *
-     * This method returns an immutable vector of edge ids sorted in
+     * This method returns an immutable list of edge ids sorted in
      * order of <source id, dest id> pairs.
      */
-    const std::vector<edge_id_t>& out_edge_ids() const {
+    edge_list out_edge_ids() const {
       assert(_graph_ptr != NULL);
       return _graph_ptr->out_edge_ids(_vertex);
     }
@@ -212,10 +212,10 @@ namespace graphlab {
     /** 
      * \brief get all out ede ids to the vertex argument.
      *
-     * This method returns an immutable vector of edge ids sorted in
+     * This method returns an immutable list of edge ids sorted in
      * order of <source id, dest id> pairs.
      */
-    const std::vector<edge_id_t>& out_edge_ids(vertex_id_t v) const {
+    edge_list out_edge_ids(vertex_id_t v) const {
       assert(_graph_ptr != NULL);
       return _graph_ptr->out_edge_ids(v);
     }
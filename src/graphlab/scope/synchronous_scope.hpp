@@ -1,6 +1,7 @@
 #ifndef GRAPHLAB_SYNCHRONOUS_SCOPE_HPP
 #define GRAPHLAB_SYNCHRONOUS_SCOPE_HPP
 
+#include <vector>
 #include <boost/bind.hpp>
 
 
@@ -8,53 +9,53 @@
 
 
 namespace graphlab {
-  
+
   /**
-   * This defines a scope type which is meant for "synchronous" type of 
+   * This defines a scope type which is meant for "synchronous" type of
    * algorithms. This type of scope should only be used by synchronous_engine
+   *
+   * Neighbor vertex data is read from the graph while the data of the
+   * base vertex lives in a separate write buffer (see
+   * synchronous_scope_factory).  In edges are read from one edge
+   * buffer and out edges written to another.  A NULL edge buffer
+   * stands for the edge data stored in the graph.
    */
   template<typename Graph>
-  class synchronous_scope : 
+  class synchronous_scope :
     public iscope<Graph> {
   public:
     typedef iscope<Graph> base;
     typedef typename Graph::vertex_data_type vertex_data_type;
     typedef typename Graph::edge_data_type edge_data_type;
+    typedef std::vector<vertex_data_type> vertex_buffer_type;
+    typedef std::vector<edge_data_type> edge_buffer_type;
 
     using base::_vertex;
     using base::_graph_ptr;
 
   public:
-    synchronous_scope() : base(NULL,0) { }
-
-    // TODO: Why 3 graph arguments?  
-    synchronous_scope(Graph* srcgraph, Graph* destgraph,
-                      Graph* vertexdatagraph, 
-                      vertex_id_t vertex) : 
-      base(srcgraph, vertex)  {
-      _srcgraph = srcgraph;
-      _destgraph = destgraph;
-      _vertexdatagraph = vertexdatagraph;
-    }
+    synchronous_scope() : base(NULL,0), _vertexbuffer(NULL),
+                          _inedges(NULL), _outedges(NULL) { }
 
-    
     ~synchronous_scope() { }
-    
+
     void commit() {};
-    
-    void init(Graph* srcgraph, 
-              Graph* destgraph,
-              Graph* vertexdatagraph, vertex_id_t vertex) {
-      base::_graph_ptr = srcgraph;
+
+    void init(Graph* graph,
+              vertex_buffer_type* vertexbuffer,
+              edge_buffer_type* inedges,
+              edge_buffer_type* outedges,
+              vertex_id_t vertex) {
+      base::_graph_ptr = graph;
       base::_vertex = vertex;
-      _srcgraph = srcgraph;
-      _destgraph = destgraph;
-      _vertexdatagraph = vertexdatagraph;
+      _vertexbuffer = vertexbuffer;
+      _inedges = inedges;
+      _outedges = outedges;
     }
-    
+
     /// Returns the data on the base vertex
     vertex_data_type& vertex_data()  {
-      return (_vertexdatagraph->vertex_data( _vertex ));
+      return (*_vertexbuffer)[_vertex];
     }
 
     const vertex_data_type& vertex_data() const  {
@@ -62,60 +63,53 @@ namespace graphlab {
     }
 
     const vertex_data_type& const_vertex_data() const  {
-      return (_vertexdatagraph->vertex_data( _vertex ));
+      return (*_vertexbuffer)[_vertex];
     }
 
     /// Direct calls to access edge data
-    const edge_data_type& edge_data(edge_id_t eid) const { 
+    const edge_data_type& edge_data(edge_id_t eid) const {
       return const_edge_data(eid);
     }
 
     /// Direct calls to access edge data
-    const edge_data_type& const_edge_data(edge_id_t eid) const { 
-      // TODO: make sure edge is associated with this vertex
-      if (_srcgraph->target(eid) == _vertex ) {
-        // in edge
-        return (_srcgraph->edge_data(eid));
-      } else {
-        // outedge
-        return (_destgraph->edge_data(eid));
-      }
+    const edge_data_type& const_edge_data(edge_id_t eid) const {
+      return buffered_edge_data(eid);
     }
 
     edge_data_type& edge_data(edge_id_t eid) {
-      // TODO: make sure edge is associated with this vertex
-      if (_srcgraph->target(eid) == _vertex) {
-        // in edge
-        return (_srcgraph->edge_data(eid));
-      } else {
-        // outedge
-        return (_destgraph->edge_data(eid));
-      }
+      return buffered_edge_data(eid);
     }
-    
+
     const vertex_data_type& neighbor_vertex_data(vertex_id_t vertex) const {
       return const_neighbor_vertex_data(vertex);
     }
 
     const vertex_data_type& const_neighbor_vertex_data(vertex_id_t vertex) const {
-      return _srcgraph->vertex_data(vertex);
+      return _graph_ptr->vertex_data(vertex);
     }
 
     vertex_data_type& neighbor_vertex_data(vertex_id_t vertex) {
       // this totally does not make sense for synchronous execution
       assert(false);
-      return _srcgraph->vertex_data(vertex);
+      return _graph_ptr->vertex_data(vertex);
     }
 
-
-      
   private:
-    Graph* _srcgraph;
-    Graph* _destgraph;
-    Graph* _vertexdatagraph;
+    edge_data_type& buffered_edge_data(edge_id_t eid) const {
+      // TODO: make sure edge is associated with this vertex
+      // in edges come from the read buffer, out edges go to the
+      // write buffer
+      edge_buffer_type* buffer =
+        _graph_ptr->target(eid) == _vertex ? _inedges : _outedges;
+      if(buffer == NULL) return _graph_ptr->edge_data(eid);
+      return (*buffer)[eid];
+    }
+
+    vertex_buffer_type* _vertexbuffer;
+    edge_buffer_type* _inedges;
+    edge_buffer_type* _outedges;
   }; // end of synchronous_scope
-  
-} // end of graphlab namespace
 
+} // end of graphlab namespace
 
 #endif
@@ -6,64 +6,161 @@
 #include <graphlab/scope/synchronous_scope.hpp>
 #include <graphlab/graph/graph.hpp>
 
+#include <graphlab/macros_def.hpp>
 namespace graphlab {
   /**
-   * This defines a scope type which is meant for "synchronous" type of 
+   * This defines a scope type which is meant for "synchronous" type of
    * algorithms. This type of scope should only be used by synchronous_engine
+   *
+   * Only the vertex data is double buffered.  Updates read neighbor
+   * vertex data from the graph and write the data of their own vertex
+   * into a second vertex data array, and swap_graphs() exchanges the
+   * two arrays.  If edge cloning is enabled the edge data is double
+   * buffered as well: in edges are read from one copy of the edge data
+   * while out edges are written to the other, and the two trade roles
+   * on every swap.  Without edge cloning all updates share the edge
+   * data in the graph.  The graph structure is never copied.
    */
   template<typename Graph>
-  class synchronous_scope_factory : 
+  class synchronous_scope_factory :
     public iscope_factory<Graph> {
   public:
     typedef iscope_factory<Graph> base;
     typedef typename base::iscope_type iscope_type;
     typedef synchronous_scope<Graph> synchronous_scope_type;
-    
-    synchronous_scope_factory(Graph& srcgraph, 
-                              Graph& destgraph, size_t ncpus) : 
-      base(srcgraph, ncpus), 
-      _srcgraph(&srcgraph), 
-      _destgraph(&destgraph), 
-      scopes(ncpus) {  
-      // vertexd data graph does not change
-      _vertexdatagraph = _destgraph;
-    }
-    
+    typedef typename synchronous_scope_type::vertex_buffer_type
+    vertex_buffer_type;
+    typedef typename synchronous_scope_type::edge_buffer_type
+    edge_buffer_type;
+
+    synchronous_scope_factory(Graph& graph, size_t ncpus) :
+      base(graph, ncpus),
+      _graph(&graph),
+      scopes(ncpus),
+      cloneedges(true),
+      edgesflipped(false) { }
+
     ~synchronous_scope_factory() { }
 
     void set_default_scope(scope_range::scope_range_enum default_scope_range) { };
-    
+
+    //! Double buffer edge data as well. Takes effect on the next init()
+    void set_clone_edges(bool clone_edges) { cloneedges = clone_edges; }
+    bool get_clone_edges() const { return cloneedges; }
+
+    /**
+     * Allocate the write buffers from the current graph data.  Must
+     * be called before the first scope is handed out.
+     */
+    void init() {
+      // The data types need not be default constructible so the
+      // buffers are built by copying
+      vertexbuffer.clear();
+      vertexbuffer.reserve(_graph->num_vertices());
+      for(vertex_id_t v = 0; v < _graph->num_vertices(); ++v)
+        vertexbuffer.push_back(_graph->vertex_data(v));
+      edgebuffer.clear();
+      if(cloneedges) {
+        edgebuffer.reserve(_graph->num_edges());
+        for(edge_id_t e = 0; e < _graph->num_edges(); ++e)
+          edgebuffer.push_back(_graph->edge_data(e));
+      } else {
+        edge_buffer_type().swap(edgebuffer);
+      }
+      edgesflipped = false;
+    } // end of init
+
+    /**
+     * Leave the newest edge data in the graph and free the write
+     * buffers.
+     */
+    void finish() {
+      if(cloneedges && edgesflipped) {
+        for(edge_id_t e = 0; e < _graph->num_edges(); ++e)
+          _graph->edge_data(e) = edgebuffer[e];
+      }
+      vertex_buffer_type().swap(vertexbuffer);
+      edge_buffer_type().swap(edgebuffer);
+      edgesflipped = false;
+    } // end of finish
+
     iscope_type* get_scope(size_t cpuid,
                            vertex_id_t v,
                            scope_range::scope_range_enum scope_range = scope_range::USE_DEFAULT) {
       assert(cpuid < scopes.size());
+      assert(v < vertexbuffer.size());
+      // The update starts from the current value of its vertex
+      vertexbuffer[v] = _graph->vertex_data(v);
       synchronous_scope_type& scope = scopes[cpuid];
-      scope.init(_srcgraph,_destgraph, _vertexdatagraph, v);
+      scope.init(_graph, &vertexbuffer, in_buffer(), out_buffer(), v);
       return &(scope);
     }
-    
+
+    /**
+     * Make the values written by the updates of this iteration the
+     * ones read in the next by exchanging the two vertex data arrays
+     * (and the roles of the two edge buffers).
+     */
     void swap_graphs() {
-      Graph* tmp = _srcgraph;
-      _srcgraph = _destgraph;
-      _destgraph = tmp;
+      _graph->swap_vertex_data(vertexbuffer);
+      if(cloneedges) edgesflipped = !edgesflipped;
     }
-    
-    Graph* get_src_graph() { return _srcgraph;  }
-    Graph* get_dest_graph() { return _destgraph;  }
-    Graph* get_vertex_data_graph() { return _vertexdatagraph;  }
-    
+
+    /**
+     * Copy the values written for vertex v in this iteration into
+     * the read buffers.  A vertex which is not updated in the next
+     * iteration must do this before swap_graphs() since it will not
+     * rewrite the buffers and would otherwise expose stale data.
+     */
+    void sync_vertex(vertex_id_t v) {
+      _graph->vertex_data(v) = vertexbuffer[v];
+      if(!cloneedges) return;
+      edge_buffer_type* from = out_buffer();
+      edge_buffer_type* to = in_buffer();
+      foreach(edge_id_t eid, _graph->out_edge_ids(v)) {
+        edge_ref(to, eid) = edge_ref(from, eid);
+      }
+    } // end of sync_vertex
+
+    Graph* get_graph() { return _graph; }
+
     void release_scope(iscope_type* scope) { }
 
     size_t num_vertices() const {
-      return _vertexdatagraph->num_vertices();
+      return _graph->num_vertices();
     }
-    
+
+    /** Bytes held by the write buffers */
+    size_t buffer_memory_usage() const {
+      return vertexbuffer.capacity() * sizeof(typename Graph::vertex_data_type) +
+        edgebuffer.capacity() * sizeof(typename Graph::edge_data_type);
+    }
+
   private:
-    Graph* _srcgraph;
-    Graph* _destgraph;
-    Graph* _vertexdatagraph;
-    std::vector<synchronous_scope_type> scopes;  
+    //! The buffer in edges are read from. NULL is the graph.
+    edge_buffer_type* in_buffer() {
+      return cloneedges && edgesflipped ? &edgebuffer : NULL;
+    }
+
+    //! The buffer out edges are written to. NULL is the graph.
+    edge_buffer_type* out_buffer() {
+      return cloneedges && !edgesflipped ? &edgebuffer : NULL;
+    }
+
+    typename Graph::edge_data_type& edge_ref(edge_buffer_type* buffer,
+                                             edge_id_t eid) {
+      if(buffer == NULL) return _graph->edge_data(eid);
+      return (*buffer)[eid];
+    }
+
+    Graph* _graph;
+    std::vector<synchronous_scope_type> scopes;
+    vertex_buffer_type vertexbuffer;
+    edge_buffer_type edgebuffer;
+    bool cloneedges;
+    bool edgesflipped;
   };
-  
+
 }
+#include <graphlab/macros_undef.hpp>
 #endif
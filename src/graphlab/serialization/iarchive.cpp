@@ -25,14 +25,23 @@ namespace graphlab {
   } 
   
   iarchive& operator>>(iarchive& a, char& i) {
-    a.i->get(i);
-    assert(!a.i->fail());
+    i = a.get();
     return a;
   }
 
   iarchive& deserialize_64bit_integer(iarchive& a, int64_t& i) {
-    a.i->read(reinterpret_cast<char*>(&i), sizeof(int64_t));
-    assert(!a.i->fail());
+    if (a.int_encoding() == integer_encoding::VARINT) {
+      uint64_t z = 0;
+      for (size_t shift = 0; shift < 64; shift += 7) {
+        const unsigned char c = a.get();
+        z |= uint64_t(c & 0x7f) << shift;
+        if ((c & 0x80) == 0) break;
+      }
+      // undo the zigzag
+      i = int64_t(z >> 1) ^ -int64_t(z & 1);
+    } else {
+      a.read(reinterpret_cast<char*>(&i), sizeof(int64_t));
+    }
     return a;
   }
 
@@ -51,14 +60,12 @@ namespace graphlab {
 
 
   iarchive& operator>>(iarchive& a, float& i) {
-    a.i->read(reinterpret_cast<char*>(&i), sizeof(float));
-    assert(!a.i->fail());
+    a.read(reinterpret_cast<char*>(&i), sizeof(float));
     return a;
   }
 
   iarchive& operator>>(iarchive& a, double& i) {
-    a.i->read(reinterpret_cast<char*>(&i), sizeof(double));
-    assert(!a.i->fail());
+    a.read(reinterpret_cast<char*>(&i), sizeof(double));
     return a;
   }
 
@@ -69,8 +76,7 @@ namespace graphlab {
     assert(length == length2);
 
     //operator>> the rest
-    a.i->read(reinterpret_cast<char*>(i), length);
-    assert(!a.i->fail());
+    a.read(reinterpret_cast<char*>(i), length);
     return a;
   }
 
@@ -80,9 +86,8 @@ namespace graphlab {
     operator>>(a, length);
     if (s == NULL) s = new char[length+1];
     //operator>> the rest
-    a.i->read(reinterpret_cast<char*>(s), length);
+    a.read(reinterpret_cast<char*>(s), length);
     s[length] = 0;
-    assert(!a.i->fail());
     return a;
   }
 
@@ -92,8 +97,7 @@ namespace graphlab {
     a >> length;
     //resize the string and read the characters
     s.resize(length);
-    a.i->read(const_cast<char*>(s.c_str()), length);
-    assert(!a.i->fail());
+    if (length > 0) a.read(&s[0], length);
     return a;
   }
 
@@ -3,6 +3,7 @@
 
 #include <iostream>
 #include <cassert>
+#include <cstring>
 #include <string>
 #include <utility>
 #include <stdint.h>
@@ -10,6 +11,7 @@
 #include <boost/static_assert.hpp>
 #include <boost/utility.hpp>
 #include <graphlab/logger/logger.hpp>
+#include <graphlab/serialization/is_pod.hpp>
 
 #ifdef _MSC_VER
 #include <itpp/base/ittypes.h> // for int32_t etc.
@@ -17,12 +19,86 @@
 
 namespace graphlab {
 
+  /**
+   * The input archive.  It reads either from a stream or, if
+   * constructed without one, directly from a byte buffer such as the
+   * data() of an oarchive or a received message.  The buffer is not
+   * copied and must outlive the archive.
+   *
+   * Reading past the end of the stream or the buffer is an assertion
+   * fault.  Without assertions the values read past the end of a
+   * buffer are zero and fail() becomes true.
+   */
   class iarchive {
   public:
+    /** The stream read from or NULL if reading from a buffer */
     std::istream* i;
 
-    iarchive(std::istream& is)
-      :i(&is) { }
+    /** Read from the stream is */
+    iarchive(std::istream& is,
+             integer_encoding::integer_encoding_enum encoding =
+             integer_encoding::FIXED_WIDTH)
+      :i(&is), buf(NULL), off(0), len(0), failed(false),
+       encoding(encoding) { }
+
+    /** Read from the length bytes at buffer */
+    iarchive(const char* buffer, size_t length,
+             integer_encoding::integer_encoding_enum encoding =
+             integer_encoding::FIXED_WIDTH)
+      :i(NULL), buf(buffer), off(0), len(length), failed(false),
+       encoding(encoding) { }
+
+    /** Read s bytes into c */
+    inline void read(char* c, size_t s) {
+      if (i == NULL) {
+        if (off + s > len) {
+          assert(false);
+          failed = true;
+          memset(c, 0, s);
+          off = len;
+          return;
+        }
+        memcpy(c, buf + off, s);
+        off += s;
+      } else {
+        i->read(c, s);
+        assert(!i->fail());
+      }
+    }
+
+    /** Read a single byte */
+    inline char get() {
+      char c;
+      if (i == NULL && off < len) c = buf[off++];
+      else read(&c, 1);
+      return c;
+    }
+
+    /** The number of bytes read from the buffer */
+    size_t position() const { return off; }
+
+    /** The number of bytes left in the buffer */
+    size_t remaining() const { return len - off; }
+
+    /** True if a read went past the end of the buffer or the stream failed */
+    bool fail() const {
+      return i == NULL ? failed : i->fail();
+    }
+
+    integer_encoding::integer_encoding_enum int_encoding() const {
+      return encoding;
+    }
+
+  private:
+    const char* buf;
+    size_t off;
+    size_t len;
+    bool failed;
+    integer_encoding::integer_encoding_enum encoding;
+
+    // Not copyable
+    iarchive(const iarchive&);
+    iarchive& operator=(const iarchive&);
   };
 
 
@@ -108,13 +184,24 @@ namespace iarchive_detail {
 
 
   template <typename ValueType>
-  typename boost::enable_if_c<has_load_method<ValueType>::value, void>::type 
+  typename boost::enable_if_c<has_load_method<ValueType>::value &&
+                              !is_pod_serializable<ValueType>::value,
+                              void>::type 
   load_or_fail(iarchive& o, ValueType &t) { 
     t.load(o);
   }
+
+  template <typename ValueType>
+  typename boost::enable_if_c<is_pod_serializable<ValueType>::value,
+                              void>::type 
+  load_or_fail(iarchive& o, ValueType &t) { 
+    o.read(reinterpret_cast<char*>(&t), sizeof(ValueType));
+  }
   
   template <typename ValueType>
-  typename boost::disable_if_c<has_load_method<ValueType>::value, void>::type 
+  typename boost::disable_if_c<has_load_method<ValueType>::value ||
+                               is_pod_serializable<ValueType>::value,
+                               void>::type 
   load_or_fail(iarchive& o, ValueType &t) { 
     ASSERT_MSG(false,"Trying to deserializable type %s without valid load method.", typeid(ValueType).name()); 
   }
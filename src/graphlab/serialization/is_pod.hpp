@@ -0,0 +1,77 @@
+#ifndef GRAPHLAB_SERIALIZE_IS_POD_HPP
+#define GRAPHLAB_SERIALIZE_IS_POD_HPP
+
+#include <boost/type_traits/is_integral.hpp>
+
+namespace graphlab {
+
+  /**
+   * How the archives write integers.  All integer types are widened
+   * to 64 bits and then either written as 8 bytes (FIXED_WIDTH, the
+   * default and the format of existing files) or as a zigzag varint
+   * of 1 to 10 bytes (VARINT) so that small values of either sign
+   * take one byte.  A stream must be read with the encoding it was
+   * written with.
+   */
+  namespace integer_encoding {
+    enum integer_encoding_enum {
+      FIXED_WIDTH,
+      VARINT
+    };
+  }
+
+
+  /**
+   * is_pod_serializable<T>::value is true if T is written as its
+   * sizeof(T) bytes in memory.  A vector of such a type is written and
+   * read with one memcpy instead of element by element.
+   *
+   * The floating point and character types are already written this
+   * way. A plain struct without pointers can be marked with
+   * GRAPHLAB_SERIALIZE_AS_POD(type) (at global scope), which lets it be
+   * serialized without save() and load() methods. Marking a type
+   * changes its serialized format, so it must be marked everywhere
+   * its data is read back.
+   */
+  template <typename T>
+  struct is_pod_serializable {
+    static const bool value = false;
+  };
+
+#define GRAPHLAB_SERIALIZE_AS_POD(type)                         \
+  namespace graphlab {                                          \
+    template <> struct is_pod_serializable<type > {             \
+      static const bool value = true;                           \
+    };                                                          \
+  }
+
+  template <> struct is_pod_serializable<char> {
+    static const bool value = true;
+  };
+  template <> struct is_pod_serializable<signed char> {
+    static const bool value = true;
+  };
+  template <> struct is_pod_serializable<unsigned char> {
+    static const bool value = true;
+  };
+  template <> struct is_pod_serializable<float> {
+    static const bool value = true;
+  };
+  template <> struct is_pod_serializable<double> {
+    static const bool value = true;
+  };
+
+
+  /**
+   * True for the integer types which are written as their raw 8 bytes
+   * under integer_encoding::FIXED_WIDTH.
+   */
+  template <typename T>
+  struct is_64bit_integer {
+    static const bool value =
+      boost::is_integral<T>::value && sizeof(T) == 8;
+  };
+
+} // namespace graphlab
+
+#endif
@@ -21,26 +21,35 @@
 namespace graphlab {
 
   oarchive& operator<<(oarchive& a, const char i) {
-    a.o->put(i);
-    assert(!a.o->fail());
+    a.put(i);
     return a;
   }
 
   oarchive& serialize_64bit_integer(oarchive& a, const int64_t i) {
-    a.o->write(reinterpret_cast<const char*>(&i), sizeof(int64_t));
-    assert(!a.o->fail());
+    if (a.int_encoding() == integer_encoding::VARINT) {
+      // zigzag maps small values of either sign to small values
+      uint64_t z = (uint64_t(i) << 1) ^ uint64_t(i >> 63);
+      char bytes[10];
+      size_t n = 0;
+      while (z >= 0x80) {
+        bytes[n++] = char(z | 0x80);
+        z >>= 7;
+      }
+      bytes[n++] = char(z);
+      a.write(bytes, n);
+    } else {
+      a.write(reinterpret_cast<const char*>(&i), sizeof(int64_t));
+    }
     return a;
   }
 
   oarchive& operator<<(oarchive& a,const float i) {
-    a.o->write(reinterpret_cast<const char*>(&i), sizeof(float));
-    assert(!a.o->fail());
+    a.write(reinterpret_cast<const char*>(&i), sizeof(float));
     return a;
   }
 
   oarchive& operator<<(oarchive& a,const double i) {
-    a.o->write(reinterpret_cast<const char*>(&i), sizeof(double));
-    assert(!a.o->fail());
+    a.write(reinterpret_cast<const char*>(&i), sizeof(double));
     return a;
   }
 
@@ -59,8 +68,7 @@ namespace graphlab {
   oarchive& serialize(oarchive& a, const void* i,const size_t length) {
     // save the length
     operator<<(a,length);
-    a.o->write(reinterpret_cast<const char*>(i), length);
-    assert(!a.o->fail());
+    a.write(reinterpret_cast<const char*>(i), length);
     return a;
   }
 
@@ -68,8 +76,7 @@ namespace graphlab {
     // save the length
     size_t length = strlen(s);
     operator<<(a,length);
-    a.o->write(reinterpret_cast<const char*>(s), length);
-    assert(!a.o->fail());
+    a.write(reinterpret_cast<const char*>(s), length);
     return a;
   }
 
@@ -77,8 +84,7 @@ namespace graphlab {
     // if we can't serialize the length, return immediately
     size_t length = s.length();
     a << length;
-    a.o->write(reinterpret_cast<const char*>(s.c_str()), length);
-    assert(!a.o->fail());
+    a.write(reinterpret_cast<const char*>(s.c_str()), length);
     return a;
   }
 
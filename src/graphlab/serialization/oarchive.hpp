@@ -3,6 +3,8 @@
 
 #include <iostream>
 #include <cassert>
+#include <cstdlib>
+#include <cstring>
 #include <string>
 #include <utility>
 #include <stdint.h>
@@ -10,6 +12,7 @@
 #include <boost/static_assert.hpp>
 #include <boost/utility.hpp>
 #include <graphlab/logger/logger.hpp>
+#include <graphlab/serialization/is_pod.hpp>
 
 #ifdef _MSC_VER
 #include <itpp/base/ittypes.h> // for int32_t etc.
@@ -17,17 +20,119 @@
 
 namespace graphlab {
   
+  /**
+   * The output archive.  It writes either to a stream or, if
+   * constructed without one, to a byte buffer which is either grown
+   * as needed or provided by the caller.  Writing to a buffer avoids
+   * the virtual calls and failure checks of the stream on every
+   * value, and the bytes can be handed to a socket or file directly
+   * (see data() and size()).
+   *
+   * Writing to a stream is an assertion fault on failure. A caller
+   * provided buffer is never grown: writes which do not fit are
+   * dropped and fail() becomes true so that the caller can retry
+   * with a larger buffer.
+   */
   class oarchive{
    public:
+    /** The stream written to or NULL if writing to a buffer */
     std::ostream* o;
 
-    oarchive(std::ostream& os)
-      : o(&os) {}
+    /** Write to the stream os */
+    oarchive(std::ostream& os,
+             integer_encoding::integer_encoding_enum encoding =
+             integer_encoding::FIXED_WIDTH)
+      : o(&os), buf(NULL), off(0), len(0), growable(false),
+        failed(false), encoding(encoding) {}
+
+    /** Write to a buffer which grows as needed */
+    explicit oarchive(integer_encoding::integer_encoding_enum encoding =
+                      integer_encoding::FIXED_WIDTH)
+      : o(NULL), buf(NULL), off(0), len(0), growable(true),
+        failed(false), encoding(encoding) {}
+
+    /** Write to the length bytes at buffer */
+    oarchive(char* buffer, size_t length,
+             integer_encoding::integer_encoding_enum encoding =
+             integer_encoding::FIXED_WIDTH)
+      : o(NULL), buf(buffer), off(0), len(length), growable(false),
+        failed(false), encoding(encoding) {}
 
     ~oarchive() {
       if (o)
         o->flush();
+      if (growable) free(buf);
     }
+
+    /** Write s bytes */
+    inline void write(const char* c, size_t s) {
+      if (o == NULL) {
+        if (off + s > len && !grow(off + s)) {
+          failed = true;
+          return;
+        }
+        memcpy(buf + off, c, s);
+        off += s;
+      } else {
+        o->write(c, s);
+        assert(!o->fail());
+      }
+    }
+
+    /** Write a single byte */
+    inline void put(char c) {
+      if (o == NULL && off < len) buf[off++] = c;
+      else write(&c, 1);
+    }
+
+    /** The bytes written to the buffer. NULL when writing to a stream */
+    const char* data() const { return buf; }
+
+    /** The number of bytes written to the buffer */
+    size_t size() const { return off; }
+
+    /** Make room for at least length bytes in a growable buffer */
+    void reserve(size_t length) {
+      if (growable && length > len) grow(length);
+    }
+
+    /** Start writing at the beginning of the buffer again */
+    void clear() {
+      off = 0;
+      failed = false;
+    }
+
+    /** True if a write did not fit in the buffer or the stream failed */
+    bool fail() const {
+      return o == NULL ? failed : o->fail();
+    }
+
+    integer_encoding::integer_encoding_enum int_encoding() const {
+      return encoding;
+    }
+
+  private:
+    char* buf;
+    size_t off;
+    size_t len;
+    bool growable;
+    bool failed;
+    integer_encoding::integer_encoding_enum encoding;
+
+    bool grow(size_t length) {
+      if (!growable) return false;
+      size_t newlen = len < 64 ? 64 : 2 * len;
+      if (newlen < length) newlen = length;
+      char* newbuf = (char*)realloc(buf, newlen);
+      ASSERT_NE(newbuf, NULL);
+      buf = newbuf;
+      len = newlen;
+      return true;
+    }
+
+    // Not copyable
+    oarchive(const oarchive&);
+    oarchive& operator=(const oarchive&);
   };
 
   /** Serializes a single character. 
@@ -99,13 +204,24 @@ namespace oarchive_detail {
 
 
   template <typename ValueType>
-  typename boost::enable_if_c<has_save_method<ValueType>::value, void>::type 
+  typename boost::enable_if_c<has_save_method<ValueType>::value &&
+                              !is_pod_serializable<ValueType>::value,
+                              void>::type 
   save_or_fail(oarchive& o, const ValueType &t) { 
     t.save(o);
   }
+
+  template <typename ValueType>
+  typename boost::enable_if_c<is_pod_serializable<ValueType>::value,
+                              void>::type 
+  save_or_fail(oarchive& o, const ValueType &t) { 
+    o.write(reinterpret_cast<const char*>(&t), sizeof(ValueType));
+  }
   
   template <typename ValueType>
-  typename boost::disable_if_c<has_save_method<ValueType>::value, void>::type 
+  typename boost::disable_if_c<has_save_method<ValueType>::value ||
+                               is_pod_serializable<ValueType>::value,
+                               void>::type 
   save_or_fail(oarchive& o, const ValueType &t) { 
     ASSERT_MSG(false,"Trying to serializable type %s without valid save method.", typeid(ValueType).name()); 
   }
@@ -7,12 +7,63 @@
 
 #include <vector>
 namespace graphlab {
+
+namespace vector_detail {
+  /**
+   * Writes and reads the elements of a vector one at a time.  The
+   * specialization for types which may be raw bytes copies the whole
+   * vector at once when the archive writes the elements as raw bytes.
+   * The format is the same either way.
+   */
+  template <typename T, bool MaybeRaw>
+  struct vector_serializer {
+    static void save(oarchive& a, const std::vector<T>& vec) {
+      serialize_iterator(a,vec.begin(), vec.end());
+    }
+    static void load(iarchive& a, std::vector<T>& vec) {
+      vec.clear();
+      deserialize_iterator<T>(a, std::inserter(vec, vec.end()));
+    }
+  };
+
+  template <typename T>
+  struct vector_serializer<T, true> {
+    static bool raw(integer_encoding::integer_encoding_enum encoding) {
+      return is_pod_serializable<T>::value ||
+        encoding == integer_encoding::FIXED_WIDTH;
+    }
+    static void save(oarchive& a, const std::vector<T>& vec) {
+      if (!raw(a.int_encoding())) {
+        vector_serializer<T, false>::save(a, vec);
+        return;
+      }
+      size_t vsize = vec.size();
+      a << vsize;
+      if (vsize > 0)
+        a.write(reinterpret_cast<const char*>(&vec[0]), vsize * sizeof(T));
+    }
+    static void load(iarchive& a, std::vector<T>& vec) {
+      if (!raw(a.int_encoding())) {
+        vector_serializer<T, false>::load(a, vec);
+        return;
+      }
+      size_t vsize = 0;
+      a >> vsize;
+      vec.clear();
+      vec.resize(vsize);
+      if (vsize > 0)
+        a.read(reinterpret_cast<char*>(&vec[0]), vsize * sizeof(T));
+    }
+  };
+}
+
   /**
     Serializes a vector
     Returns true on success, false on failure  */
   template <typename T>
   oarchive& operator<<(oarchive& a, const std::vector<T>& vec){
-    serialize_iterator(a,vec.begin(), vec.end());
+    vector_detail::vector_serializer<T, is_pod_serializable<T>::value ||
+      is_64bit_integer<T>::value>::save(a, vec);
     return a;
   }
 
@@ -21,8 +72,8 @@ namespace graphlab {
     Returns true on success, false on failure  */
   template <typename T>
   iarchive& operator>>(iarchive& a, std::vector<T>& vec){
-    vec.clear();
-    deserialize_iterator<T>(a, std::inserter(vec, vec.end()));
+    vector_detail::vector_serializer<T, is_pod_serializable<T>::value ||
+      is_64bit_integer<T>::value>::load(a, vec);
     return a;
   }
 } // namespace prl
@@ -15,6 +15,7 @@
 #include <graphlab/scope/iscope.hpp>
 #include <graphlab/util/generics/any.hpp>
 #include <graphlab/scope/iscope_factory.hpp>
+#include <graphlab/logger/logger.hpp>
 
 namespace graphlab {
 
@@ -86,6 +87,16 @@ namespace graphlab {
 
     virtual void trigger_sync(size_t index) = 0;
     virtual void trigger_sync_all() = 0;
+
+    /**
+     * Adds delta to the incremental aggregator at index, such as the
+     * change in the residual of a vertex made by an update. Managers
+     * without incremental aggregators do not support this.
+     */
+    virtual void add_delta(size_t index, const any& delta) {
+      logger(LOG_FATAL, "Incremental aggregators are not supported");
+      ASSERT_TRUE(false);
+    }
   };
 
 
@@ -82,6 +82,9 @@ namespace graphlab {
 
     /* Note: only used by pushy engine (Added by Aapo 5/31/10) */
     virtual void progress(size_t cpuid, iscope_type * scope) {}
+
+    /** Lets an engine worker work on the syncs in progress, if any */
+    virtual void help_syncs() {}
     
     /**
      * \brief register a sync.
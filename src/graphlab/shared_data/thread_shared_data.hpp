@@ -5,6 +5,7 @@
 #include <limits>
 
 #include <graphlab/parallel/pthread_tools.hpp>
+#include <graphlab/parallel/atomic.hpp>
 #include <graphlab/util/timer.hpp>
 
 #include <graphlab/shared_data/ishared_data.hpp>
@@ -30,13 +31,19 @@ namespace graphlab {
     
     typedef typename base::sync_function_type sync_function_type;
     typedef typename base::apply_function_type apply_function_type;
+    typedef typename base::merge_function_type merge_function_type;
 
+    /** Vertices claimed at a time by a thread running a parallel sync */
+    static const size_t PARALLEL_SYNC_CHUNK = 1024;
 
   private:
    
     struct sync_task {
       sync_function_type sync_fun;
       apply_function_type apply_fun;
+      /// set for parallel syncs, which combine the partial accumulators
+      merge_function_type merge_fun;
+      scope_range::scope_range_enum scopetype;
       size_t sync_interval;
       size_t next_time;
       size_t min_range;
@@ -45,16 +52,45 @@ namespace graphlab {
       mutex lock;
       size_t rangelow;
       size_t rangehigh;
+      // state of a parallel sync in progress
+      /// the first vertex not yet claimed, and the end of the range
+      atomic<size_t> next_vertex;
+      size_t end_vertex;
+      /// the number of vertices whose accumulation has been merged
+      atomic<size_t> merged_vertices;
+      any accumulator;
+      mutex merge_lock;
       sync_task() :
-        sync_fun(NULL), apply_fun(NULL),
+        sync_fun(NULL), apply_fun(NULL), merge_fun(NULL),
+        scopetype(scope_range::USE_DEFAULT),
         sync_interval(-1),
-        next_time(0) { }
+        next_time(0), end_vertex(0) { }
     };
 
     struct atomic_entry {
       any value;
       rwlock lock;
     };
+
+    /** The partial value of an incremental aggregator of a thread */
+    struct delta_partial {
+      any value;
+      spinlock lock;
+      // keep the partials of different threads on separate cache lines
+      char padding[64];
+    };
+
+    /**
+     * An incremental aggregator. Deltas are merged into the partial of
+     * the calling thread, and the value is the merge of the base and
+     * all the partials.
+     */
+    struct delta_aggregator {
+      merge_function_type merge_fun;
+      any zero;
+      any base;
+      std::vector<delta_partial> partials;
+    };
     
     typedef std::vector<any> constant_map_type;
     typedef std::map<size_t, atomic_entry> atomic_map_type;
@@ -64,6 +100,10 @@ namespace graphlab {
 
     thread_shared_data() : scope_factory(NULL) { }
 
+    ~thread_shared_data() {
+      foreach(delta_aggregator* aggregator, aggregators) delete aggregator;
+    }
+
 
     /** Set an immutable constant */
     void set_constant(size_t index, const any& new_value) {
@@ -89,6 +129,8 @@ namespace graphlab {
       sync_task& sync = sync_map[index];
       sync.sync_fun = sync_fun;
       sync.apply_fun = apply_fun;
+      sync.merge_fun = NULL;
+      sync.scopetype = scope_range::USE_DEFAULT;
       sync.zero = zero;
       sync.sync_interval = sync_interval;
       if(sync_interval != size_t(-1) ) {
@@ -104,11 +146,79 @@ namespace graphlab {
       create_atomic(index, zero);
     }
 
+    /**
+     * Registers a sync which the engine workers run together. The
+     * vertex range is split into chunks which the worker starting the
+     * sync and any worker calling help_syncs() claim in turn. Each
+     * thread accumulates its chunks into its own copy of zero and
+     * merges it into the result with merge_fun, and the result is
+     * applied once every vertex has been merged. sync_fun sees each
+     * vertex through a scope of type scopetype, which is only read by
+     * default. A sync without an engine, sync(graph, index), runs on
+     * the calling thread.
+     */
+    void set_parallel_sync(size_t index,
+                           sync_function_type sync_fun,
+                           apply_function_type apply_fun,
+                           merge_function_type merge_fun,
+                           const any& zero,
+                           size_t sync_interval = -1,
+                           scope_range::scope_range_enum scopetype =
+                             scope_range::VERTEX_READ_CONSISTENCY,
+                           size_t rangelow = 0,
+                           size_t rangehigh = -1) {
+      ASSERT_TRUE(merge_fun != NULL);
+      set_sync(index, sync_fun, apply_fun, zero, sync_interval,
+               rangelow, rangehigh);
+      sync_task& sync = sync_map[index];
+      sync.merge_fun = merge_fun;
+      sync.scopetype = scopetype;
+    }
+
     void create_atomic(size_t index, const any& initial_value) {
       atomic_entry& entry = atomic_map[index];
       entry.value = initial_value;
     }
 
+    /**
+     * Registers an incremental aggregator at index whose value is
+     * initial_value with every delta passed to add_delta() merged in
+     * by merge_fun, so that a global statistic such as the sum of the
+     * residuals is kept up to date by the update functions instead of
+     * being recomputed over all vertices by a sync. zero must be the
+     * identity of merge_fun. get() and atomic_get() merge the partials
+     * of the threads, which costs O(threads). atomic_set() replaces
+     * the value. Must be called before the engine starts.
+     */
+    void set_delta_aggregator(size_t index,
+                              merge_function_type merge_fun,
+                              const any& zero,
+                              const any& initial_value) {
+      ASSERT_TRUE(merge_fun != NULL);
+      if (aggregators.size() <= index) aggregators.resize(index + 1, NULL);
+      if (aggregators[index] == NULL) aggregators[index] = new delta_aggregator;
+      delta_aggregator& aggregator = *aggregators[index];
+      aggregator.merge_fun = merge_fun;
+      aggregator.zero = zero;
+      aggregator.base = initial_value;
+      aggregator.partials.resize(std::max(size_t(1), thread::cpu_count()));
+      foreach(delta_partial& partial, aggregator.partials) partial.value = zero;
+    }
+
+    /**
+     * Merges delta into the partial of the calling thread of the
+     * incremental aggregator at index. Thread safe.
+     */
+    void add_delta(size_t index, const any& delta) {
+      ASSERT_TRUE(is_aggregator(index));
+      delta_aggregator& aggregator = *aggregators[index];
+      delta_partial& partial =
+        aggregator.partials[thread::thread_id() % aggregator.partials.size()];
+      partial.lock.lock();
+      aggregator.merge_fun(index, *this, partial.value, delta);
+      partial.lock.unlock();
+    }
+
 
 
     /**
@@ -192,7 +302,10 @@ namespace graphlab {
         // std::cout << "Sync: " << index << std::endl;
         // Copy the accumulator
         any accumulator = sync.zero;
-        if (sync.sync_fun != NULL) {
+        if (sync.sync_fun != NULL && sync.merge_fun != NULL) {
+          accumulator = run_parallel_sync(index, sync);
+        }
+        else if (sync.sync_fun != NULL) {
           // Try and grab the lock for the sync
           size_t cpuid = thread::thread_id();
           size_t vmax = std::min(scope_factory->num_vertices(), sync.rangehigh);
@@ -200,7 +313,8 @@ namespace graphlab {
           ASSERT_LE(vmin, vmax);
           for(size_t v = vmin; v < vmax; ++v) {
             // get the scope for the vertex
-            iscope_type* scope = scope_factory->get_scope(cpuid, v);
+            iscope_type* scope = scope_factory->get_scope(cpuid, v,
+                                                          sync.scopetype);
             assert(scope != NULL);
             // Apply the sync function
             sync.sync_fun(index, *this, *scope, accumulator);
@@ -226,6 +340,22 @@ namespace graphlab {
       }
     } // end of sync
 
+
+    /**
+     * Works on the parallel syncs in progress, if there are any, until
+     * their vertices have all been claimed. Called by the engine
+     * workers between tasks.
+     */
+    void help_syncs() {
+      if (nrunning.value == 0) return;
+      running_lock.lock();
+      std::vector<std::pair<size_t, sync_task*> > syncs(running_syncs);
+      running_lock.unlock();
+      for (size_t i = 0; i < syncs.size(); ++i) {
+        accumulate_chunks(syncs[i].first, *syncs[i].second);
+      }
+    }
+
     /**
      * \brief Run all sync tasks using the graph data.
      *
@@ -288,6 +418,7 @@ namespace graphlab {
 
 
     any get(size_t index) const {
+      if (is_aggregator(index)) return aggregate(index);
       // Get the field
       typedef typename atomic_map_type::const_iterator iterator_type;
       iterator_type iter = atomic_map.find(index);
@@ -305,6 +436,17 @@ namespace graphlab {
 
 
     void atomic_set(size_t index, const any& data) {
+      if (is_aggregator(index)) {
+        // the partials are folded into the base, which is replaced
+        delta_aggregator& aggregator = *aggregators[index];
+        foreach(delta_partial& partial, aggregator.partials) partial.lock.lock();
+        aggregator.base = data;
+        foreach(delta_partial& partial, aggregator.partials) {
+          partial.value = aggregator.zero;
+          partial.lock.unlock();
+        }
+        return;
+      }
       typedef typename atomic_map_type::iterator iterator_type;
       iterator_type iter = atomic_map.find(index);
       // The shared data item must already have been created
@@ -317,6 +459,18 @@ namespace graphlab {
 
 
     any atomic_exchange(size_t index, const any& data) {
+      if (is_aggregator(index)) {
+        delta_aggregator& aggregator = *aggregators[index];
+        foreach(delta_partial& partial, aggregator.partials) partial.lock.lock();
+        any old_value = aggregator.base;
+        foreach(delta_partial& partial, aggregator.partials) {
+          aggregator.merge_fun(index, *this, old_value, partial.value);
+          partial.value = aggregator.zero;
+        }
+        aggregator.base = data;
+        foreach(delta_partial& partial, aggregator.partials) partial.lock.unlock();
+        return old_value;
+      }
       typedef typename atomic_map_type::iterator iterator_type;
       iterator_type iter = atomic_map.find(index);
       // The shared data item must already have been created
@@ -353,13 +507,107 @@ namespace graphlab {
 
     
     
+  private:
+
+    bool is_aggregator(size_t index) const {
+      return index < aggregators.size() && aggregators[index] != NULL;
+    }
+
+    /** The base of an aggregator merged with the partial of every thread */
+    any aggregate(size_t index) const {
+      const delta_aggregator& aggregator = *aggregators[index];
+      any result = aggregator.base;
+      foreach(const delta_partial& partial, aggregator.partials) {
+        partial.lock.lock();
+        aggregator.merge_fun(index, *this, result, partial.value);
+        partial.lock.unlock();
+      }
+      return result;
+    }
+
+    /**
+     * Runs a parallel sync with the help of the workers calling
+     * help_syncs() and returns the merged result once every vertex has
+     * been merged. Called with sync.lock held.
+     */
+    any run_parallel_sync(size_t index, sync_task& sync) {
+      // keep late helpers of the previous run out while resetting
+      sync.next_vertex.value = size_t(-1) / 2;
+      __sync_synchronize();
+      sync.end_vertex = std::min(scope_factory->num_vertices(), sync.rangehigh);
+      const size_t vmin = std::min(sync.rangelow, sync.end_vertex);
+      sync.accumulator = sync.zero;
+      sync.merged_vertices.value = 0;
+      __sync_synchronize();
+      sync.next_vertex.value = vmin;
+      __sync_synchronize();
+
+      running_lock.lock();
+      running_syncs.push_back(std::make_pair(index, &sync));
+      nrunning.inc();
+      running_lock.unlock();
+
+      accumulate_chunks(index, sync);
+      // wait for the helpers to finish the chunks they claimed
+      while (sync.merged_vertices.value < sync.end_vertex - vmin) {
+        sched_yield();
+      }
+
+      running_lock.lock();
+      for (size_t i = 0; i < running_syncs.size(); ++i) {
+        if (running_syncs[i].second == &sync) {
+          running_syncs.erase(running_syncs.begin() + i);
+          break;
+        }
+      }
+      nrunning.dec();
+      running_lock.unlock();
+      return sync.accumulator;
+    }
+
+    /**
+     * Claims chunks of the vertices of a parallel sync until none are
+     * left, accumulating them into a private accumulator which is then
+     * merged into the result
+     */
+    void accumulate_chunks(size_t index, sync_task& sync) {
+      const size_t cpuid = thread::thread_id();
+      any accumulator = sync.zero;
+      size_t nvertices = 0;
+      while (true) {
+        const size_t begin =
+          sync.next_vertex.inc(PARALLEL_SYNC_CHUNK) - PARALLEL_SYNC_CHUNK;
+        const size_t end = sync.end_vertex;
+        if (begin >= end) break;
+        const size_t last = std::min(begin + PARALLEL_SYNC_CHUNK, end);
+        for (size_t v = begin; v < last; ++v) {
+          iscope_type* scope = scope_factory->get_scope(cpuid, v, sync.scopetype);
+          assert(scope != NULL);
+          sync.sync_fun(index, *this, *scope, accumulator);
+          scope->commit();
+          scope_factory->release_scope(scope);
+        }
+        nvertices += last - begin;
+      }
+      if (nvertices == 0) return;
+      sync.merge_lock.lock();
+      sync.merge_fun(index, *this, sync.accumulator, accumulator);
+      sync.merge_lock.unlock();
+      sync.merged_vertices.inc(nvertices);
+    }
+
     // Data Members
     // ==============================================================>
-  private:
     constant_map_type constants;
     atomic_map_type atomic_map;
     sync_map_type sync_map;
+    /// the incremental aggregators by index, NULL where there is none
+    std::vector<delta_aggregator*> aggregators;
     iscope_factory_type* scope_factory;
+    /// the parallel syncs in progress, which help_syncs() works on
+    std::vector<std::pair<size_t, sync_task*> > running_syncs;
+    atomic<size_t> nrunning;
+    spinlock running_lock;
 
   }; // end of class thread_share_data
 
@@ -80,7 +80,7 @@ namespace graphlab {
         ("engine",
          boost_po::value<std::string>(&(engine_type))->
          default_value(engine_type),
-         "Options are {async, async_sim, synchronous}")
+         "Options are {async, async_sim, synchronous, chromatic}")
         ("scope",
          boost_po::value<std::string>(&(scope_type))->
          default_value(scope_type),
@@ -89,10 +89,21 @@ namespace graphlab {
          boost_po::value<std::string>(&(scheduler_type))->
          default_value(scheduler_type),
          "There are several scheduler supported by the graphlab framework:"
-         "{synchronous, fifo, sweep, multiqueue_fifo, priority, "
-         "sampling, splash(splash_size), multiqueue_priority, set, "
+         "{synchronous, fifo, sweep, multiqueue_fifo, work_stealing, priority, "
+         "sampling, splash(splash_size), multiqueue_priority, "
+         "relaxed_priority(queues_per_cpu, stickiness), set, "
          "clustered_priority(one of {metis,bfs,random}, vertices perpartition), "
-         "round_robin, colored}");      
+         "round_robin, colored}")
+        ("idlespins",
+         boost_po::value<size_t>(&(idle_spins))->
+         default_value(idle_spins),
+         "Number of times a worker polls an empty scheduler before it "
+         "sleeps until a task is added. 0 never sleeps.")
+        ("numa",
+         boost_po::value<bool>(&(numa))->
+         default_value(numa),
+         "Pin workers to cpus and place the graph data on the NUMA "
+         "node of the workers running its vertices.");
       // Parse the arguments
       try{
         boost_po::store(boost_po::command_line_parser(argc, argv).
@@ -0,0 +1,233 @@
+#ifndef GRAPHLAB_INDEXED_DARY_HEAP_HPP
+#define GRAPHLAB_INDEXED_DARY_HEAP_HPP
+
+#include <vector>
+#include <algorithm>
+#include <cassert>
+#include <stdint.h>
+
+namespace graphlab {
+
+  /**
+   * A max priority queue of dense integer items, such as vertex ids,
+   * supporting priority updates with the same interface as
+   * mutable_queue<size_t, Priority>.
+   *
+   * The heap is Arity-ary instead of binary, which halves its depth
+   * for Arity = 4, and the children of a node are adjacent so that
+   * with 16 byte elements the 4 children compared when sifting down
+   * span at most two cache lines. The position of each item is kept in a flat
+   * vector indexed by the item, and sifting moves a hole instead of
+   * swapping, so each level costs one element copy and one index
+   * write.
+   *
+   * Items with equal priorities are popped in no particular order.
+   *
+   * \ingroup datastructure
+   */
+  template <typename Priority, size_t Arity = 4>
+  class indexed_dary_heap {
+  public:
+
+    //! An element of the heap.
+    typedef std::pair<size_t, Priority> heap_element;
+
+    typedef uint32_t index_type;
+
+    //! Used to mark entries in the index map that are blank
+    static const index_type BLANK = index_type(-1);
+
+    //! Default constructor.
+    indexed_dary_heap() { }
+
+    //! Makes room in the index for the items 0 to nitems - 1
+    explicit indexed_dary_heap(size_t nitems) : index_map(nitems, BLANK) { }
+
+    //! Returns the number of elements in the heap.
+    size_t size() const {
+      return heap.size();
+    }
+
+    //! Returns true iff the queue is empty.
+    bool empty() const {
+      return heap.empty();
+    }
+
+    //! Returns true if the queue contains the given value
+    bool contains(size_t item) const {
+      return item < index_map.size() && index_map[item] != BLANK;
+    }
+
+    //! Enqueues a new item in the queue. It must not already be present.
+    void push(size_t item, Priority priority) {
+      assert(!contains(item));
+      assert(heap.size() < BLANK);
+      if (item >= index_map.size()) index_map.resize(item + 1, BLANK);
+      heap.push_back(heap_element(item, priority));
+      sift_up(heap.size() - 1);
+    }
+
+    //! Accesses the item with maximum priority in the queue.
+    const heap_element& top() const {
+      assert(!empty());
+      return heap[0];
+    }
+
+    /**
+     * Removes the item with maximum priority from the queue, and
+     * returns it with its priority.
+     */
+    heap_element pop() {
+      assert(!empty());
+      heap_element top = heap[0];
+      index_map[top.first] = BLANK;
+      if (heap.size() > 1) {
+        heap[0] = heap.back();
+        heap.pop_back();
+        sift_down(0);
+      } else {
+        heap.pop_back();
+      }
+      return top;
+    }
+
+    //! Returns the priority associated with a key
+    Priority get(size_t item) const {
+      assert(contains(item));
+      return heap[index_map[item]].second;
+    }
+
+    //! Returns the priority associated with a key
+    Priority operator[](size_t item) const {
+      return get(item);
+    }
+
+    /**
+     * Updates the priority associated with a item in the queue. This
+     * function fails if the item is not already present.
+     */
+    void update(size_t item, Priority priority) {
+      assert(contains(item));
+      size_t i = index_map[item];
+      const bool increased = heap[i].second < priority;
+      heap[i].second = priority;
+      if (increased) sift_up(i);
+      else sift_down(i);
+    }
+
+    /**
+     * If item is already in the queue, sets its priority to the maximum
+     * of the old priority and the new one. If the item is not in the queue,
+     * adds it to the queue.
+     *
+     * returns true if the item was not already present
+     */
+    bool insert_max(size_t item, Priority priority) {
+      if (!contains(item)) {
+        push(item, priority);
+        return true;
+      }
+      size_t i = index_map[item];
+      if (heap[i].second < priority) {
+        heap[i].second = priority;
+        sift_up(i);
+      }
+      return false;
+    }
+
+    /**
+     * If item is already in the queue, sets its priority to the sum
+     * of the old priority and the new one. If the item is not in the queue,
+     * adds it to the queue.
+     *
+     * returns true if the item was not already present
+     */
+    bool insert_cumulative(size_t item, Priority priority) {
+      if (!contains(item)) {
+        push(item, priority);
+        return true;
+      }
+      update(item, heap[index_map[item]].second + priority);
+      return false;
+    }
+
+    //! Clears all the values (equivalent to stl clear)
+    void clear() {
+      // only the items in the heap have index entries to reset
+      for (size_t i = 0; i < heap.size(); ++i) index_map[heap[i].first] = BLANK;
+      heap.clear();
+    }
+
+    /**
+     * Remove an item from the queue returning true if the item was
+     * originally present
+     */
+    bool remove(size_t item) {
+      if (!contains(item)) return false;
+      size_t i = index_map[item];
+      index_map[item] = BLANK;
+      if (i + 1 < heap.size()) {
+        // the last element fills the hole and moves either way
+        const bool increased = heap[i].second < heap.back().second;
+        heap[i] = heap.back();
+        heap.pop_back();
+        if (increased) sift_up(i);
+        else sift_down(i);
+      } else {
+        heap.pop_back();
+      }
+      return true;
+    }
+
+  private:
+
+    //! The heap. The children of i are Arity * i + 1 to Arity * i + Arity
+    std::vector<heap_element> heap;
+
+    //! The position of each item in the heap, or BLANK
+    std::vector<index_type> index_map;
+
+    //! Moves the element at i up until its parent has a priority no lower
+    void sift_up(size_t i) {
+      const heap_element elem = heap[i];
+      while (i > 0) {
+        const size_t parent = (i - 1) / Arity;
+        if (!(heap[parent].second < elem.second)) break;
+        heap[i] = heap[parent];
+        index_map[heap[i].first] = index_type(i);
+        i = parent;
+      }
+      heap[i] = elem;
+      index_map[elem.first] = index_type(i);
+    }
+
+    //! Moves the element at i down until no child has a higher priority
+    void sift_down(size_t i) {
+      const heap_element elem = heap[i];
+      const size_t n = heap.size();
+      while (true) {
+        const size_t first = Arity * i + 1;
+        if (first >= n) break;
+        const size_t last = std::min(first + Arity, n);
+        size_t largest = first;
+        for (size_t c = first + 1; c < last; ++c) {
+          if (heap[largest].second < heap[c].second) largest = c;
+        }
+        if (!(elem.second < heap[largest].second)) break;
+        heap[i] = heap[largest];
+        index_map[heap[i].first] = index_type(i);
+        i = largest;
+      }
+      heap[i] = elem;
+      index_map[elem.first] = index_type(i);
+    }
+
+  }; // class indexed_dary_heap
+
+  template <typename Priority, size_t Arity>
+  const typename indexed_dary_heap<Priority, Arity>::index_type
+  indexed_dary_heap<Priority, Arity>::BLANK;
+
+} // namespace graphlab
+
+#endif
@@ -0,0 +1,112 @@
+#ifndef GRAPHLAB_MAPPED_FILE_HPP
+#define GRAPHLAB_MAPPED_FILE_HPP
+
+#include <cassert>
+#include <cstring>
+#include <cerrno>
+#include <string>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <graphlab/logger/logger.hpp>
+
+namespace graphlab {
+
+  /**
+   * \class mapped_file A whole file mapped into memory with mmap.
+   *
+   * The mapping is read only, or private when writable: writes then
+   * copy the touched pages and are never written back to the file.
+   * Pages are read from the file when first touched so opening even
+   * a very large file is immediate.
+   */
+  class mapped_file {
+  public:
+    mapped_file() : ptr(NULL), length(0), is_writable(false) { }
+
+    /** Map filename, see open() */
+    explicit mapped_file(const std::string& filename, bool writable = false) :
+      ptr(NULL), length(0), is_writable(false) {
+      open(filename, writable);
+    }
+
+    ~mapped_file() { close(); }
+
+    /**
+     * Map the whole of filename, copy on write if writable.  Returns
+     * false and logs the reason if the file could not be mapped.
+     */
+    bool open(const std::string& filename, bool writable = false) {
+      close();
+      const int fd = ::open(filename.c_str(), O_RDONLY);
+      if(fd < 0) {
+        logger(LOG_ERROR, "Cannot open %s: %s", filename.c_str(),
+               strerror(errno));
+        return false;
+      }
+      struct stat st;
+      if(fstat(fd, &st) != 0 || st.st_size == 0) {
+        logger(LOG_ERROR, "Cannot map %s: empty or unreadable file",
+               filename.c_str());
+        ::close(fd);
+        return false;
+      }
+      const int prot = writable ? PROT_READ | PROT_WRITE : PROT_READ;
+      void* addr = mmap(NULL, st.st_size, prot, MAP_PRIVATE, fd, 0);
+      // the mapping keeps the file open
+      ::close(fd);
+      if(addr == MAP_FAILED) {
+        logger(LOG_ERROR, "Cannot map %s: %s", filename.c_str(),
+               strerror(errno));
+        return false;
+      }
+      ptr = static_cast<char*>(addr);
+      length = st.st_size;
+      is_writable = writable;
+      return true;
+    } // end of open
+
+    /** Unmap the file */
+    void close() {
+      if(ptr != NULL) munmap(ptr, length);
+      ptr = NULL;
+      length = 0;
+      is_writable = false;
+    }
+
+    bool is_open() const { return ptr != NULL; }
+
+    bool writable() const { return is_writable; }
+
+    /** The contents of the file */
+    const char* data() const { return ptr; }
+
+    /** The contents of the file. Only for a writable mapping. */
+    char* mutable_data() {
+      assert(is_writable);
+      return ptr;
+    }
+
+    /** The size of the file in bytes */
+    size_t size() const { return length; }
+
+    /** Ask the kernel to read the whole file ahead of use */
+    void prefetch() const {
+      if(ptr != NULL) madvise(ptr, length, MADV_WILLNEED);
+    }
+
+  private:
+    char* ptr;
+    size_t length;
+    bool is_writable;
+
+    // Not copyable
+    mapped_file(const mapped_file&);
+    mapped_file& operator=(const mapped_file&);
+  }; // end of mapped_file
+
+} // end of namespace graphlab
+
+#endif
@@ -501,6 +501,10 @@ namespace graphlab {
     }
   }; // class mutable_queue
 
+  template <typename Priority>
+  const typename mutable_queue<size_t, Priority>::index_type
+  mutable_queue<size_t, Priority>::BLANK;
+
 } // namespace graphlab
 
 #include <graphlab/macros_undef.hpp>
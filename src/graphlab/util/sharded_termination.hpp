@@ -0,0 +1,135 @@
+#ifndef GRAPHLAB_SHARDED_TERMINATION_HPP
+#define GRAPHLAB_SHARDED_TERMINATION_HPP
+
+#include <cassert>
+#include <cstdlib>
+#include <iostream>
+
+#include <graphlab/parallel/pthread_tools.hpp>
+#include <graphlab/parallel/atomic.hpp>
+
+
+namespace graphlab {
+  /**
+   * Task counting termination checker with per cpu counters.  It has
+   * the same interface as task_count_termination and can replace it
+   * in any scheduler.
+   *
+   * Instead of two global counters every cpu increments the created
+   * and finished counts in its own cache line so adding and
+   * completing tasks does not bounce a shared line between cores.
+   * Threads which do not pass a cpuid use their thread id.
+   *
+   * finish() detects quiescence in two phases.  The first phase sums
+   * all finished counts and then all created counts.  Since a task is
+   * created before it is finished every task seen as finished is
+   * also seen as created, so equal sums mean that there was a moment
+   * between the two sweeps with no outstanding task.  The second
+   * phase sums the created counts again and only reports termination
+   * if nothing was created in the meantime.
+   *
+   * A sweep touches every cache line so finish() costs O(ncpus).
+   * Schedulers should check is_aborted() on every call and only call
+   * finish() when they found no task.
+   */
+  class sharded_termination {
+    /** The counters of one cpu, padded to a cache line */
+    struct shard {
+      atomic<size_t> created;
+      atomic<size_t> finished;
+      char padding[64 - 2 * sizeof(atomic<size_t>)];
+    };
+
+    shard* shards;
+    size_t nshards;
+    bool force_termination; //signal computation is aborted
+
+    // Not copyable
+    sharded_termination(const sharded_termination&);
+    sharded_termination& operator=(const sharded_termination&);
+
+    void init(size_t ncpus) {
+      nshards = ncpus > 0 ? ncpus : 1;
+      void* ptr = NULL;
+      int error = posix_memalign(&ptr, 64, sizeof(shard) * nshards);
+      assert(error == 0 && ptr != NULL);
+      shards = reinterpret_cast<shard*>(ptr);
+      for(size_t i = 0; i < nshards; ++i) {
+        shards[i].created.value = 0;
+        shards[i].finished.value = 0;
+      }
+    }
+
+    shard& local_shard() { return shards[thread::thread_id() % nshards]; }
+
+    size_t total_created() const {
+      size_t total = 0;
+      for(size_t i = 0; i < nshards; ++i) total += shards[i].created.value;
+      return total;
+    }
+
+    size_t total_finished() const {
+      size_t total = 0;
+      for(size_t i = 0; i < nshards; ++i) total += shards[i].finished.value;
+      return total;
+    }
+
+  public:
+    /** One shard per cpu of the machine */
+    sharded_termination() : force_termination(false) {
+      init(thread::cpu_count());
+    }
+
+    sharded_termination(size_t ncpus) : force_termination(false) {
+      init(ncpus);
+    }
+
+    ~sharded_termination() { free(shards); }
+
+    bool finish() {
+      if(force_termination) return true;
+      // Phase 1: finished counts strictly before created counts
+      const size_t finished = total_finished();
+      __sync_synchronize();
+      const size_t created = total_created();
+      assert(finished <= created);
+      if(finished != created) return false;
+      // Phase 2: confirm that nothing was created since
+      __sync_synchronize();
+      return total_created() == created;
+    }
+
+    void abort(){
+      force_termination = true;
+    }
+
+    bool is_aborted(){ return force_termination; }
+
+    void restart(){
+      force_termination = false;
+    }
+
+    void new_job() {
+      local_shard().created.inc();
+    }
+
+    void new_job(size_t cpuid) {
+      shards[cpuid % nshards].created.inc();
+    }
+
+    void completed_job() {
+      local_shard().finished.inc();
+    }
+
+    void completed_job(size_t cpuid) {
+      shards[cpuid % nshards].finished.inc();
+    }
+
+    void print() {
+      std::cout << total_finished() << " of "
+                << total_created() << std::endl;
+    }
+  };
+
+}
+#endif
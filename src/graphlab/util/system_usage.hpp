@@ -4,14 +4,26 @@
 
 
 
+#include <cstddef>
 #include <sys/resource.h>
 
 
 namespace graphlab {
 
-
-
-
+  /**
+   * The peak resident set size of this process in kilobytes or 0 if
+   * it is not available.
+   */
+  inline size_t peak_memory_kb() {
+    struct rusage usage;
+    if(getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#ifdef __APPLE__
+    // Mac OS X reports bytes
+    return usage.ru_maxrss / 1024;
+#else
+    return usage.ru_maxrss;
+#endif
+  }
 
 };
 